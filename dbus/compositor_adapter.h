@@ -22,6 +22,9 @@ public:
     : ::DBus::InterfaceAdaptor("org.os.Compositor.Shortcut")
     {
         register_method(Shortcut_adaptor, Register, _Register_stub);
+        register_method(Shortcut_adaptor, RegisterKeysym, _RegisterKeysym_stub);
+        register_method(Shortcut_adaptor, RegisterChord, _RegisterChord_stub);
+        register_method(Shortcut_adaptor, RegisterAll, _RegisterAll_stub);
     }
 
     ::DBus::IntrospectedInterface *introspect() const
@@ -34,6 +37,26 @@ public:
             { "id", "i", false },
             { 0, 0, 0 }
         };
+        static ::DBus::IntrospectedArgument RegisterKeysym_args[] =
+        {
+            { "keysym", "i", true },
+            { "modifiers", "i", true },
+            { "state", "i", true },
+            { "id", "i", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument RegisterChord_args[] =
+        {
+            { "sequence", "a(iii)", true },
+            { "id", "i", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument RegisterAll_args[] =
+        {
+            { "bindings", "a(iii)", true },
+            { "ids", "ai", false },
+            { 0, 0, 0 }
+        };
         static ::DBus::IntrospectedArgument Shortcut_args[] =
         {
             { "id", "i", false },
@@ -42,6 +65,9 @@ public:
         static ::DBus::IntrospectedMethod Shortcut_adaptor_methods[] =
         {
             { "Register", Register_args },
+            { "RegisterKeysym", RegisterKeysym_args },
+            { "RegisterChord", RegisterChord_args },
+            { "RegisterAll", RegisterAll_args },
             { 0, 0 }
         };
         static ::DBus::IntrospectedMethod Shortcut_adaptor_signals[] =
@@ -75,6 +101,9 @@ public:
      * you will have to implement them in your ObjectAdaptor
      */
     virtual int32_t Register(const int32_t& key_code, const int32_t& modifiers, const int32_t& state) = 0;
+    virtual int32_t RegisterKeysym(const int32_t& keysym, const int32_t& modifiers, const int32_t& state) = 0;
+    virtual int32_t RegisterChord(const std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > >& sequence) = 0;
+    virtual std::vector< int32_t > RegisterAll(const std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > >& bindings) = 0;
 
 public:
 
@@ -105,6 +134,41 @@ private:
         wi << argout1;
         return reply;
     }
+    ::DBus::Message _RegisterKeysym_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        int32_t argin1; ri >> argin1;
+        int32_t argin2; ri >> argin2;
+        int32_t argin3; ri >> argin3;
+        int32_t argout1 = RegisterKeysym(argin1, argin2, argin3);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _RegisterChord_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > > argin1; ri >> argin1;
+        int32_t argout1 = RegisterChord(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _RegisterAll_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > > argin1; ri >> argin1;
+        std::vector< int32_t > argout1 = RegisterAll(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
 };
 
 } } }
@@ -122,10 +186,15 @@ public:
     {
         register_method(Window_adaptor, Apps, _Apps_stub);
         register_method(Window_adaptor, Focus, _Focus_stub);
+        register_method(Window_adaptor, Thumbnail, _Thumbnail_stub);
+        register_method(Window_adaptor, ScreenshotWindow, _ScreenshotWindow_stub);
         register_method(Window_adaptor, DockLeft, _DockLeft_stub);
         register_method(Window_adaptor, DockRight, _DockRight_stub);
         register_method(Window_adaptor, Maximize, _Maximize_stub);
         register_method(Window_adaptor, Minimize, _Minimize_stub);
+        register_method(Window_adaptor, Overview, _Overview_stub);
+        register_method(Window_adaptor, SwitchWorkspace, _SwitchWorkspace_stub);
+        register_method(Window_adaptor, MoveToWorkspace, _MoveToWorkspace_stub);
     }
 
     ::DBus::IntrospectedInterface *introspect() const
@@ -140,6 +209,30 @@ public:
             { "app_id", "s", true },
             { 0, 0, 0 }
         };
+        static ::DBus::IntrospectedArgument Thumbnail_args[] =
+        {
+            { "app_id", "s", true },
+            { "fd", "h", false },
+            { "width", "i", false },
+            { "height", "i", false },
+            { "stride", "i", false },
+            { "slot_size", "i", false },
+            { "serial", "u", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument ThumbnailChanged_args[] =
+        {
+            { "app_id", "s", false },
+            { "serial", "u", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument ScreenshotWindow_args[] =
+        {
+            { "app_id", "s", true },
+            { "name", "s", true },
+            { "queued", "b", false },
+            { 0, 0, 0 }
+        };
         static ::DBus::IntrospectedArgument DockLeft_args[] =
         {
             { 0, 0, 0 }
@@ -156,18 +249,40 @@ public:
         {
             { 0, 0, 0 }
         };
+        static ::DBus::IntrospectedArgument Overview_args[] =
+        {
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument SwitchWorkspace_args[] =
+        {
+            { "index", "i", true },
+            { "switched", "b", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument MoveToWorkspace_args[] =
+        {
+            { "index", "i", true },
+            { "moved", "b", false },
+            { 0, 0, 0 }
+        };
         static ::DBus::IntrospectedMethod Window_adaptor_methods[] =
         {
             { "Apps", Apps_args },
             { "Focus", Focus_args },
+            { "Thumbnail", Thumbnail_args },
+            { "ScreenshotWindow", ScreenshotWindow_args },
             { "DockLeft", DockLeft_args },
             { "DockRight", DockRight_args },
             { "Maximize", Maximize_args },
             { "Minimize", Minimize_args },
+            { "Overview", Overview_args },
+            { "SwitchWorkspace", SwitchWorkspace_args },
+            { "MoveToWorkspace", MoveToWorkspace_args },
             { 0, 0 }
         };
         static ::DBus::IntrospectedMethod Window_adaptor_signals[] =
         {
+            { "ThumbnailChanged", ThumbnailChanged_args },
             { 0, 0 }
         };
         static ::DBus::IntrospectedProperty Window_adaptor_properties[] =
@@ -197,15 +312,28 @@ public:
      */
     virtual std::vector< std::string > Apps() = 0;
     virtual void Focus(const std::string& app_id) = 0;
+    virtual void Thumbnail(const std::string& app_id, ::DBus::FileDescriptor& fd, int32_t& width, int32_t& height, int32_t& stride, int32_t& slot_size, uint32_t& serial) = 0;
+    virtual bool ScreenshotWindow(const std::string& app_id, const std::string& name) = 0;
     virtual void DockLeft() = 0;
     virtual void DockRight() = 0;
     virtual void Maximize() = 0;
     virtual void Minimize() = 0;
+    virtual void Overview() = 0;
+    virtual bool SwitchWorkspace(const int32_t& index) = 0;
+    virtual bool MoveToWorkspace(const int32_t& index) = 0;
 
 public:
 
     /* signal emitters for this interface
      */
+    void ThumbnailChanged(const std::string& arg1, const uint32_t& arg2)
+    {
+        ::DBus::SignalMessage sig("ThumbnailChanged");
+        ::DBus::MessageIter wi = sig.writer();
+        wi << arg1;
+        wi << arg2;
+        emit_signal(sig);
+    }
 
 private:
 
@@ -228,6 +356,40 @@ private:
         ::DBus::ReturnMessage reply(call);
         return reply;
     }
+    ::DBus::Message _Thumbnail_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::string argin1; ri >> argin1;
+        ::DBus::FileDescriptor argout1;
+        int32_t argout2;
+        int32_t argout3;
+        int32_t argout4;
+        int32_t argout5;
+        uint32_t argout6;
+        Thumbnail(argin1, argout1, argout2, argout3, argout4, argout5, argout6);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        wi << argout2;
+        wi << argout3;
+        wi << argout4;
+        wi << argout5;
+        wi << argout6;
+        return reply;
+    }
+    ::DBus::Message _ScreenshotWindow_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::string argin1; ri >> argin1;
+        std::string argin2; ri >> argin2;
+        bool argout1 = ScreenshotWindow(argin1, argin2);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
     ::DBus::Message _DockLeft_stub(const ::DBus::CallMessage &call)
     {
         DockLeft();
@@ -252,6 +414,168 @@ private:
         ::DBus::ReturnMessage reply(call);
         return reply;
     }
+    ::DBus::Message _Overview_stub(const ::DBus::CallMessage &call)
+    {
+        Overview();
+        ::DBus::ReturnMessage reply(call);
+        return reply;
+    }
+    ::DBus::Message _SwitchWorkspace_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        int32_t argin1; ri >> argin1;
+        bool argout1 = SwitchWorkspace(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _MoveToWorkspace_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        int32_t argin1; ri >> argin1;
+        bool argout1 = MoveToWorkspace(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+};
+
+} } }
+namespace org {
+namespace os {
+namespace Compositor {
+
+class Display_adaptor
+: public ::DBus::InterfaceAdaptor
+{
+public:
+
+    Display_adaptor()
+    : ::DBus::InterfaceAdaptor("org.os.Compositor.Display")
+    {
+        register_method(Display_adaptor, CreateOutput, _CreateOutput_stub);
+        register_method(Display_adaptor, DestroyOutput, _DestroyOutput_stub);
+        register_method(Display_adaptor, Screenshot, _Screenshot_stub);
+    }
+
+    ::DBus::IntrospectedInterface *introspect() const
+    {
+        static ::DBus::IntrospectedArgument CreateOutput_args[] =
+        {
+            { "width", "i", true },
+            { "height", "i", true },
+            { "refresh", "i", true },
+            { "scale", "d", true },
+            { "x", "i", true },
+            { "y", "i", true },
+            { "id", "s", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument DestroyOutput_args[] =
+        {
+            { "id", "s", true },
+            { "destroyed", "b", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument Screenshot_args[] =
+        {
+            { "id", "s", true },
+            { "name", "s", true },
+            { "queued", "b", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedMethod Display_adaptor_methods[] =
+        {
+            { "CreateOutput", CreateOutput_args },
+            { "DestroyOutput", DestroyOutput_args },
+            { "Screenshot", Screenshot_args },
+            { 0, 0 }
+        };
+        static ::DBus::IntrospectedMethod Display_adaptor_signals[] =
+        {
+            { 0, 0 }
+        };
+        static ::DBus::IntrospectedProperty Display_adaptor_properties[] =
+        {
+            { 0, 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedInterface Display_adaptor_interface =
+        {
+            "org.os.Compositor.Display",
+            Display_adaptor_methods,
+            Display_adaptor_signals,
+            Display_adaptor_properties
+        };
+        return &Display_adaptor_interface;
+    }
+
+public:
+
+    /* properties exposed by this interface, use
+     * property() and property(value) to get and set a particular property
+     */
+
+public:
+
+    /* methods exported by this interface,
+     * you will have to implement them in your ObjectAdaptor
+     */
+    virtual std::string CreateOutput(const int32_t& width, const int32_t& height, const int32_t& refresh, const double& scale, const int32_t& x, const int32_t& y) = 0;
+    virtual bool DestroyOutput(const std::string& id) = 0;
+    virtual bool Screenshot(const std::string& id, const std::string& name) = 0;
+
+public:
+
+    /* signal emitters for this interface
+     */
+
+private:
+
+    /* unmarshalers (to unpack the DBus message before calling the actual interface method)
+     */
+    ::DBus::Message _CreateOutput_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        int32_t argin1; ri >> argin1;
+        int32_t argin2; ri >> argin2;
+        int32_t argin3; ri >> argin3;
+        double argin4; ri >> argin4;
+        int32_t argin5; ri >> argin5;
+        int32_t argin6; ri >> argin6;
+        std::string argout1 = CreateOutput(argin1, argin2, argin3, argin4, argin5, argin6);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _DestroyOutput_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::string argin1; ri >> argin1;
+        bool argout1 = DestroyOutput(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _Screenshot_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::string argin1; ri >> argin1;
+        std::string argin2; ri >> argin2;
+        bool argout1 = Screenshot(argin1, argin2);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
 };
 
 } } }
@@ -22,6 +22,9 @@ public:
     : ::DBus::InterfaceAdaptor("org.os.Compositor.Shortcut")
     {
         register_method(Shortcut_adaptor, Register, _Register_stub);
+        register_method(Shortcut_adaptor, RegisterKeysym, _RegisterKeysym_stub);
+        register_method(Shortcut_adaptor, RegisterChord, _RegisterChord_stub);
+        register_method(Shortcut_adaptor, RegisterAll, _RegisterAll_stub);
     }
 
     ::DBus::IntrospectedInterface *introspect() const
@@ -34,6 +37,26 @@ public:
             { "id", "i", false },
             { 0, 0, 0 }
         };
+        static ::DBus::IntrospectedArgument RegisterKeysym_args[] =
+        {
+            { "keysym", "i", true },
+            { "modifiers", "i", true },
+            { "state", "i", true },
+            { "id", "i", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument RegisterChord_args[] =
+        {
+            { "sequence", "a(iii)", true },
+            { "id", "i", false },
+            { 0, 0, 0 }
+        };
+        static ::DBus::IntrospectedArgument RegisterAll_args[] =
+        {
+            { "bindings", "a(iii)", true },
+            { "ids", "ai", false },
+            { 0, 0, 0 }
+        };
         static ::DBus::IntrospectedArgument Shortcut_args[] =
         {
             { "id", "i", false },
@@ -42,6 +65,9 @@ public:
         static ::DBus::IntrospectedMethod Shortcut_adaptor_methods[] =
         {
             { "Register", Register_args },
+            { "RegisterKeysym", RegisterKeysym_args },
+            { "RegisterChord", RegisterChord_args },
+            { "RegisterAll", RegisterAll_args },
             { 0, 0 }
         };
         static ::DBus::IntrospectedMethod Shortcut_adaptor_signals[] =
@@ -75,6 +101,9 @@ public:
      * you will have to implement them in your ObjectAdaptor
      */
     virtual int32_t Register(const int32_t& key_code, const int32_t& modifiers, const int32_t& state) = 0;
+    virtual int32_t RegisterKeysym(const int32_t& keysym, const int32_t& modifiers, const int32_t& state) = 0;
+    virtual int32_t RegisterChord(const std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > >& sequence) = 0;
+    virtual std::vector< int32_t > RegisterAll(const std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > >& bindings) = 0;
 
 public:
 
@@ -105,6 +134,41 @@ private:
         wi << argout1;
         return reply;
     }
+    ::DBus::Message _RegisterKeysym_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        int32_t argin1; ri >> argin1;
+        int32_t argin2; ri >> argin2;
+        int32_t argin3; ri >> argin3;
+        int32_t argout1 = RegisterKeysym(argin1, argin2, argin3);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _RegisterChord_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > > argin1; ri >> argin1;
+        int32_t argout1 = RegisterChord(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
+    ::DBus::Message _RegisterAll_stub(const ::DBus::CallMessage &call)
+    {
+        ::DBus::MessageIter ri = call.reader();
+
+        std::vector< ::DBus::Struct< int32_t, int32_t, int32_t > > argin1; ri >> argin1;
+        std::vector< int32_t > argout1 = RegisterAll(argin1);
+        ::DBus::ReturnMessage reply(call);
+        ::DBus::MessageIter wi = reply.writer();
+        wi << argout1;
+        return reply;
+    }
 };
 
 } } }
@@ -0,0 +1,37 @@
+#ifndef ACTION_H_
+#define ACTION_H_
+
+#include <string>
+
+namespace lumin {
+
+enum ActionType {
+  ACTION_NONE = 0,
+  ACTION_DOCK_LEFT = 1,
+  ACTION_DOCK_RIGHT = 2,
+  ACTION_TOGGLE_MAXIMIZE = 3,
+  ACTION_MINIMIZE_TOP = 4,
+  ACTION_FOCUS_APP = 5,
+  ACTION_EXEC = 6,
+  ACTION_SWITCH_WORKSPACE = 7,
+  ACTION_MOVE_TO_WORKSPACE = 8,
+  ACTION_TOGGLE_OVERVIEW = 9,
+  ACTION_SCREENSHOT = 10
+};
+
+struct Action {
+  ActionType type;
+  std::string argument;
+};
+
+struct ActionBinding {
+  std::string key;
+  int modifiers;
+  Action action;
+};
+
+ActionType action_type_from_name(const std::string& name);
+
+}  // namespace lumin
+
+#endif  // ACTION_H_
@@ -0,0 +1,52 @@
+#ifndef ANIMATOR_H_
+#define ANIMATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "view.h"
+
+namespace lumin {
+
+// Where a view was drawn before a step and where it is drawn after, so the
+// caller can damage just those two places
+struct AnimationStep {
+  View *view;
+  ViewTransform before;
+  ViewTransform after;
+  bool done;
+};
+
+// Moves views between two transforms over time. Nothing runs on its own,
+// each output frame steps every animation to the frame's time, which keeps
+// them in lockstep with the display. When frames arrive late the
+// animations jump to their end instead of stuttering through the rest.
+class Animator {
+ public:
+  Animator();
+
+ public:
+  void animate(View *view, const ViewTransform& from, const ViewTransform& to,
+    uint32_t duration_msec, uint32_t now_msec);
+  void cancel(const View *view);
+  bool active() const;
+
+  std::vector<AnimationStep> step(uint32_t now_msec, uint32_t frame_msec);
+
+ private:
+  struct Animation {
+    View *view;
+    ViewTransform from;
+    ViewTransform to;
+    uint32_t start_msec;
+    uint32_t duration_msec;
+  };
+
+  std::vector<Animation> animations_;
+  bool stepped_;
+  uint32_t last_step_msec_;
+};
+
+}  // namespace lumin
+
+#endif  // ANIMATOR_H_
@@ -0,0 +1,35 @@
+#ifndef BLIT_H_
+#define BLIT_H_
+
+#include <cstdint>
+
+namespace lumin {
+
+// CPU compositing kernels. Pixels are 32 bit premultiplied ARGB in native
+// byte order, as wl_shm hands them over, and strides are in bytes.
+
+// Copies an opaque rectangle
+void blit_copy(uint32_t *dst, int dst_stride, const uint32_t *src, int src_stride,
+  int width, int height);
+
+// Blends a premultiplied rectangle over the destination
+void blit_over(uint32_t *dst, int dst_stride, const uint32_t *src, int src_stride,
+  int width, int height);
+
+// Fills a rectangle with a single color
+void blit_fill(uint32_t *dst, int dst_stride, uint32_t color, int width, int height);
+
+// The kernel set picked for this CPU, one of "avx2", "sse2" or "scalar"
+const char* blit_kernels();
+
+namespace detail {
+
+void blit_over_row_scalar(uint32_t *dst, const uint32_t *src, int width);
+void blit_over_row_sse2(uint32_t *dst, const uint32_t *src, int width);
+void blit_over_row_avx2(uint32_t *dst, const uint32_t *src, int width);
+
+}  // namespace detail
+
+}  // namespace lumin
+
+#endif  // BLIT_H_
@@ -0,0 +1,44 @@
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace lumin {
+
+// Pixels read back from an output in the renderer's ARGB8888 layout. All
+// the captures a frame serves share its one readback, each sees its own
+// part of it from an offset, so nothing is copied before it reaches its
+// consumer. The readback's rows may be bottom up, row() undoes that.
+struct CapturedFrame {
+  std::shared_ptr<const uint8_t[]> pixels;
+  int x, y;
+  int width, height;
+  int stride;
+  int rows;
+  bool y_invert;
+
+  const uint8_t* row(int row) const {
+    int line = y + row;
+    return pixels.get() + (y_invert ? rows - 1 - line : line) * stride + x * 4;
+  }
+};
+
+// Called once for every queued capture. A capture that can't be served,
+// because the readback failed or the output went away, gets a frame
+// without pixels.
+typedef std::function<void(CapturedFrame&& frame)> CaptureCallback;
+
+// A part of an output to read back, in buffer coordinates. Some only want
+// a frame that changed that part, the rest take the next one.
+struct CaptureRequest {
+  int x, y;
+  int width, height;
+  bool damaged_only;
+  CaptureCallback done;
+};
+
+}  // namespace lumin
+
+#endif  // CAPTURE_H_
@@ -2,6 +2,7 @@
 #define CURSOR_H_
 
 #include <wayland-server-core.h>
+#include <set>
 #include <string>
 
 #include "signal.hpp"
@@ -25,10 +26,10 @@ class ICursor {
   virtual ~ICursor() { }
 
  public:
-  virtual void load_scale(int scale) = 0;
+  virtual void load_scale(float scale) = 0;
 
-  virtual int x() const = 0;
-  virtual int y() const = 0;
+  virtual double x() const = 0;
+  virtual double y() const = 0;
 
   virtual void set_surface(wlr_surface *surface, int hotspot_x, int hotspot_y) = 0;
   virtual void set_image(const std::string& name) = 0;
@@ -37,8 +38,8 @@ class ICursor {
   virtual void begin_interactive(View *view, CursorMode mode, unsigned int edges) = 0;
 
  public:
-  Signal<ICursor*, int, int, uint32_t> on_move;
-  Signal<ICursor*, int, int> on_button;
+  Signal<ICursor*, double, double, uint32_t> on_move;
+  Signal<ICursor*, double, double> on_button;
 };
 
 class Cursor : public ICursor {
@@ -46,18 +47,18 @@ class Cursor : public ICursor {
   ~Cursor();
 
   Cursor();
-  Cursor(wlr_output_layout *layout, Seat *seat);
+  Cursor(wlr_output_layout *layout, Seat *seat, wlr_xcursor_manager *cursor_manager);
 
  public:
-  void load_scale(int scale);
+  void load_scale(float scale);
   void warp(int x, int y);
   void set_image(const std::string& name);
   void set_surface(wlr_surface *surface, int hotspot_x, int hotspot_y);
   void begin_interactive(View *view, CursorMode mode, unsigned int edges);
   void add_device(wlr_input_device* device);
 
-  int x() const;
-  int y() const;
+  double x() const;
+  double y() const;
 
  public:
   wl_listener cursor_axis;
@@ -75,6 +76,9 @@ class Cursor : public ICursor {
   wlr_xcursor_manager *cursor_manager_;
   wlr_cursor *cursor_;
 
+  std::set<float> scales_;
+  std::string image_;
+
   wlr_output_layout *layout_;
   Seat *seat_;
 
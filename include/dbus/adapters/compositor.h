@@ -1,7 +1,12 @@
 #ifndef SHORTCUT_H_
 #define SHORTCUT_H_
 
+#include <unistd.h>
+
+#include <future>
+
 #include "compositor_adapter.h"
+#include "key_binding.h"
 #include "server.h"
 
 namespace lumin {
@@ -9,46 +14,154 @@ namespace lumin {
 class CompositorEndpoint :
   public org::os::Compositor::Shortcut_adaptor,
   public org::os::Compositor::Window_adaptor,
+  public org::os::Compositor::Display_adaptor,
   public DBus::IntrospectableAdaptor,
   public DBus::ObjectAdaptor
 {
  public:
   CompositorEndpoint(DBus::Connection &connection, Server *server)
     : DBus::ObjectAdaptor(connection, "/org/os/Compositor")
-    , server_(server) { }
+    , server_(server)
+    , thumbnail_fd_(-1) { }
+
+  ~CompositorEndpoint() {
+    if (thumbnail_fd_ != -1) {
+      close(thumbnail_fd_);
+    }
+  }
 
   int Register(const int& code, const int& modifiers, const int& state) {
-    return server_->add_keybinding(code, modifiers, state);
+    return on_loop([&]() { return server_->add_keybinding(code, modifiers, state); });
+  }
+
+  int RegisterKeysym(const int& keysym, const int& modifiers, const int& state) {
+    return on_loop([&]() { return server_->add_keysym_binding(keysym, modifiers, state); });
+  }
+
+  int RegisterChord(const std::vector<DBus::Struct<int, int, int>>& sequence) {
+    auto key_bindings = to_key_bindings(sequence);
+    return on_loop([&]() { return server_->add_chord(key_bindings); });
+  }
+
+  std::vector<int> RegisterAll(const std::vector<DBus::Struct<int, int, int>>& bindings) {
+    auto key_bindings = to_key_bindings(bindings);
+    return on_loop([&]() { return server_->add_keybindings(key_bindings); });
   }
 
   std::vector<std::string> Apps() {
-    auto apps = server_->apps();
+    auto apps = on_loop([&]() { return server_->apps(); });
     auto results = std::vector<std::string>(apps.begin(), apps.end());
     return results;
   }
 
   void Focus(const std::string& app_id) {
-    server_->focus_app(app_id);
+    on_loop([&]() { server_->focus_app(app_id); });
+  }
+
+  // libdbus duplicates the descriptor while writing the reply, so ours is
+  // only kept until the next request
+  void Thumbnail(const std::string& app_id, DBus::FileDescriptor& fd, int& width, int& height,
+    int& stride, int& slot_size, uint32_t& serial) {
+    if (thumbnail_fd_ != -1) {
+      close(thumbnail_fd_);
+      thumbnail_fd_ = -1;
+    }
+
+    ThumbnailBuffer buffer;
+    if (!on_loop([&]() { return server_->thumbnail(app_id, &buffer); })) {
+      throw DBus::ErrorInvalidArgs("No thumbnail for that app");
+    }
+
+    thumbnail_fd_ = buffer.fd;
+    fd = DBus::FileDescriptor(buffer.fd);
+    width = buffer.width;
+    height = buffer.height;
+    stride = buffer.stride;
+    slot_size = buffer.slot_size;
+    serial = buffer.serial;
+  }
+
+  bool ScreenshotWindow(const std::string& app_id, const std::string& name) {
+    return on_loop([&]() { return server_->screenshot_app(app_id, name); });
   }
 
   void DockLeft() {
-    server_->dock_left();
+    on_loop([&]() { server_->dock_left(); });
   }
 
   void DockRight() {
-    server_->dock_right();
+    on_loop([&]() { server_->dock_right(); });
   }
 
   void Maximize() {
-    server_->toggle_maximize();
+    on_loop([&]() { server_->toggle_maximize(); });
   }
 
   void Minimize() {
-    server_->minimize_top();
+    on_loop([&]() { server_->minimize_top(); });
+  }
+
+  void Overview() {
+    on_loop([&]() { server_->toggle_overview(); });
+  }
+
+  bool SwitchWorkspace(const int& index) {
+    return on_loop([&]() { return server_->switch_workspace(index); });
+  }
+
+  bool MoveToWorkspace(const int& index) {
+    return on_loop([&]() { return server_->move_to_workspace(index); });
+  }
+
+  std::string CreateOutput(const int& width, const int& height, const int& refresh,
+    const double& scale, const int& x, const int& y) {
+    OutputConfig config = {
+      .scale = static_cast<float>(scale),
+      .primary = false,
+      .enabled = true,
+      .x = x,
+      .y = y,
+      .mode = OUTPUT_MODE_EXPLICIT,
+      .width = width,
+      .height = height,
+      .refresh = refresh,
+      .mirror = ""
+    };
+    return on_loop([&]() { return server_->create_virtual_output(config); });
+  }
+
+  bool DestroyOutput(const std::string& id) {
+    return on_loop([&]() { return server_->destroy_virtual_output(id); });
+  }
+
+  bool Screenshot(const std::string& id, const std::string& name) {
+    return on_loop([&]() { return server_->screenshot_output(id, name); });
+  }
+
+ private:
+  // Requests arrive on the D-Bus thread but everything they touch belongs
+  // to the event loop, so they run there and the reply waits for them
+  template <typename Task>
+  auto on_loop(Task task) -> decltype(task()) {
+    try {
+      return server_->loop_queue_.call(task);
+    } catch (const std::future_error&) {
+      throw DBus::ErrorFailed("The compositor is shutting down");
+    }
+  }
+
+  static std::vector<KeyBinding> to_key_bindings(
+    const std::vector<DBus::Struct<int, int, int>>& bindings) {
+    std::vector<KeyBinding> key_bindings;
+    for (auto &binding : bindings) {
+      key_bindings.push_back(KeyBinding(binding._1, binding._2, binding._3));
+    }
+    return key_bindings;
   }
 
  private:
   Server *server_;
+  int thumbnail_fd_;
 };
 
 }  // namespace lumin
@@ -2,6 +2,7 @@
 #define SHORTCUT_H_
 
 #include "shortcut_adapter.h"
+#include "key_binding.h"
 #include "server.h"
 #include <spdlog/spdlog.h>
 
@@ -20,6 +21,28 @@ class ShortcutEndpoint : public org::os::Compositor::Shortcut_adaptor,
     return server_->add_keybinding(code, modifiers, state);
   }
 
+  int RegisterKeysym(const int& keysym, const int& modifiers, const int& state) {
+    return server_->add_keysym_binding(keysym, modifiers, state);
+  }
+
+  int RegisterChord(const std::vector<DBus::Struct<int, int, int>>& sequence) {
+    return server_->add_chord(to_key_bindings(sequence));
+  }
+
+  std::vector<int> RegisterAll(const std::vector<DBus::Struct<int, int, int>>& bindings) {
+    return server_->add_keybindings(to_key_bindings(bindings));
+  }
+
+ private:
+  static std::vector<KeyBinding> to_key_bindings(
+    const std::vector<DBus::Struct<int, int, int>>& bindings) {
+    std::vector<KeyBinding> key_bindings;
+    for (auto &binding : bindings) {
+      key_bindings.push_back(KeyBinding(binding._1, binding._2, binding._3));
+    }
+    return key_bindings;
+  }
+
  private:
   Server *server_;
 };
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -12,16 +13,33 @@ namespace lumin {
 
 class IOS;
 
+// Parses the monitor profiles up front into an index keyed by the sorted
+// ids of the outputs each profile covers. The file is watched, and edits
+// are parsed on the watcher thread into a new index that replaces the old
+// one, so finding a layout on hotplug never touches the file.
 class DisplayConfig : public IDisplayConfig {
  public:
   explicit DisplayConfig(const std::shared_ptr<IOS>& os);
+  ~DisplayConfig();
 
  public:
   std::map<std::string, OutputConfig> find_layout(
     const std::vector<std::shared_ptr<IOutput>>& outputs);
 
+ private:
+  typedef std::map<std::string, OutputConfig> Layout;
+  typedef std::map<std::vector<std::string>, Layout> Profiles;
+
+  std::shared_ptr<const Profiles> load() const;
+  void reload();
+
  private:
   std::shared_ptr<IOS> os_;
+  std::string config_path_;
+
+  std::shared_ptr<const Profiles> profiles_;
+  std::mutex profiles_mutex_;
+  int watch_;
 };
 
 }  // namespace lumin
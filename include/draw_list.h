@@ -0,0 +1,59 @@
+#ifndef DRAW_LIST_H_
+#define DRAW_LIST_H_
+
+#include <vector>
+
+struct wlr_surface;
+struct wlr_texture;
+
+namespace lumin {
+
+struct DrawItem {
+  // Null when the texture is a saved buffer rather than the surface's own
+  wlr_surface *surface;
+  wlr_texture *texture;
+  int x, y;
+  int width, height;
+  int transform;
+  // Covers every pixel of its box, so nothing below it shows through
+  bool opaque;
+  float alpha;
+};
+
+struct DrawRect {
+  int x1, y1;
+  int x2, y2;
+};
+
+// One textured quad clipped to one damage rect
+struct DrawCall {
+  const DrawItem *item;
+  DrawRect clip;
+};
+
+// A snapshot of everything one output frame draws, back to front, in
+// output buffer coordinates. It is taken on the event loop thread before
+// the renderer is bound, and the draw pass only ever reads from it, never
+// from views or layer surfaces.
+class DrawList {
+ public:
+  DrawList(int width, int height);
+
+ public:
+  void add(const DrawItem& item);
+  void append(const DrawList& draw_list);
+
+  const std::vector<DrawItem>& items() const;
+  bool empty() const;
+
+  std::vector<DrawCall> batch(const std::vector<DrawRect>& damage) const;
+
+ private:
+  int width_;
+  int height_;
+  std::vector<DrawItem> items_;
+};
+
+}  // namespace lumin
+
+#endif  // DRAW_LIST_H_
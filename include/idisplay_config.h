@@ -10,12 +10,23 @@ namespace lumin {
 
 class IOutput;
 
+enum OutputModePolicy {
+  OUTPUT_MODE_PREFERRED = 0,
+  OUTPUT_MODE_EXPLICIT = 1,
+  OUTPUT_MODE_HIGHEST_REFRESH = 2
+};
+
 struct OutputConfig {
-  int scale;
+  float scale;
   bool primary;
   bool enabled;
   int x;
   int y;
+  OutputModePolicy mode;
+  int width;
+  int height;
+  int refresh;  // mHz
+  std::string mirror;  // id of the output to clone, if any
 };
 
 class IDisplayConfig {
@@ -0,0 +1,27 @@
+#ifndef IMAGE_ENCODER_H_
+#define IMAGE_ENCODER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+
+namespace lumin {
+
+enum ImageFormat {
+  IMAGE_FORMAT_PNG = 0,
+  IMAGE_FORMAT_QOI = 1
+};
+
+ImageFormat image_format_from_path(const std::string& path);
+
+// Both drop the alpha channel, which an output's frame doesn't really have
+bool encode_png(const CapturedFrame& frame, std::vector<uint8_t> *data);
+void encode_qoi(const CapturedFrame& frame, std::vector<uint8_t> *data);
+
+bool encode_image(const CapturedFrame& frame, ImageFormat format, std::vector<uint8_t> *data);
+
+}  // namespace lumin
+
+#endif  // IMAGE_ENCODER_H_
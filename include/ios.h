@@ -1,6 +1,7 @@
 #ifndef IOS_H_
 #define IOS_H_
 
+#include <functional>
 #include <string>
 
 namespace lumin {
@@ -14,6 +15,12 @@ class IOS {
   virtual std::string open_file(const std::string& filepath) = 0;
   virtual bool file_exists(const std::string& filepath) = 0;
   virtual void execute(const std::string& command) = 0;
+
+  // Calls on_change from a background thread whenever the file is
+  // written, replaced or removed, until the returned watch is removed.
+  // Gives -1 when the file can't be watched.
+  virtual int watch_file(const std::string& filepath, const std::function<void()>& on_change) = 0;
+  virtual void unwatch_file(int watch) = 0;
 };
 
 }  // namespace lumin
@@ -1,19 +1,26 @@
 #ifndef IPLATFORM_H_
 #define IPLATFORM_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "signal.hpp"
 
+struct wl_event_source;
+
 namespace lumin {
 
 class ICursor;
 class Output;
 class Keyboard;
+class LayerSurface;
 class Seat;
 class View;
 
 typedef void (*idle_func)(void* data);
+typedef int (*timer_func)(void* data);
+typedef int (*fd_func)(int fd, uint32_t mask, void* data);
 
 class IPlatform {
  public:
@@ -30,12 +37,21 @@ class IPlatform {
   virtual std::shared_ptr<ICursor> cursor() const = 0;
 
   virtual void add_idle(idle_func function, void *data) = 0;
-  virtual Output* output_at(int x, int y) const = 0;
+  virtual wl_event_source* add_timer(int timeout_ms, timer_func function, void *data) = 0;
+  virtual void remove_timer(wl_event_source *timer) = 0;
+  virtual wl_event_source* add_fd(int fd, fd_func function, void *data) = 0;
+  virtual Output* output_at(double x, double y) const = 0;
+
+  virtual std::string create_virtual_output(int width, int height) = 0;
+  virtual bool destroy_virtual_output(const std::string& id) = 0;
+
+  virtual void set_xwayland_idle_timeout(int seconds) = 0;
 
  public:
   Signal<const std::shared_ptr<Keyboard>&> on_new_keyboard;
   Signal<const std::shared_ptr<Output>&> on_new_output;
   Signal<const std::shared_ptr<View>&> on_new_view;
+  Signal<const std::shared_ptr<LayerSurface>&> on_new_layer_surface;
 
   Signal<bool> on_lid_switch;
 };
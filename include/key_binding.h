@@ -1,7 +1,7 @@
 #ifndef KEY_BINDING_H_
 #define KEY_BINDING_H_
 
-#include <wlr/types/wlr_keyboard.h>
+#include <stddef.h>
 
 namespace lumin {
 
@@ -15,7 +15,13 @@ class KeyBinding {
   int modifiers_;
   int state_;
 
-  bool matches(int modifiers, int key_code, int state);
+  bool matches(int modifiers, int key_code, int state) const;
+
+  bool operator==(const KeyBinding& other) const;
+};
+
+struct KeyBindingHash {
+  size_t operator()(const KeyBinding& binding) const;
 };
 
 }  // namespace lumin
@@ -0,0 +1,62 @@
+#ifndef KEY_BINDING_TABLE_H_
+#define KEY_BINDING_TABLE_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "key_binding.h"
+
+namespace lumin {
+
+// Hash based lookup of registered shortcuts. Bindings are matched on the
+// raw key code first and then on the unshifted keysym of the key, with the
+// keysym's case ignored. Multi key chords are walked one key press at a
+// time through a trie.
+class KeyBindingTable {
+ public:
+  KeyBindingTable();
+
+ public:
+  int add(int key_code, int modifiers, int state);
+  int add_keysym(int keysym, int modifiers, int state);
+  int add_chord(const std::vector<KeyBinding>& sequence);
+
+  std::vector<int> add_all(const std::vector<KeyBinding>& bindings);
+
+  bool dispatch(uint32_t key_code, uint32_t keysym, uint32_t modifiers, int state, int *id);
+
+  size_t size() const;
+
+ private:
+  struct ChordNode {
+    int id;
+    std::unordered_map<KeyBinding, std::unique_ptr<ChordNode>, KeyBindingHash> children;
+  };
+
+  typedef std::unordered_map<KeyBinding, int, KeyBindingHash> BindingMap;
+
+  int insert(BindingMap *bindings, const KeyBinding& binding);
+  bool dispatch_chord(uint32_t key_code, uint32_t modifiers, int state, int *id);
+
+ private:
+  BindingMap key_codes_;
+  BindingMap keysyms_;
+
+  ChordNode chords_;
+  ChordNode *chord_state_;
+  std::unordered_set<uint32_t> chord_keys_;
+
+  int next_id_;
+  size_t size_;
+
+  mutable std::mutex mutex_;
+};
+
+}  // namespace lumin
+
+#endif  // KEY_BINDING_TABLE_H_
@@ -9,12 +9,13 @@ struct wlr_input_device;
 
 namespace lumin {
 
+class KeymapCache;
 class Seat;
 class Server;
 
 class Keyboard {
  public:
-  Keyboard(wlr_input_device *device, Seat* seat);
+  Keyboard(wlr_input_device *device, Seat* seat, KeymapCache *keymap_cache);
 
  public:
   void setup();
@@ -28,11 +29,12 @@ class Keyboard {
   wl_listener key;
 
  public:
-  Signal<uint32_t, uint32_t, uint32_t, int> on_key;
+  Signal<uint32_t, uint32_t, uint32_t, uint32_t, int> on_key;
 
  private:
   wlr_input_device *device_;
   Seat *seat_;
+  KeymapCache *keymap_cache_;
 };
 
 }
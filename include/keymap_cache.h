@@ -0,0 +1,33 @@
+#ifndef KEYMAP_CACHE_H_
+#define KEYMAP_CACHE_H_
+
+#include <map>
+#include <string>
+
+struct xkb_context;
+struct xkb_keymap;
+struct xkb_rule_names;
+
+namespace lumin {
+
+// Compiles each distinct set of RMLVO names once and hands the same
+// keymap to every keyboard that asks for it, so hotplugging a second
+// device doesn't pay for another compile.
+class KeymapCache {
+ public:
+  ~KeymapCache();
+
+  KeymapCache();
+
+ public:
+  xkb_keymap* keymap(const xkb_rule_names& names);
+  size_t size() const;
+
+ private:
+  xkb_context *context_;
+  std::map<std::string, xkb_keymap*> keymaps_;
+};
+
+}  // namespace lumin
+
+#endif  // KEYMAP_CACHE_H_
@@ -0,0 +1,31 @@
+#ifndef LAYER_ARRANGE_H_
+#define LAYER_ARRANGE_H_
+
+#include <cstdint>
+
+struct wlr_box;
+
+namespace lumin {
+
+struct LayerState {
+  uint32_t anchor;
+  int exclusive_zone;
+  int margin_top;
+  int margin_right;
+  int margin_bottom;
+  int margin_left;
+  int width;  // 0 stretches between the left and right anchors
+  int height;  // 0 stretches between the top and bottom anchors
+};
+
+// Places a layer surface inside the bounds following its anchors and
+// margins. A negative size means the surface doesn't fit.
+void arrange_layer_box(const LayerState& state, const wlr_box *bounds, wlr_box *box);
+
+// Shrinks the usable area by the surface's exclusive zone when it is
+// anchored to a single edge
+void apply_exclusive_zone(const LayerState& state, wlr_box *usable_area);
+
+}  // namespace lumin
+
+#endif  // LAYER_ARRANGE_H_
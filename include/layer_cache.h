@@ -0,0 +1,40 @@
+#ifndef LAYER_CACHE_H_
+#define LAYER_CACHE_H_
+
+#include <vector>
+
+#include "draw_list.h"
+#include "render_target.h"
+
+struct wlr_renderer;
+struct wlr_texture;
+
+namespace lumin {
+
+// Flattens the shell's overlay content, the menubar and launcher, into one
+// offscreen texture per output. Windows moving underneath then cost one
+// texture draw rather than one per shell surface. The texture is only
+// redrawn when an overlay surface commits, moves, maps or unmaps.
+class LayerCache {
+ public:
+  ~LayerCache();
+
+  LayerCache();
+
+ public:
+  void invalidate();
+
+  bool valid(const DrawList& draw_list, int width, int height) const;
+  bool update(wlr_renderer *renderer, const DrawList& draw_list, int width, int height);
+
+  wlr_texture* texture() const;
+
+ private:
+  bool dirty_;
+  std::vector<DrawItem> items_;
+  RenderTarget target_;
+};
+
+}  // namespace lumin
+
+#endif  // LAYER_CACHE_H_
@@ -0,0 +1,75 @@
+#ifndef LAYER_SURFACE_H_
+#define LAYER_SURFACE_H_
+
+#include <wayland-server-core.h>
+
+#include "layer_arrange.h"
+#include "signal.hpp"
+#include "view.h"
+
+struct wlr_layer_surface_v1;
+struct wlr_surface;
+struct wlr_box;
+
+namespace lumin {
+
+class Output;
+
+class LayerSurface {
+ public:
+  ~LayerSurface();
+
+  explicit LayerSurface(wlr_layer_surface_v1 *layer_surface);
+
+ public:
+  ViewLayer layer() const;
+  LayerState state() const;
+  Output* output() const;
+
+  bool keyboard_interactive() const;
+  bool state_changed() const;
+
+  void configure(const wlr_box *box);
+  void close();
+
+  wlr_surface* surface() const;
+  wlr_surface* surface_at(double ox, double oy, double *sx, double *sy) const;
+  void for_each_surface(wlr_surface_iterator_func_t iterator, void *data) const;
+
+  void detach_output();
+
+ private:
+  static void layer_surface_map_notify(wl_listener *listener, void *data);
+  static void layer_surface_unmap_notify(wl_listener *listener, void *data);
+  static void layer_surface_commit_notify(wl_listener *listener, void *data);
+  static void layer_surface_destroy_notify(wl_listener *listener, void *data);
+
+ public:
+  Signal<LayerSurface*> on_map;
+  Signal<LayerSurface*> on_unmap;
+  Signal<LayerSurface*> on_commit;
+  Signal<LayerSurface*> on_destroy;
+
+ public:
+  bool mapped;
+  bool deleted;
+
+  // Output-local position and size from the last arrangement
+  int x, y;
+  int width, height;
+
+ private:
+  wlr_layer_surface_v1 *layer_surface_;
+  LayerState state_;
+  bool state_changed_;
+
+ public:
+  wl_listener map_;
+  wl_listener unmap_;
+  wl_listener commit_;
+  wl_listener destroy_;
+};
+
+}  // namespace lumin
+
+#endif  // LAYER_SURFACE_H_
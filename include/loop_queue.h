@@ -0,0 +1,67 @@
+#ifndef LOOP_QUEUE_H_
+#define LOOP_QUEUE_H_
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace lumin {
+
+// Hands work from other threads to the event loop. Tasks are queued under
+// a lock and an eventfd wakes the loop, which runs them in order. Once the
+// queue is closed new tasks are dropped, so anyone waiting on call() gets
+// a broken promise instead of blocking forever.
+class LoopQueue {
+ public:
+  LoopQueue();
+  ~LoopQueue();
+
+ public:
+  bool init();
+  int fd() const;
+
+  void post(const std::function<void()>& task);
+  void run_pending();
+  void close();
+
+  // Runs the task on the loop and waits for its result. Throws
+  // std::future_error when the queue closes before the task could run.
+  template <typename Task>
+  auto call(Task task) -> decltype(task())
+  {
+    typedef decltype(task()) Result;
+
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto result = promise->get_future();
+
+    // The queue holds the only reference, so dropping the task breaks the
+    // promise
+    post([promise = std::move(promise), task]() {
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          task();
+          promise->set_value();
+        } else {
+          promise->set_value(task());
+        }
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+    });
+
+    return result.get();
+  }
+
+ private:
+  int fd_;
+  bool closed_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+};
+
+}  // namespace lumin
+
+#endif  // LOOP_QUEUE_H_
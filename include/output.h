@@ -3,22 +3,49 @@
 
 #include <wayland-server-core.h>
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "capture.h"
+#include "idisplay_config.h"
 #include "signal.hpp"
+#include "view.h"
 
 struct wlr_output_damage;
 struct wlr_output_layout;
 struct wlr_output;
+struct wlr_output_mode;
 struct wlr_renderer;
+struct wlr_texture;
 struct wlr_box;
+struct wlr_surface;
+
+typedef struct pixman_region32 pixman_region32_t;
 
 namespace lumin {
 
 class Cursor;
-class View;
+class DrawList;
+class LayerCache;
+class LayerSurface;
+class SoftwareRenderer;
+class Thumbnail;
+
+// Where a view is drawn in the overview, in output-local layout coordinates
+struct OverviewSlot {
+  std::weak_ptr<View> view;
+  int x, y;
+  int width, height;
+};
+
+// The mode an output picks the next time it is configured
+struct OutputModeRequest {
+  OutputModePolicy policy;
+  int width, height;
+  int refresh;  // mHz
+};
 
 class IOutput {
  public:
@@ -26,9 +53,12 @@ class IOutput {
 
  public:
   virtual std::string id() const = 0;
-  virtual void configure(int scale, bool primary, bool enabled, int x, int y) = 0;
+  virtual bool configure(float scale, bool primary, bool enabled, int x, int y) = 0;
+  virtual void request_mode(OutputModePolicy policy, int width, int height, int refresh) = 0;
+  virtual void mirror(IOutput *source) = 0;
   virtual void take_damage(const View *view) = 0;
   virtual void take_whole_damage() = 0;
+  virtual void take_box_damage(const wlr_box *box) = 0;
   virtual bool is_named(const std::string& name) const = 0;
   virtual bool connected() const = 0;
   virtual void set_connected(bool connected) = 0;
@@ -36,6 +66,10 @@ class IOutput {
   virtual void mark_deleted() = 0;
   virtual bool primary() const = 0;
   virtual int width() const = 0;
+  virtual void schedule_frame() = 0;
+  virtual void set_overview(bool overview) = 0;
+  virtual void set_menubar(View *view) = 0;
+  virtual bool capture(const wlr_box *box, const CaptureCallback& done) = 0;
 };
 
 class Output : public IOutput {
@@ -47,7 +81,8 @@ class Output : public IOutput {
   explicit Output(struct wlr_output *output,
                   wlr_renderer *renderer,
                   wlr_output_damage *damage,
-                  wlr_output_layout *layout);
+                  wlr_output_layout *layout,
+                  SoftwareRenderer *software);
 
  public:
   const wlr_output_damage* damage() const {
@@ -66,10 +101,10 @@ class Output : public IOutput {
   int x() const;
   int y() const;
 
-  void set_menubar(View *view);
   void add_view(View *view);
   void move_view(View *view, double x, double y);
   void maximize_view(View *view);
+  void fullscreen_view(View *view);
   void place_cursor(Cursor *cursor);
 
   bool is_named(const std::string& name) const;
@@ -78,12 +113,16 @@ class Output : public IOutput {
 
   void set_enabled(bool enabled);
   void set_position(int x, int y);
-  void set_scale(int scale);
-  void set_mode();
+  void set_scale(float scale);
+  bool set_mode();
+  void request_mode(OutputModePolicy policy, int width, int height, int refresh);
+  OutputModeRequest requested_mode() const;
+  void mirror(IOutput *source);
+  bool mirroring() const;
 
   wlr_box* box() const;
 
-  void configure(int scale, bool primary, bool enabled, int x, int y);
+  bool configure(float scale, bool primary, bool enabled, int x, int y);
 
   bool connected() const;
   void set_connected(bool connected);
@@ -92,24 +131,64 @@ class Output : public IOutput {
   void set_primary(bool primary);
 
   void add_layout(int x, int y);
+  bool update_layout(int x, int y);
   void remove_layout();
 
   void send_enter(const std::vector<std::shared_ptr<View>>& views);
 
-  void commit();
+  bool commit();
+  void schedule_frame();
 
-  void render(const std::vector<std::shared_ptr<View>>& views) const;
+  void render(const std::vector<std::shared_ptr<View>>& views,
+    const std::vector<Thumbnail*>& thumbnails) const;
   void render_view(View *view) const;
 
+  void set_overview(bool overview);
+  void set_overview_hover(const View *view);
+  std::shared_ptr<View> overview_view_at(double lx, double ly) const;
+
+  bool buffer_area(const wlr_box *box, wlr_box *area) const;
+  bool capture(const wlr_box *box, const CaptureCallback& done);
+  bool capture_damage(const wlr_box *box, const CaptureCallback& done);
+
   void take_damage(const View *view);
+  void take_layer_damage(const LayerSurface *layer_surface);
   void take_whole_damage();
+  void take_box_damage(const wlr_box *box);
+
+  void add_layer_surface(LayerSurface *layer_surface);
+  void remove_layer_surface(LayerSurface *layer_surface);
+  void close_layer_surfaces();
+  void arrange_layers();
+  LayerSurface* layer_surface_at(ViewLayer layer, double lx, double ly,
+    wlr_surface **surface, double *sx, double *sy) const;
+
+  wlr_box usable_area() const;
+  void set_menubar(View *view);
 
   void lock_software_cursors();
   void unlock_software_cursors();
-  int top_margin() const;
   bool deleted() const;
   void mark_deleted();
 
+ private:
+  wlr_output_mode* find_mode() const;
+  wlr_box mirror_box() const;
+  bool covered_by(const View *view) const;
+  bool opaque(const View *view) const;
+  void take_mirror_damage();
+  void read_mirror_pixels() const;
+  bool queue_capture(const wlr_box *box, bool damaged_only, const CaptureCallback& done);
+  bool capturing() const;
+  void read_captures(const pixman_region32_t *damage) const;
+  void fail_captures() const;
+  wlr_texture* upload_mirror_pixels() const;
+  void render_mirror() const;
+  wlr_texture* composite_software(const DrawList& draw_list, pixman_region32_t *damage) const;
+  bool layout_overview(const std::vector<std::shared_ptr<View>>& views) const;
+  const OverviewSlot* overview_slot(const View *view) const;
+  void take_overview_damage(const View *view);
+
  private:
   static void output_destroy_notify(wl_listener *listener, void *data);
   static void output_frame_notify(wl_listener *listener, void *data);
@@ -123,11 +202,40 @@ class Output : public IOutput {
   wlr_renderer *renderer_;
   wlr_output_damage *damage_;
   wlr_output_layout *layout_;
+  std::string id_;
+  OutputModePolicy mode_policy_;
+  int mode_width_;
+  int mode_height_;
+  int mode_refresh_;
   bool enabled_;
   bool connected_;
   bool primary_;
   bool software_cursors_;
   int enter_frames_left_;
+  Output *mirror_source_;
+  std::vector<Output*> mirrors_;
+  mutable bool mirror_readback_;
+  mutable bool mirror_y_invert_;
+  mutable std::vector<uint8_t> mirror_pixels_;
+  mutable wlr_texture *mirror_texture_;
+  mutable const View *fullscreen_view_;
+  SoftwareRenderer *software_;
+  mutable bool software_frame_valid_;
+  mutable std::vector<uint32_t> software_pixels_;
+  mutable wlr_texture *software_texture_;
+  std::unique_ptr<LayerCache> overlay_cache_;
+  bool overview_;
+  const View *overview_hover_;
+  mutable std::vector<OverviewSlot> overview_slots_;
+  mutable std::vector<CaptureRequest> captures_;
+
+  std::vector<LayerSurface*> layers_[VIEW_LAYER_MAX];
+  int menubar_height_;
+
+  struct {
+    int x, y;
+    int width, height;
+  } usable_area_;
 
  public:
   wl_listener destroy_;
@@ -135,9 +243,11 @@ class Output : public IOutput {
   wl_listener mode_;
 
  public:
+  Signal<Output*> on_configure;
   Signal<Output*> on_destroy;
   Signal<Output*> on_frame;
   Signal<Output*> on_mode;
+  mutable Signal<const pixman_region32_t*> on_damage;
   Signal<IOutput*> on_connect;
   Signal<IOutput*> on_disconnect;
 };
@@ -0,0 +1,53 @@
+#ifndef OUTPUT_MANAGER_H_
+#define OUTPUT_MANAGER_H_
+
+#include <wayland-server-core.h>
+
+#include <vector>
+
+struct wlr_output_configuration_v1;
+struct wlr_output_head_v1_state;
+struct wlr_output_layout;
+struct wlr_output_manager_v1;
+
+namespace lumin {
+
+class Output;
+
+// Publishes the output configuration over wlr-output-management and
+// applies the configurations clients such as kanshi or wlr-randr send
+class OutputManager {
+ public:
+  OutputManager(wlr_output_manager_v1 *output_manager, wlr_output_layout *layout);
+
+ public:
+  void add_output(Output *output);
+  void update();
+
+ private:
+  wlr_output_configuration_v1* current_configuration() const;
+  bool test_configuration(wlr_output_configuration_v1 *config) const;
+  bool apply_head(const wlr_output_head_v1_state& state);
+  bool apply_configuration(wlr_output_configuration_v1 *config);
+
+  void output_configured(Output *output);
+  void output_destroyed(Output *output);
+
+ private:
+  static void apply_notify(wl_listener *listener, void *data);
+  static void test_notify(wl_listener *listener, void *data);
+
+ public:
+  wl_listener apply;
+  wl_listener test;
+
+ private:
+  wlr_output_manager_v1 *output_manager_;
+  wlr_output_layout *layout_;
+  std::vector<Output*> outputs_;
+  bool applying_;
+};
+
+}  // namespace lumin
+
+#endif  // OUTPUT_MANAGER_H_
@@ -0,0 +1,25 @@
+#ifndef OUTPUT_MODE_H_
+#define OUTPUT_MODE_H_
+
+#include <vector>
+
+#include "idisplay_config.h"
+
+namespace lumin {
+
+struct OutputMode {
+  int width;
+  int height;
+  int refresh;  // mHz
+  bool preferred;
+};
+
+// Picks the index of the mode that best fits the policy, or -1 when the
+// list is empty. Explicit sizes that the output doesn't offer fall back
+// to the preferred mode.
+int select_output_mode(const std::vector<OutputMode>& modes, OutputModePolicy policy,
+  int width, int height, int refresh);
+
+}  // namespace lumin
+
+#endif  // OUTPUT_MODE_H_
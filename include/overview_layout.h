@@ -0,0 +1,18 @@
+#ifndef OVERVIEW_LAYOUT_H_
+#define OVERVIEW_LAYOUT_H_
+
+#include <vector>
+
+struct wlr_box;
+
+namespace lumin {
+
+// Lays windows of the given sizes out in a grid inside the area, all in one
+// pass. Each is scaled down to fit its cell, never up, and centered in it,
+// and the boxes come back in the same order as the sizes.
+void overview_layout(const wlr_box *area, int gap, const std::vector<wlr_box>& sizes,
+  std::vector<wlr_box> *boxes);
+
+}  // namespace lumin
+
+#endif  // OVERVIEW_LAYOUT_H_
@@ -1,18 +1,44 @@
 #ifndef POSIX_OS_H_
 #define POSIX_OS_H_
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "ios.h"
 
 namespace lumin {
 
 class PosixOS : public IOS {
+ public:
+  ~PosixOS();
+
  public:
   void set_env(const std::string& name, const std::string& value);
   std::string open_file(const std::string& filepath);
   bool file_exists(const std::string& filepath);
   void execute(const std::string& command);
+  int watch_file(const std::string& filepath, const std::function<void()>& on_change);
+  void unwatch_file(int watch);
+
+ private:
+  static void watch_thread(int inotify_fd, int stop_fd, const std::string& filename,
+    const std::function<void()>& on_change);
+
+ private:
+  struct FileWatch {
+    int id;
+    int inotify_fd;
+    int stop_fd;
+    std::thread thread;
+  };
+
+  static void stop_watch(FileWatch *watch);
+
+  std::vector<std::unique_ptr<FileWatch>> watches_;
+  int next_watch_id_ = 0;
 };
 
 }  // namespace lumin
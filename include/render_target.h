@@ -0,0 +1,39 @@
+#ifndef RENDER_TARGET_H_
+#define RENDER_TARGET_H_
+
+struct wlr_renderer;
+struct wlr_texture;
+
+namespace lumin {
+
+// A texture with a framebuffer attached, so the renderer can draw into it
+// instead of into an output. Only usable while some output's render buffer
+// is attached, which is what makes the renderer's context current.
+class RenderTarget {
+ public:
+  ~RenderTarget();
+
+  RenderTarget();
+
+ public:
+  bool resize(wlr_renderer *renderer, int width, int height);
+  void destroy();
+
+  void bind();
+  void unbind();
+
+  wlr_texture* texture() const;
+  int width() const;
+  int height() const;
+
+ private:
+  wlr_texture *texture_;
+  unsigned int framebuffer_;
+  int previous_framebuffer_;
+  int width_;
+  int height_;
+};
+
+}  // namespace lumin
+
+#endif  // RENDER_TARGET_H_
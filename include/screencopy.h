@@ -0,0 +1,67 @@
+#ifndef SCREENCOPY_H_
+#define SCREENCOPY_H_
+
+#include <wayland-server-core.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "capture.h"
+
+struct wlr_box;
+struct wlr_output_layout;
+struct wl_shm_buffer;
+
+typedef struct pixman_region32 pixman_region32_t;
+
+namespace lumin {
+
+class Output;
+struct ScreencopyBuffer;
+struct ScreencopyDamage;
+struct ScreencopyFrame;
+
+// Serves wlr-screencopy from the outputs' own captures, so every client
+// capturing an output in the same frame shares its one readback. Copies
+// into a buffer the client has handed over before only rewrite the parts
+// that changed since.
+class ScreencopyManager {
+ public:
+  ScreencopyManager(wl_display *display, wlr_output_layout *layout);
+  ~ScreencopyManager();
+
+ public:
+  void add_output(Output *output);
+
+ public:
+  void capture_output(wl_resource *manager, uint32_t id, wl_resource *output_resource,
+    const wlr_box *box);
+  void copy(ScreencopyFrame *frame, wl_resource *buffer, bool with_damage);
+
+  void manager_destroyed(wl_resource *manager);
+  void frame_destroyed(ScreencopyFrame *frame);
+  void buffer_destroyed(ScreencopyBuffer *buffer);
+
+ private:
+  void frame_captured(ScreencopyFrame *frame, CapturedFrame&& pixels);
+  void copy_pixels(ScreencopyFrame *frame, const CapturedFrame& pixels, wl_shm_buffer *shm_buffer);
+  ScreencopyBuffer* buffer_for(ScreencopyFrame *frame);
+  ScreencopyDamage* damage_for(ScreencopyFrame *frame);
+
+  void output_damaged(Output *output, const pixman_region32_t *damage);
+  void output_destroyed(Output *output);
+
+ private:
+  wlr_output_layout *layout_;
+  wl_global *global_;
+
+  std::vector<std::shared_ptr<ScreencopyFrame>> frames_;
+  std::map<wl_resource*, std::unique_ptr<ScreencopyBuffer>> buffers_;
+  std::map<std::pair<wl_resource*, Output*>, std::unique_ptr<ScreencopyDamage>> damage_;
+};
+
+}  // namespace lumin
+
+#endif  // SCREENCOPY_H_
@@ -0,0 +1,46 @@
+#ifndef SCREENSHOT_WRITER_H_
+#define SCREENSHOT_WRITER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "capture.h"
+
+namespace lumin {
+
+// Encodes captured frames and writes them out on a thread of its own, so
+// the event loop only ever pays for the readback. The thread starts with
+// the first screenshot, and whatever is still queued is written before
+// the writer is destroyed.
+class ScreenshotWriter {
+ public:
+  ~ScreenshotWriter();
+
+  ScreenshotWriter();
+
+ public:
+  void write(CapturedFrame&& frame, const std::string& path);
+
+ private:
+  struct Job {
+    CapturedFrame frame;
+    std::string path;
+  };
+
+  void run();
+  static bool save(const Job& job);
+
+ private:
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Job> jobs_;
+  bool quit_;
+};
+
+}  // namespace lumin
+
+#endif  // SCREENSHOT_WRITER_H_
@@ -10,7 +10,14 @@
 #include <unordered_set>
 #include <vector>
 
+#include "action.h"
+#include "animator.h"
 #include "cursor_mode.h"
+#include "idisplay_config.h"
+#include "key_binding_table.h"
+#include "loop_queue.h"
+#include "thumbnail.h"
+#include "view.h"
 
 typedef uint32_t xkb_keysym_t;
 
@@ -30,7 +37,9 @@ namespace lumin
 class Cursor;
 class KeyBinding;
 class Keyboard;
+class LayerSurface;
 class Output;
+class ScreenshotWriter;
 class Seat;
 class CompositorEndpoint;
 class View;
@@ -39,6 +48,8 @@ class IOS;
 class IDisplayConfig;
 class IOutput;
 class ICursor;
+class Transaction;
+class Workspace;
 
 class Server
 {
@@ -64,32 +75,75 @@ class Server
 
   void enable_output(const std::string &name, bool enabled);
 
+  std::string create_virtual_output(const OutputConfig &config);
+  bool destroy_virtual_output(const std::string &id);
+
   void dock_right();
   void dock_left();
 
   void minimize_top();
+  void toggle_overview();
   void toggle_maximize();
   void maximize_view(View *view);
 
-  bool key(uint32_t keycode, uint32_t modifiers, int state);
+  bool switch_workspace(int index);
+  bool move_to_workspace(int index);
+  Workspace* active_workspace(const std::string& output_id);
+
+  bool key(uint32_t keycode, xkb_keysym_t keysym, uint32_t modifiers, int state);
 
   int add_keybinding(int key_code, int modifiers, int state);
+  int add_keysym_binding(xkb_keysym_t keysym, int modifiers, int state);
+  int add_chord(const std::vector<KeyBinding>& sequence);
+  std::vector<int> add_keybindings(const std::vector<KeyBinding>& bindings);
+
+  int add_action(xkb_keysym_t keysym, int modifiers, const Action& action);
+  void run_action(const Action& action);
 
  public:
   View *desktop_view_at(double lx, double ly, wlr_surface **surface, double *sx, double *sy);
   View *view_from_surface(wlr_surface *surface);
+  LayerSurface *layer_surface_at(const std::vector<ViewLayer>& layers, double lx, double ly,
+    wlr_surface **surface, double *sx, double *sy);
 
   std::vector<std::string> apps() const;
+  bool thumbnail(const std::string& app_id, ThumbnailBuffer *buffer);
+
+  void screenshot(const std::string& target);
+  bool screenshot_output(const std::string& output_id, const std::string& name);
+  bool screenshot_app(const std::string& app_id, const std::string& name);
 
  private:
+  void load_actions();
+  void load_virtual_outputs();
+  void load_xwayland();
+
   void focus_top();
 
+  std::vector<std::shared_ptr<Workspace>>& output_workspaces(const std::string& output_id);
+  Workspace* current_workspace();
+  void activate_workspace(Workspace *workspace);
+  std::vector<std::shared_ptr<View>> visible_views(const std::string& output_id) const;
+  std::vector<std::shared_ptr<View>> workspace_views() const;
+  void schedule_hidden_frames();
+  void schedule_thumbnails();
+  void schedule_overview_frames();
+  void expire_thumbnails();
+  std::vector<Thumbnail*> due_thumbnails() const;
+
+  bool screenshot_view(View *view, const std::string& path);
+  bool capture_screenshot(IOutput *output, const wlr_box *box, const std::string& path);
+  std::string screenshot_path(const std::string& name = "") const;
+
   void position_view(View *view);
 
   void damage_outputs();
   void damage_output(View *view);
 
-  Output *primary_output() const;
+  void animate_view(View *view, const ViewTransform& from, const ViewTransform& to,
+    uint32_t duration_msec);
+  void damage_animation(View *view, const ViewTransform& transform);
+  void step_animations(Output *output);
 
  public:
   void view_created(const std::shared_ptr<View> &view);
@@ -101,12 +155,25 @@ class Server
   void view_moved(View *view);
   void view_focused(View *view);
   void view_damaged(View *view);
+  void view_configured(View *view, int x, int y, int width, int height);
+  void view_committed(View *view);
+
+  void thumbnail_rendered(Thumbnail *thumbnail);
+
+  void transaction_applied(Transaction *transaction);
+
+  void layer_surface_created(const std::shared_ptr<LayerSurface> &layer_surface);
+  void layer_surface_mapped(LayerSurface *layer_surface);
+  void layer_surface_unmapped(LayerSurface *layer_surface);
+  void layer_surface_committed(LayerSurface *layer_surface);
+  void layer_surface_destroyed(LayerSurface *layer_surface);
 
   void keyboard_created(const std::shared_ptr<Keyboard> &keyboard);
-  void keyboard_key(uint32_t time_msec, uint32_t keycode, uint32_t modifiers, int state);
+  void keyboard_key(uint32_t time_msec, uint32_t keycode, xkb_keysym_t keysym,
+    uint32_t modifiers, int state);
 
-  void cursor_motion(ICursor* cursor, int x, int y, uint32_t time);
-  void cursor_button(ICursor* cursor, int x, int y);
+  void cursor_motion(ICursor* cursor, double x, double y, uint32_t time);
+  void cursor_button(ICursor* cursor, double x, double y);
 
   void output_created(const std::shared_ptr<Output> &output);
   void output_destroyed(Output *output);
@@ -118,17 +185,46 @@ class Server
 
  private:
   static void dbus_thread(Server *server);
+  static int run_queued_tasks(int fd, uint32_t mask, void *data);
 
  private:
   static void purge_deleted_views(void *data);
+  static void purge_deleted_layer_surfaces(void *data);
   static void purge_deleted_outputs(void *data);
+  static void purge_applied_transactions(void *data);
+  static void commit_transaction(void *data);
+  static int send_hidden_frames(void *data);
+  static int send_thumbnail_frames(void *data);
+  static int send_overview_frames(void *data);
 
  public:
-  std::map<uint, KeyBinding> key_bindings;
+  KeyBindingTable key_bindings;
+  std::map<int, Action> actions_;
 
   std::vector<std::shared_ptr<Keyboard>> keyboards_;
   std::vector<std::shared_ptr<IOutput>> outputs_;
   std::vector<std::shared_ptr<View>> views_;
+  std::vector<std::shared_ptr<LayerSurface>> layer_surfaces_;
+
+  std::map<std::string, std::vector<std::shared_ptr<Workspace>>> workspaces_;
+  wl_event_source *hidden_frame_timer_;
+
+  bool overview_;
+  wl_event_source *overview_frame_timer_;
+
+  std::map<const View*, std::shared_ptr<Thumbnail>> thumbnails_;
+  wl_event_source *thumbnail_timer_;
+
+  std::shared_ptr<ScreenshotWriter> screenshot_writer_;
+
+  Animator animator_;
+  std::map<const View*, ViewTransform> animation_origins_;
+
+  std::map<std::string, OutputConfig> virtual_outputs_;
+  std::unique_ptr<OutputConfig> pending_virtual_output_;
+
+  std::shared_ptr<Transaction> pending_transaction_;
+  std::vector<std::shared_ptr<Transaction>> transactions_;
 
   std::shared_ptr<Seat> seat_;
   std::shared_ptr<IPlatform> platform_;
@@ -137,6 +233,7 @@ class Server
   std::shared_ptr<ICursor> cursor_;
 
   std::unique_ptr<CompositorEndpoint> endpoint_;
+  LoopQueue loop_queue_;
 
   std::thread dbus_;
 };
@@ -0,0 +1,27 @@
+#ifndef SHORTCUT_CONFIG_H_
+#define SHORTCUT_CONFIG_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "action.h"
+
+namespace lumin {
+
+class IOS;
+
+class ShortcutConfig {
+ public:
+  explicit ShortcutConfig(const std::shared_ptr<IOS>& os);
+
+ public:
+  std::vector<ActionBinding> load();
+
+ private:
+  std::shared_ptr<IOS> os_;
+};
+
+}  // namespace lumin
+
+#endif  // SHORTCUT_CONFIG_H_
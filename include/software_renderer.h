@@ -0,0 +1,73 @@
+#ifndef SOFTWARE_RENDERER_H_
+#define SOFTWARE_RENDERER_H_
+
+#include <wayland-server-core.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+struct wlr_compositor;
+struct wlr_surface;
+
+namespace lumin {
+
+class DrawList;
+class SoftwareRenderer;
+
+// The CPU copy of a surface's last committed shm buffer
+struct ShadowBuffer {
+  wlr_surface *surface;
+  SoftwareRenderer *renderer;
+
+  std::vector<uint32_t> pixels;
+  int width, height;
+  bool opaque;
+  bool valid;
+
+  wl_listener commit;
+  wl_listener destroy;
+};
+
+// Composites frames on the CPU when the only GL available is an emulated one
+// such as llvmpipe, where every textured quad costs a full software raster.
+// Shm buffers are copied into shadows as clients commit them, so a frame is
+// a handful of blits into one framebuffer limited to the damaged rects.
+class SoftwareRenderer {
+ public:
+  ~SoftwareRenderer();
+
+  SoftwareRenderer();
+
+ public:
+  void init(wlr_compositor *compositor);
+
+  const ShadowBuffer* shadow(const wlr_surface *surface) const;
+
+  bool can_composite(const DrawList& draw_list) const;
+  void composite(const DrawList& draw_list, uint32_t *pixels, int stride,
+    int x, int y, int width, int height) const;
+
+ private:
+  void track_surface(wlr_surface *surface);
+  void update_shadow(ShadowBuffer *shadow);
+
+ private:
+  static void new_surface_notify(wl_listener *listener, void *data);
+  static void surface_commit_notify(wl_listener *listener, void *data);
+  static void surface_destroy_notify(wl_listener *listener, void *data);
+
+ public:
+  std::map<const wlr_surface*, std::unique_ptr<ShadowBuffer>> shadows;
+
+ public:
+  wl_listener new_surface;
+
+ private:
+  wlr_compositor *compositor_;
+};
+
+}  // namespace lumin
+
+#endif  // SOFTWARE_RENDERER_H_
@@ -0,0 +1,73 @@
+#ifndef THUMBNAIL_H_
+#define THUMBNAIL_H_
+
+#include <cstdint>
+
+#include "render_target.h"
+#include "signal.hpp"
+
+struct wlr_renderer;
+
+namespace lumin {
+
+class View;
+
+// What the shell needs to map and read a thumbnail. The image for a serial
+// starts (serial % 2) * slot_size bytes into the memfd.
+struct ThumbnailBuffer {
+  int fd;
+  int width, height;
+  int stride;
+  int slot_size;
+  uint32_t serial;
+};
+
+// A downscaled copy of a view for the shell's switcher and dock. The pixels
+// live in a memfd holding two slots sized for the largest thumbnail, which
+// the shell maps once. Each redraw goes to the slot the shell isn't reading
+// and then bumps the serial, and serial % 2 picks the slot to read, so the
+// shell never sees a half-written image. Redraws only follow damage to the
+// view and are spaced out so a busy window doesn't cost a readback a frame.
+// A thumbnail the shell hasn't asked for in a while expires.
+class Thumbnail {
+ public:
+  ~Thumbnail();
+
+  explicit Thumbnail(View *view);
+
+ public:
+  bool init();
+
+  void damage();
+  bool dirty() const;
+  bool due(uint32_t now_msec) const;
+  void render(wlr_renderer *renderer, uint32_t now_msec);
+
+  void request(uint32_t now_msec);
+  bool expired(uint32_t now_msec) const;
+
+  ThumbnailBuffer buffer() const;
+
+  static void fit(int width, int height, int *fit_width, int *fit_height);
+
+ public:
+  View *view;
+
+  Signal<Thumbnail*> on_render;
+
+ private:
+  int fd_;
+  uint8_t *data_;
+  int width_;
+  int height_;
+  uint32_t serial_;
+  bool dirty_;
+  bool rendered_;
+  uint32_t rendered_msec_;
+  uint32_t requested_msec_;
+  RenderTarget target_;
+};
+
+}  // namespace lumin
+
+#endif  // THUMBNAIL_H_
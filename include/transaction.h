@@ -0,0 +1,66 @@
+#ifndef TRANSACTION_H_
+#define TRANSACTION_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "signal.hpp"
+
+struct wl_event_source;
+
+namespace lumin {
+
+class IPlatform;
+class View;
+
+// Collects the geometry changes of one or more views and applies them
+// together once every client has acked and committed its new size, or
+// once the timeout expires. Until then each view keeps presenting its
+// last buffer at its old position so a layout change lands in one frame.
+class Transaction {
+ public:
+  ~Transaction();
+
+  explicit Transaction(IPlatform *platform);
+
+ public:
+  void add(View *view, int x, int y, int width, int height);
+  void remove(View *view);
+  bool contains(const View *view) const;
+  bool empty() const;
+  std::vector<View*> views() const;
+
+  void commit();
+  void view_committed(View *view);
+
+  bool ready() const;
+  bool done() const;
+
+ private:
+  void apply();
+
+  static int timeout_notify(void *data);
+
+ public:
+  Signal<Transaction*> on_apply;
+
+ private:
+  struct Instruction {
+    View *view;
+    int x, y;
+    int width, height;
+    uint32_t serial;
+    bool ready;
+  };
+
+  IPlatform *platform_;
+  wl_event_source *timer_;
+  std::vector<Instruction> instructions_;
+  bool committed_;
+  bool done_;
+};
+
+}  // namespace lumin
+
+#endif  // TRANSACTION_H_
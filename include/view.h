@@ -4,6 +4,7 @@
 #include <wayland-server-core.h>
 
 #include <string>
+#include <vector>
 
 #include "cursor_mode.h"
 #include "signal.hpp"
@@ -16,6 +17,7 @@ struct wlr_box;
 struct wlr_output;
 struct wlr_seat;
 struct wlr_output_layout;
+struct wlr_buffer;
 
 namespace lumin {
 
@@ -23,6 +25,7 @@ class ICursor;
 class Output;
 class Seat;
 class Server;
+class Workspace;
 
 enum WindowState {
   WM_WINDOW_STATE_WINDOW = 0,
@@ -39,6 +42,24 @@ enum ViewLayer {
   VIEW_LAYER_MAX = 4
 };
 
+// The buffer of one of a view's surfaces, kept with its offset from the
+// view while a transaction is pending
+struct SavedBuffer {
+  wlr_buffer *buffer;
+  int x, y;
+  int width, height;
+  int transform;
+};
+
+// Where a view's geometry is drawn and how opaque, in layout coordinates.
+// Only used part way through an animation, otherwise a view is drawn at
+// its own position and size.
+struct ViewTransform {
+  double x, y;
+  double width, height;
+  float alpha;
+};
+
 typedef void (*wlr_surface_iterator_func_t)(struct wlr_surface *surface,
   int sx, int sy, void *data);
 
@@ -53,6 +74,7 @@ class View {
   bool maximized() const;
   virtual void minimize();
   bool fullscreen() const;
+  void enter_fullscreen(wlr_output *requested);
 
   bool tiled() const;
   void tile_left();
@@ -63,8 +85,8 @@ class View {
 
   ViewLayer layer() const;
 
-  bool is_launcher() const;
   bool is_menubar() const;
+  bool is_launcher() const;
   bool is_shell() const;
 
   bool view_at(double lx, double ly, wlr_surface **surface, double *sx, double *sy);
@@ -77,6 +99,12 @@ class View {
   void tile(int edges);
   void save_geometry();
 
+  void configure(int x, int y, int width, int height);
+
+  void save_buffers();
+  void release_buffers();
+  const std::vector<SavedBuffer>& saved_buffers() const;
+
   bool is_always_focused() const;
 
   virtual void geometry(wlr_box *box) const = 0;
@@ -99,7 +127,9 @@ class View {
 
   virtual void set_tiled(int edges) = 0;
   virtual void set_maximized(bool maximized) = 0;
-  virtual void set_size(int width, int height) = 0;
+  virtual void set_fullscreen(bool fullscreen) = 0;
+  virtual uint32_t set_size(int width, int height) = 0;
+  virtual uint32_t configure_serial() const = 0;
 
   virtual bool has_surface(const wlr_surface *surface) const = 0;
   virtual void for_each_surface(wlr_surface_iterator_func_t iterator, void *data) const = 0;
@@ -121,12 +151,17 @@ class View {
   Signal<View*> on_move;
   Signal<View*> on_commit;
   Signal<View*> on_focus;
+  Signal<View*, int, int, int, int> on_configure;
 
  public:
   bool mapped;
   double x, y;
   bool minimized;
   bool deleted;
+  Workspace *workspace;
+
+  bool animating;
+  ViewTransform animation;
 
  protected:
   WindowState state;
@@ -136,14 +171,13 @@ class View {
     int x, y;
   } saved_state_;
 
+  std::vector<SavedBuffer> saved_buffers_;
+
  protected:
   ICursor *cursor_;
   wlr_output_layout *layout_;
   Seat *seat_;
 
- public:
-  static const int MENU_HEIGHT = 27;
-
  protected:
   wl_listener map;
   wl_listener unmap;
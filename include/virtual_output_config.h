@@ -0,0 +1,26 @@
+#ifndef VIRTUAL_OUTPUT_CONFIG_H_
+#define VIRTUAL_OUTPUT_CONFIG_H_
+
+#include <memory>
+#include <vector>
+
+#include "idisplay_config.h"
+
+namespace lumin {
+
+class IOS;
+
+class VirtualOutputConfig {
+ public:
+  explicit VirtualOutputConfig(const std::shared_ptr<IOS>& os);
+
+ public:
+  std::vector<OutputConfig> load();
+
+ private:
+  std::shared_ptr<IOS> os_;
+};
+
+}  // namespace lumin
+
+#endif  // VIRTUAL_OUTPUT_CONFIG_H_
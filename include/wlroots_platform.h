@@ -5,23 +5,35 @@
 
 #include <wayland-server-core.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 struct wlr_backend;
 struct wlr_display;
 struct wlr_output_layout;
 struct wlr_renderer;
 struct wlr_xdg_shell;
+struct wlr_layer_shell_v1;
 struct wlr_surface;
 struct wlr_input_device;
+struct wlr_output;
 struct wlr_output_manager_v1;
 struct wlr_data_control_manager_v1;
 struct wlr_xcursor_manager;
+struct wlr_xwayland;
+struct wlr_compositor;
+struct wlr_seat;
 
 namespace lumin {
 
 class ICursor;
 class Cursor;
+class KeymapCache;
+class OutputManager;
+class ScreencopyManager;
 class Seat;
+class SoftwareRenderer;
+class View;
 
 class WlRootsPlatform : public IPlatform {
  public:
@@ -39,26 +51,52 @@ class WlRootsPlatform : public IPlatform {
   std::shared_ptr<ICursor> cursor() const;
 
   void add_idle(idle_func func, void *data);
+  wl_event_source* add_timer(int timeout_ms, timer_func func, void *data);
+  void remove_timer(wl_event_source *timer);
+  wl_event_source* add_fd(int fd, fd_func func, void *data);
 
-  Output* output_at(int x, int y) const;
+  Output* output_at(double x, double y) const;
+
+  std::string create_virtual_output(int width, int height);
+  bool destroy_virtual_output(const std::string& id);
+
+  void set_xwayland_idle_timeout(int seconds);
 
 
  private:
   wl_display *display_;
   wlr_backend *backend_;
+  wlr_backend *headless_backend_;
   wlr_renderer *renderer_;
   wlr_xdg_shell *xdg_shell_;
+  wlr_layer_shell_v1 *layer_shell_;
   wlr_output_layout *layout_;
   wlr_xcursor_manager *xcursor_manager_;
-  wlr_output_manager_v1 *output_manager_;
+  wlr_compositor *compositor_;
+  wlr_seat *wlr_seat_;
+  wlr_xwayland *xwayland_;
+
+  wl_event_source *xwayland_idle_timer_;
+  int xwayland_idle_timeout_;
+  int xwayland_views_;
 
   std::shared_ptr<Seat> seat_;
+  std::shared_ptr<KeymapCache> keymap_cache_;
+  std::shared_ptr<OutputManager> output_manager_;
+  std::shared_ptr<ScreencopyManager> screencopy_manager_;
+  std::shared_ptr<SoftwareRenderer> software_renderer_;
+
+  std::vector<wlr_output*> virtual_outputs_;
 
  private:
   static void new_input_notify(wl_listener *listener, void *data);
   static void new_output_notify(wl_listener *listener, void *data);
   static void new_surface_notify(wl_listener *listener, void *data);
+  static void new_layer_surface_notify(wl_listener *listener, void *data);
   static void toggle_lid_notify(wl_listener *listener, void *data);
+  static void new_xwayland_surface_notify(wl_listener *listener, void *data);
+  static void xwayland_ready_notify(wl_listener *listener, void *data);
+  static int xwayland_idle_notify(void *data);
 
  private:
   void handle_cursor_button(Cursor *cursor, int x, int y);
@@ -68,11 +106,19 @@ class WlRootsPlatform : public IPlatform {
   void new_keyboard(wlr_input_device *device);
   void new_switch(wlr_input_device *device);
 
+  bool start_xwayland();
+  void stop_xwayland();
+  void schedule_xwayland_idle();
+  void xwayland_view_destroyed(View *view);
+
  private:
   wl_listener new_input;
   wl_listener new_output;
   wl_listener new_surface;
+  wl_listener new_layer_surface;
   wl_listener lid_toggle;
+  wl_listener new_xwayland_surface;
+  wl_listener xwayland_ready;
 
  private:
   std::shared_ptr<ICursor> cursor_;
@@ -0,0 +1,40 @@
+#ifndef WORKSPACE_H_
+#define WORKSPACE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lumin {
+
+class View;
+
+// One virtual desktop on an output. Each workspace keeps its own stacking
+// order, front to back, so switching only flips which list gets rendered
+// and hit-tested rather than touching every view.
+class Workspace {
+ public:
+  Workspace(const std::string& output, int index);
+
+ public:
+  void add_view(const std::shared_ptr<View>& view);
+  void remove_view(const View *view);
+  bool has_view(const View *view) const;
+
+  void raise_view(const View *view);
+  void lower_view(const View *view);
+
+  const std::vector<std::shared_ptr<View>>& views() const;
+
+ public:
+  std::string output;
+  int index;
+  bool active;
+
+ private:
+  std::vector<std::shared_ptr<View>> views_;
+};
+
+}  // namespace lumin
+
+#endif  // WORKSPACE_H_
@@ -48,7 +48,9 @@ class XDGView : public View {
 
   void set_tiled(int edges);
   void set_maximized(bool maximized);
-  void set_size(int width, int height);
+  void set_fullscreen(bool fullscreen);
+  uint32_t set_size(int width, int height);
+  uint32_t configure_serial() const;
 
   bool is_root() const;
   View* parent() const;
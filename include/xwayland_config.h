@@ -0,0 +1,27 @@
+#ifndef XWAYLAND_CONFIG_H_
+#define XWAYLAND_CONFIG_H_
+
+#include <memory>
+
+namespace lumin {
+
+class IOS;
+
+struct XWaylandSettings {
+  int idle_timeout;
+};
+
+class XWaylandConfig {
+ public:
+  explicit XWaylandConfig(const std::shared_ptr<IOS>& os);
+
+ public:
+  XWaylandSettings load();
+
+ private:
+  std::shared_ptr<IOS> os_;
+};
+
+}  // namespace lumin
+
+#endif  // XWAYLAND_CONFIG_H_
@@ -0,0 +1,86 @@
+#ifndef XWAYLAND_VIEW_H
+#define XWAYLAND_VIEW_H
+
+#include <wayland-server-core.h>
+
+#include <string>
+
+#include "view.h"
+
+struct wlr_xwayland_surface;
+struct wlr_surface;
+struct wlr_box;
+struct wlr_output_layout;
+
+namespace lumin {
+
+class Output;
+class Seat;
+
+class XWaylandView : public View {
+ public:
+  XWaylandView(wlr_xwayland_surface *surface, ICursor *cursor, wlr_output_layout *layout,
+    Seat *seat);
+
+ public:
+  void geometry(wlr_box *box) const;
+  void extents(wlr_box *box) const;
+
+  void move(int x, int y);
+  void resize(double width, double height);
+
+  std::string id() const;
+  std::string title() const;
+
+  void enter(const Output* output);
+
+  uint min_width() const;
+  uint min_height() const;
+
+  void set_tiled(int edges);
+  void set_maximized(bool maximized);
+  void set_fullscreen(bool fullscreen);
+  uint32_t set_size(int width, int height);
+  uint32_t configure_serial() const;
+
+  bool is_root() const;
+  View* parent() const;
+  const View *root() const;
+
+  bool has_surface(const wlr_surface *surface) const;
+  void for_each_surface(wlr_surface_iterator_func_t iterator, void *data) const;
+
+  bool steals_focus() const;
+
+ private:
+  bool is_unmanaged() const;
+  wlr_surface* surface() const;
+  void activate();
+  void deactivate();
+  wlr_surface* surface_at(double sx, double sy, double *sub_x, double *sub_y);
+
+ public:
+  wl_listener destroy;
+  wl_listener request_resize;
+  wl_listener request_fullscreen;
+  wl_listener set_geometry;
+
+ public:
+  static void xwayland_surface_map_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_unmap_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_commit_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_destroy_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_request_configure_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_request_move_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_request_resize_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_request_maximize_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_request_fullscreen_notify(wl_listener *listener, void *data);
+  static void xwayland_surface_set_geometry_notify(wl_listener *listener, void *data);
+
+ private:
+  wlr_xwayland_surface *xwayland_surface_;
+};
+
+}  // namespace lumin
+
+#endif  // XWAYLAND_VIEW_H
@@ -0,0 +1,103 @@
+#include "animator.h"
+
+#include <algorithm>
+
+namespace lumin {
+
+// A step this many frames after the last means vblanks were missed, and
+// the rest of the animation would only be seen as a stutter
+const uint32_t ANIMATION_LATE_FRAMES = 2;
+
+static double ease_out(double t)
+{
+  double inverse = 1.0 - t;
+  return 1.0 - inverse * inverse * inverse;
+}
+
+static ViewTransform interpolate(const ViewTransform& from, const ViewTransform& to, double t)
+{
+  ViewTransform transform = {
+    .x = from.x + (to.x - from.x) * t,
+    .y = from.y + (to.y - from.y) * t,
+    .width = from.width + (to.width - from.width) * t,
+    .height = from.height + (to.height - from.height) * t,
+    .alpha = static_cast<float>(from.alpha + (to.alpha - from.alpha) * t)
+  };
+  return transform;
+}
+
+Animator::Animator()
+  : stepped_(false)
+  , last_step_msec_(0)
+{
+
+}
+
+// Replaces any animation the view already has, so a new one should start
+// from wherever the view is currently drawn
+void Animator::animate(View *view, const ViewTransform& from, const ViewTransform& to,
+  uint32_t duration_msec, uint32_t now_msec)
+{
+  if (animations_.empty()) {
+    stepped_ = false;
+  }
+
+  cancel(view);
+
+  Animation animation = {
+    .view = view,
+    .from = from,
+    .to = to,
+    .start_msec = now_msec,
+    .duration_msec = duration_msec
+  };
+  animations_.push_back(animation);
+
+  view->animating = true;
+  view->animation = from;
+}
+
+void Animator::cancel(const View *view)
+{
+  std::erase_if(animations_, [view](auto &el) { return el.view == view; });
+}
+
+bool Animator::active() const
+{
+  return !animations_.empty();
+}
+
+std::vector<AnimationStep> Animator::step(uint32_t now_msec, uint32_t frame_msec)
+{
+  bool late = stepped_ && now_msec - last_step_msec_ > ANIMATION_LATE_FRAMES * frame_msec;
+  stepped_ = true;
+  last_step_msec_ = now_msec;
+
+  std::vector<AnimationStep> steps;
+  for (auto &animation : animations_) {
+    uint32_t elapsed = now_msec - animation.start_msec;
+    bool done = late || elapsed >= animation.duration_msec;
+
+    View *view = animation.view;
+    AnimationStep step = {
+      .view = view,
+      .before = view->animation,
+      .after = animation.to,
+      .done = done
+    };
+
+    if (!done) {
+      double t = static_cast<double>(elapsed) / animation.duration_msec;
+      step.after = interpolate(animation.from, animation.to, ease_out(t));
+    }
+
+    view->animation = step.after;
+    view->animating = !done;
+    steps.push_back(step);
+  }
+
+  std::erase_if(animations_, [](auto &el) { return !el.view->animating; });
+  return steps;
+}
+
+}  // namespace lumin
@@ -0,0 +1,243 @@
+#include "blit.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLIT_X86
+#endif
+
+namespace lumin {
+
+namespace {
+
+typedef void (*over_row_func)(uint32_t *dst, const uint32_t *src, int width);
+
+struct kernels {
+  over_row_func over_row;
+  const char *name;
+};
+
+// x * y / 255 rounded to nearest, exact for 8 bit inputs
+inline uint32_t mul_div255(uint32_t x, uint32_t y)
+{
+  uint32_t t = x * y + 128;
+  return (t + (t >> 8)) >> 8;
+}
+
+kernels select_kernels()
+{
+#ifdef BLIT_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return { detail::blit_over_row_avx2, "avx2" };
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return { detail::blit_over_row_sse2, "sse2" };
+  }
+#endif
+  return { detail::blit_over_row_scalar, "scalar" };
+}
+
+const kernels& active_kernels()
+{
+  static const kernels selected = select_kernels();
+  return selected;
+}
+
+template<typename T>
+T* row(T *pixels, int stride, int y)
+{
+  using byte = typename std::conditional<std::is_const<T>::value, const uint8_t, uint8_t>::type;
+  return reinterpret_cast<T*>(reinterpret_cast<byte*>(pixels) + static_cast<long>(y) * stride);
+}
+
+}  // namespace
+
+namespace detail {
+
+void blit_over_row_scalar(uint32_t *dst, const uint32_t *src, int width)
+{
+  for (int i = 0; i < width; ++i) {
+    uint32_t s = src[i];
+    uint32_t alpha = s >> 24;
+
+    if (alpha == 0xff) {
+      dst[i] = s;
+      continue;
+    }
+
+    if (s == 0) {
+      continue;
+    }
+
+    uint32_t d = dst[i];
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      uint32_t channel = ((s >> shift) & 0xff) + mul_div255((d >> shift) & 0xff, 0xff - alpha);
+      result |= std::min(channel, 0xffu) << shift;
+    }
+    dst[i] = result;
+  }
+}
+
+#ifdef BLIT_X86
+
+__attribute__((target("sse2")))
+static inline __m128i blend_half_sse2(__m128i s, __m128i d)
+{
+  const __m128i ff = _mm_set1_epi16(0xff);
+  const __m128i round = _mm_set1_epi16(0x80);
+
+  __m128i alpha = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+
+  __m128i t = _mm_mullo_epi16(d, _mm_sub_epi16(ff, alpha));
+  t = _mm_add_epi16(t, round);
+  return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+void blit_over_row_sse2(uint32_t *dst, const uint32_t *src, int width)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+  int i = 0;
+  for (; i + 4 <= width; i += 4) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+    // Opaque and fully transparent runs are the common case for toplevels
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), alpha_mask)) == 0xffff) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+      continue;
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff) {
+      continue;
+    }
+
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+    __m128i lo = blend_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+    __m128i hi = blend_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+
+    __m128i result = _mm_adds_epu8(_mm_packus_epi16(lo, hi), s);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+  }
+
+  blit_over_row_scalar(dst + i, src + i, width - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i blend_half_avx2(__m256i s, __m256i d)
+{
+  const __m256i ff = _mm256_set1_epi16(0xff);
+  const __m256i round = _mm256_set1_epi16(0x80);
+
+  __m256i alpha = _mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+
+  __m256i t = _mm256_mullo_epi16(d, _mm256_sub_epi16(ff, alpha));
+  t = _mm256_add_epi16(t, round);
+  return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+void blit_over_row_avx2(uint32_t *dst, const uint32_t *src, int width)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(0xff000000));
+
+  int i = 0;
+  for (; i + 8 <= width; i += 8) {
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+
+    __m256i alpha = _mm256_and_si256(s, alpha_mask);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alpha_mask)) == -1) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+      continue;
+    }
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1) {
+      continue;
+    }
+
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+
+    // Unpacking and packing both stay within 128 bit lanes, so pixel order holds
+    __m256i lo = blend_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+    __m256i hi = blend_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+
+    __m256i result = _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), s);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+  }
+
+  blit_over_row_sse2(dst + i, src + i, width - i);
+}
+
+#else
+
+void blit_over_row_sse2(uint32_t *dst, const uint32_t *src, int width)
+{
+  blit_over_row_scalar(dst, src, width);
+}
+
+void blit_over_row_avx2(uint32_t *dst, const uint32_t *src, int width)
+{
+  blit_over_row_scalar(dst, src, width);
+}
+
+#endif
+
+}  // namespace detail
+
+void blit_copy(uint32_t *dst, int dst_stride, const uint32_t *src, int src_stride,
+  int width, int height)
+{
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  // libc already picks the widest copy the CPU has
+  size_t row_size = static_cast<size_t>(width) * sizeof(uint32_t);
+  if (dst_stride == src_stride && row_size == static_cast<size_t>(dst_stride)) {
+    memcpy(dst, src, row_size * height);
+    return;
+  }
+
+  for (int y = 0; y < height; ++y) {
+    memcpy(row(dst, dst_stride, y), row(src, src_stride, y), row_size);
+  }
+}
+
+void blit_over(uint32_t *dst, int dst_stride, const uint32_t *src, int src_stride,
+  int width, int height)
+{
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  auto over_row = active_kernels().over_row;
+  for (int y = 0; y < height; ++y) {
+    over_row(row(dst, dst_stride, y), row(src, src_stride, y), width);
+  }
+}
+
+void blit_fill(uint32_t *dst, int dst_stride, uint32_t color, int width, int height)
+{
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  for (int y = 0; y < height; ++y) {
+    std::fill_n(row(dst, dst_stride, y), width, color);
+  }
+}
+
+const char* blit_kernels()
+{
+  return active_kernels().name;
+}
+
+}  // namespace lumin
@@ -11,7 +11,6 @@ namespace lumin {
 Cursor::~Cursor()
 {
   wlr_cursor_destroy(cursor_);
-  wlr_xcursor_manager_destroy(cursor_manager_);
 }
 
 Cursor::Cursor()
@@ -29,18 +28,16 @@ Cursor::Cursor()
 {
 }
 
-Cursor::Cursor(wlr_output_layout *layout, Seat *seat)
+Cursor::Cursor(wlr_output_layout *layout, Seat *seat, wlr_xcursor_manager *cursor_manager)
   : Cursor::Cursor()
 {
   layout_ = layout;
   seat_ = seat;
+  cursor_manager_ = cursor_manager;
 
   cursor_ = wlr_cursor_create();
   wlr_cursor_attach_output_layout(cursor_, layout_);
 
-  cursor_manager_ = wlr_xcursor_manager_create(NULL, 24);
-  wlr_xcursor_manager_load(cursor_manager_, 1);
-
   cursor_motion.notify = cursor_motion_notify;
   wl_signal_add(&cursor_->events.motion, &cursor_motion);
 
@@ -59,22 +56,35 @@ Cursor::Cursor(wlr_output_layout *layout, Seat *seat)
 
 void Cursor::set_image(const std::string& name)
 {
+  if (image_ == name) {
+    return;
+  }
+
+  image_ = name;
   wlr_xcursor_manager_set_cursor_image(cursor_manager_, name.c_str(), cursor_);
 }
 
-int Cursor::x() const
+double Cursor::x() const
 {
   return cursor_->x;
 }
 
-int Cursor::y() const
+double Cursor::y() const
 {
   return cursor_->y;
 }
 
-void Cursor::load_scale(int scale)
+void Cursor::load_scale(float scale)
 {
+  // Outputs changed, so new or rescaled outputs need the image set again
+  image_.clear();
+
+  if (scales_.count(scale) > 0) {
+    return;
+  }
+
   wlr_xcursor_manager_load(cursor_manager_, scale);
+  scales_.insert(scale);
 }
 
 void Cursor::warp(int x, int y)
@@ -85,6 +95,7 @@ void Cursor::warp(int x, int y)
 
 void Cursor::set_surface(wlr_surface *surface, int hotspot_x, int hotspot_y)
 {
+  image_.clear();
   wlr_cursor_set_surface(cursor_, surface, hotspot_x, hotspot_y);
 }
 
@@ -1,7 +1,12 @@
 #include "display_config.h"
 
+#include <spdlog/spdlog.h>
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
 #include "idisplay_config.h"
 #include "output.h"
 #include "ios.h"
@@ -10,90 +15,144 @@ namespace lumin {
 
 DisplayConfig::DisplayConfig(const std::shared_ptr<IOS>& os)
   : os_(os)
+  , watch_(-1)
+{
+  const char *home = getenv("HOME");
+  std::stringstream configFilePathStream;
+  configFilePathStream << home << "/.config/monitors";
+  config_path_ = configFilePathStream.str();
+
+  profiles_ = load();
+  if (profiles_ == nullptr) {
+    profiles_ = std::make_shared<const Profiles>();
+  }
+
+  watch_ = os_->watch_file(config_path_, [this]() { reload(); });
+}
+
+DisplayConfig::~DisplayConfig()
+{
+  if (watch_ != -1) {
+    os_->unwatch_file(watch_);
+  }
+}
+
+// Gives null when the file can't be parsed
+std::shared_ptr<const DisplayConfig::Profiles> DisplayConfig::load() const
 {
+  auto profiles = std::make_shared<Profiles>();
+
+  if (os_->file_exists(config_path_)) {
+    auto configFileData = os_->open_file(config_path_);
+
+    try {
+      auto document = YAML::Load(configFileData);
+
+      for (auto node : document) {
+        std::vector<std::string> names;
+        Layout layout;
+
+        for (auto monitor : node) {
+          OutputConfig config = {
+            .scale = monitor["scale"].as<float>(),
+            .primary = monitor["primary"].as<bool>(),
+            .enabled = monitor["enabled"].as<bool>(),
+            .x = monitor["x"].as<int>(),
+            .y = monitor["y"].as<int>(),
+            .mode = OUTPUT_MODE_PREFERRED,
+            .width = 0,
+            .height = 0,
+            .refresh = 0,
+            .mirror = monitor["mirror"].as<std::string>("")
+          };
+
+          if (monitor["width"] && monitor["height"]) {
+            config.mode = OUTPUT_MODE_EXPLICIT;
+            config.width = monitor["width"].as<int>();
+            config.height = monitor["height"].as<int>();
+            config.refresh = std::lround(monitor["refresh"].as<double>(0) * 1000);
+          } else if (monitor["mode"].as<std::string>("") == "highest_refresh") {
+            config.mode = OUTPUT_MODE_HIGHEST_REFRESH;
+          }
+          auto name = monitor["name"].as<std::string>();
+          layout[name] = config;
+          names.push_back(name);
+        }
+
+        std::sort(names.begin(), names.end());
+
+        // The first profile for a set of outputs wins
+        profiles->emplace(names, layout);
+      }
+    } catch (const YAML::Exception& e) {
+      spdlog::error("Failed to parse {}: {}", config_path_, e.what());
+      return nullptr;
+    }
+  }
+
+  return profiles;
+}
+
+// Runs on the watcher thread. A file that no longer parses keeps the
+// profiles that were there before.
+void DisplayConfig::reload()
+{
+  auto profiles = load();
+  if (profiles == nullptr) {
+    return;
+  }
 
+  std::lock_guard<std::mutex> lock(profiles_mutex_);
+  profiles_ = profiles;
 }
 
 std::map<std::string, OutputConfig> DisplayConfig::find_layout(
   const std::vector<std::shared_ptr<IOutput>>& outputs)
 {
-  std::vector<std::shared_ptr<IOutput>> connected_outputs;
-  std::copy_if(outputs.begin(), outputs.end(),
-    std::back_inserter(connected_outputs), [](auto &output) {
-    return output->connected();
-  });
-
+  std::vector<std::string> connected_ids;
   std::map<std::string, OutputConfig> default_layout;
 
   bool primary = true;
   bool x = 0;
-  for (auto output : connected_outputs) {
+  for (auto &output : outputs) {
+    if (!output->connected()) {
+      continue;
+    }
+
     OutputConfig config = {
-      .scale = 1,
+      .scale = 1.0f,
       .primary = primary,
       .enabled = true,
       .x = x,
       .y = 0,
+      .mode = OUTPUT_MODE_PREFERRED,
+      .width = 0,
+      .height = 0,
+      .refresh = 0,
+      .mirror = ""
     };
     auto name = output->id();
     default_layout[name] = config;
+    connected_ids.push_back(name);
     primary = false;
     x += output->width();
   }
 
-  const char *home = getenv("HOME");
-  std::stringstream configFilePathStream;
-  configFilePathStream << home << "/.config/monitors";
-  std::string configFilePath = configFilePathStream.str();
-
-  bool configFileExists = os_->file_exists(configFilePath);
-
-  if (!configFileExists) {
-    return default_layout;
+  std::shared_ptr<const Profiles> profiles;
+  {
+    std::lock_guard<std::mutex> lock(profiles_mutex_);
+    profiles = profiles_;
   }
 
-  auto configFileData = os_->open_file(configFilePath);
-  auto document = YAML::Load(configFileData);
-
-  for (auto node : document) {
-    std::map<std::string, OutputConfig> layout;
+  std::sort(connected_ids.begin(), connected_ids.end());
 
-    auto monitor_count = node.size();
-    if (monitor_count != connected_outputs.size()) {
-      continue;
-    }
-
-    bool not_found = false;
-    for (auto monitor : node) {
-      auto name = monitor["name"].as<std::string>();
-      auto condition = [name](auto &el) { return el->id().compare(name) == 0; };
-      auto result = std::find_if(connected_outputs.begin(), connected_outputs.end(), condition);
-      if (result == connected_outputs.end()) {
-        not_found = true;
-        break;
-      }
-    }
+  auto result = profiles->find(connected_ids);
 
-    if (not_found){
-      continue;
-    }
-
-    for (auto monitor : node) {
-      OutputConfig config = {
-        .scale = monitor["scale"].as<int>(),
-        .primary = monitor["primary"].as<bool>(),
-        .enabled = monitor["enabled"].as<bool>(),
-        .x = monitor["x"].as<int>(),
-        .y = monitor["y"].as<int>()
-      };
-      auto name = monitor["name"].as<std::string>();
-      layout[name] = config;
-    }
-
-    return layout;
+  if (result == profiles->end()) {
+    return default_layout;
   }
 
-  return default_layout;
+  return result->second;
 }
 
 }  // namespace lumin
@@ -0,0 +1,96 @@
+#include "draw_list.h"
+
+#include <algorithm>
+
+namespace lumin {
+
+DrawList::DrawList(int width, int height)
+  : width_(width)
+  , height_(height)
+{
+
+}
+
+void DrawList::add(const DrawItem& item)
+{
+  if (item.texture == nullptr || item.width <= 0 || item.height <= 0) {
+    return;
+  }
+
+  // Surfaces hanging off the edge of the layout never reach this output
+  bool outside = item.x >= width_ || item.y >= height_ ||
+    item.x + item.width <= 0 || item.y + item.height <= 0;
+  if (outside) {
+    return;
+  }
+
+  items_.push_back(item);
+}
+
+void DrawList::append(const DrawList& draw_list)
+{
+  items_.insert(items_.end(), draw_list.items_.begin(), draw_list.items_.end());
+}
+
+const std::vector<DrawItem>& DrawList::items() const
+{
+  return items_;
+}
+
+bool DrawList::empty() const
+{
+  return items_.empty();
+}
+
+static bool contains(const DrawItem& item, const DrawRect& rect)
+{
+  return item.x <= rect.x1 && item.y <= rect.y1 &&
+    item.x + item.width >= rect.x2 && item.y + item.height >= rect.y2;
+}
+
+// Clips every item against every damage rect, dropping whatever an opaque
+// item above it hides. The calls come out item by item so each texture is
+// drawn in one run, which keeps paint order since the rects never overlap.
+std::vector<DrawCall> DrawList::batch(const std::vector<DrawRect>& damage) const
+{
+  std::vector<size_t> bottom(damage.size(), 0);
+  for (size_t r = 0; r < damage.size(); ++r) {
+    for (size_t i = items_.size(); i-- > 0;) {
+      if (items_[i].opaque && contains(items_[i], damage[r])) {
+        bottom[r] = i;
+        break;
+      }
+    }
+  }
+
+  std::vector<DrawCall> calls;
+  for (size_t i = 0; i < items_.size(); ++i) {
+    auto &item = items_[i];
+
+    for (size_t r = 0; r < damage.size(); ++r) {
+      if (i < bottom[r]) {
+        continue;
+      }
+
+      DrawRect clip = {
+        .x1 = std::max(item.x, damage[r].x1),
+        .y1 = std::max(item.y, damage[r].y1),
+        .x2 = std::min(item.x + item.width, damage[r].x2),
+        .y2 = std::min(item.y + item.height, damage[r].y2)
+      };
+      if (clip.x1 >= clip.x2 || clip.y1 >= clip.y2) {
+        continue;
+      }
+
+      DrawCall call = {
+        .item = &item,
+        .clip = clip
+      };
+      calls.push_back(call);
+    }
+  }
+
+  return calls;
+}
+
+}  // namespace lumin
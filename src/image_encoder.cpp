@@ -0,0 +1,197 @@
+#include "image_encoder.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+
+namespace lumin {
+
+const uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+const uint8_t PNG_COLOR_TYPE_RGB = 2;
+const uint8_t PNG_FILTER_SUB = 1;
+const int PNG_COMPRESSION_LEVEL = 6;
+
+const uint8_t QOI_OP_INDEX = 0x00;
+const uint8_t QOI_OP_DIFF = 0x40;
+const uint8_t QOI_OP_LUMA = 0x80;
+const uint8_t QOI_OP_RUN = 0xc0;
+const uint8_t QOI_OP_RGB = 0xfe;
+const int QOI_MAX_RUN = 62;
+const uint8_t QOI_END[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+struct qoi_pixel {
+  uint8_t r, g, b, a;
+
+  bool operator==(const qoi_pixel& other) const {
+    return r == other.r && g == other.g && b == other.b && a == other.a;
+  }
+};
+
+static void append_u32(std::vector<uint8_t> *data, uint32_t value)
+{
+  data->push_back(value >> 24);
+  data->push_back(value >> 16);
+  data->push_back(value >> 8);
+  data->push_back(value);
+}
+
+static void append_png_chunk(std::vector<uint8_t> *data, const char *type,
+  const uint8_t *payload, size_t size)
+{
+  append_u32(data, size);
+
+  size_t start = data->size();
+  data->insert(data->end(), type, type + 4);
+  data->insert(data->end(), payload, payload + size);
+
+  append_u32(data, crc32(0, data->data() + start, size + 4));
+}
+
+ImageFormat image_format_from_path(const std::string& path)
+{
+  std::string extension = ".qoi";
+  if (path.size() >= extension.size() &&
+    path.compare(path.size() - extension.size(), extension.size(), extension) == 0) {
+    return IMAGE_FORMAT_QOI;
+  }
+  return IMAGE_FORMAT_PNG;
+}
+
+// Every row goes through the Sub filter, which turns the flat areas most
+// of a screen is made of into zeros for deflate
+bool encode_png(const CapturedFrame& frame, std::vector<uint8_t> *data)
+{
+  size_t row_size = 1 + frame.width * 3;
+  std::vector<uint8_t> scanlines(row_size * frame.height);
+
+  for (int y = 0; y < frame.height; ++y) {
+    const uint8_t *pixel = frame.row(y);
+    uint8_t *line = scanlines.data() + y * row_size;
+    *line++ = PNG_FILTER_SUB;
+
+    uint8_t left[3] = { 0, 0, 0 };
+    for (int x = 0; x < frame.width; ++x, pixel += 4) {
+      uint8_t rgb[3] = { pixel[2], pixel[1], pixel[0] };
+      for (int channel = 0; channel < 3; ++channel) {
+        *line++ = rgb[channel] - left[channel];
+        left[channel] = rgb[channel];
+      }
+    }
+  }
+
+  uLongf compressed_size = compressBound(scanlines.size());
+  std::vector<uint8_t> compressed(compressed_size);
+  int result = compress2(compressed.data(), &compressed_size, scanlines.data(),
+    scanlines.size(), PNG_COMPRESSION_LEVEL);
+
+  if (result != Z_OK) {
+    return false;
+  }
+
+  std::vector<uint8_t> header;
+  append_u32(&header, frame.width);
+  append_u32(&header, frame.height);
+  header.push_back(8);
+  header.push_back(PNG_COLOR_TYPE_RGB);
+  header.push_back(0);
+  header.push_back(0);
+  header.push_back(0);
+
+  data->clear();
+  data->reserve(compressed_size + 64);
+  data->insert(data->end(), std::begin(PNG_SIGNATURE), std::end(PNG_SIGNATURE));
+  append_png_chunk(data, "IHDR", header.data(), header.size());
+  append_png_chunk(data, "IDAT", compressed.data(), compressed_size);
+  append_png_chunk(data, "IEND", nullptr, 0);
+  return true;
+}
+
+// The Quite OK Image format, a single pass with no tables to build, which
+// encodes several times faster than deflate
+void encode_qoi(const CapturedFrame& frame, std::vector<uint8_t> *data)
+{
+  data->clear();
+  data->reserve(frame.width * frame.height + 22);
+
+  data->insert(data->end(), { 'q', 'o', 'i', 'f' });
+  append_u32(data, frame.width);
+  append_u32(data, frame.height);
+  data->push_back(3);
+  data->push_back(0);
+
+  // The index starts out transparent, so it can't match an opaque pixel
+  // until one has been stored
+  qoi_pixel index[64] = {};
+  qoi_pixel previous = { .r = 0, .g = 0, .b = 0, .a = 255 };
+  int run = 0;
+
+  auto hash = [](const qoi_pixel& pixel) {
+    return (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+  };
+
+  for (int y = 0; y < frame.height; ++y) {
+    const uint8_t *row = frame.row(y);
+    for (int x = 0; x < frame.width; ++x, row += 4) {
+      qoi_pixel pixel = { .r = row[2], .g = row[1], .b = row[0], .a = 255 };
+
+      if (pixel == previous) {
+        if (++run == QOI_MAX_RUN) {
+          data->push_back(QOI_OP_RUN | (run - 1));
+          run = 0;
+        }
+        continue;
+      }
+
+      if (run > 0) {
+        data->push_back(QOI_OP_RUN | (run - 1));
+        run = 0;
+      }
+
+      int position = hash(pixel);
+      auto &indexed = index[position];
+      if (indexed == pixel) {
+        data->push_back(QOI_OP_INDEX | position);
+        previous = pixel;
+        continue;
+      }
+      indexed = pixel;
+
+      int8_t dr = pixel.r - previous.r;
+      int8_t dg = pixel.g - previous.g;
+      int8_t db = pixel.b - previous.b;
+      int8_t dr_dg = dr - dg;
+      int8_t db_dg = db - dg;
+
+      if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+        data->push_back(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+      } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+        data->push_back(QOI_OP_LUMA | (dg + 32));
+        data->push_back((dr_dg + 8) << 4 | (db_dg + 8));
+      } else {
+        data->insert(data->end(), { QOI_OP_RGB, pixel.r, pixel.g, pixel.b });
+      }
+
+      previous = pixel;
+    }
+  }
+
+  if (run > 0) {
+    data->push_back(QOI_OP_RUN | (run - 1));
+  }
+
+  data->insert(data->end(), std::begin(QOI_END), std::end(QOI_END));
+}
+
+bool encode_image(const CapturedFrame& frame, ImageFormat format, std::vector<uint8_t> *data)
+{
+  switch (format) {
+    case IMAGE_FORMAT_QOI:
+      encode_qoi(frame, data);
+      return true;
+    case IMAGE_FORMAT_PNG:
+      return encode_png(frame, data);
+  }
+  return false;
+}
+
+}  // namespace lumin
@@ -14,10 +14,24 @@ KeyBinding::KeyBinding(int key_code, int modifiers, int state)
 
 }
 
-bool KeyBinding::matches(int modifiers, int key_code, int state)
+bool KeyBinding::matches(int modifiers, int key_code, int state) const
 {
   bool match = (modifiers_ == modifiers && key_code_ == key_code && state_ == state);
   return match;
 }
 
+bool KeyBinding::operator==(const KeyBinding& other) const
+{
+  return matches(other.modifiers_, other.key_code_, other.state_);
+}
+
+size_t KeyBindingHash::operator()(const KeyBinding& binding) const
+{
+  // modifiers fit in 8 bits and state in 1, leaving the rest for the key
+  size_t hash = static_cast<uint32_t>(binding.key_code_);
+  hash = (hash << 8) | (binding.modifiers_ & 0xff);
+  hash = (hash << 1) | (binding.state_ & 0x1);
+  return hash;
+}
+
 }  // namespace lumin
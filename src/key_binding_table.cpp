@@ -0,0 +1,174 @@
+#include "key_binding_table.h"
+
+#include <linux/input-event-codes.h>
+#include <wlroots.h>
+#include <xkbcommon/xkbcommon.h>
+
+namespace lumin {
+
+// Modifiers are reported as keys of their own, pressed again between the
+// steps of a chord when the user lets go of them in between
+static bool is_modifier_key(uint32_t key_code)
+{
+  switch (key_code) {
+    case KEY_LEFTCTRL:
+    case KEY_RIGHTCTRL:
+    case KEY_LEFTSHIFT:
+    case KEY_RIGHTSHIFT:
+    case KEY_LEFTALT:
+    case KEY_RIGHTALT:
+    case KEY_LEFTMETA:
+    case KEY_RIGHTMETA:
+      return true;
+    default:
+      return false;
+  }
+}
+
+KeyBindingTable::KeyBindingTable()
+  : chords_({ .id = -1, .children = {} })
+  , chord_state_(&chords_)
+  , next_id_(0)
+  , size_(0)
+{
+
+}
+
+int KeyBindingTable::insert(BindingMap *bindings, const KeyBinding& binding)
+{
+  auto result = bindings->find(binding);
+  if (result != bindings->end()) {
+    return result->second;
+  }
+
+  int id = next_id_++;
+  bindings->insert(std::make_pair(binding, id));
+  size_++;
+
+  return id;
+}
+
+int KeyBindingTable::add(int key_code, int modifiers, int state)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return insert(&key_codes_, KeyBinding(key_code, modifiers, state));
+}
+
+int KeyBindingTable::add_keysym(int keysym, int modifiers, int state)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return insert(&keysyms_, KeyBinding(xkb_keysym_to_lower(keysym), modifiers, state));
+}
+
+std::vector<int> KeyBindingTable::add_all(const std::vector<KeyBinding>& bindings)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  key_codes_.reserve(key_codes_.size() + bindings.size());
+
+  std::vector<int> ids;
+  ids.reserve(bindings.size());
+  for (auto &binding : bindings) {
+    ids.push_back(insert(&key_codes_, binding));
+  }
+  return ids;
+}
+
+int KeyBindingTable::add_chord(const std::vector<KeyBinding>& sequence)
+{
+  if (sequence.empty()) {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  ChordNode *node = &chords_;
+  for (auto &binding : sequence) {
+    auto &child = node->children[binding];
+    if (!child) {
+      child = std::make_unique<ChordNode>();
+      child->id = -1;
+    }
+    node = child.get();
+  }
+
+  if (node->id < 0) {
+    node->id = next_id_++;
+    size_++;
+  }
+
+  return node->id;
+}
+
+bool KeyBindingTable::dispatch_chord(uint32_t key_code, uint32_t modifiers, int state, int *id)
+{
+  // Releases of keys that advanced a chord never reach the client
+  if (state == WLR_KEY_RELEASED) {
+    return chord_keys_.erase(key_code) > 0;
+  }
+
+  auto result = chord_state_->children.find(KeyBinding(key_code, modifiers, state));
+  if (result == chord_state_->children.end()) {
+    if (!is_modifier_key(key_code)) {
+      chord_state_ = &chords_;
+    }
+    return false;
+  }
+
+  ChordNode *node = result->second.get();
+  chord_keys_.insert(key_code);
+
+  if (node->children.empty()) {
+    chord_state_ = &chords_;
+    *id = node->id;
+    return true;
+  }
+
+  chord_state_ = node;
+  return true;
+}
+
+bool KeyBindingTable::dispatch(uint32_t key_code, uint32_t keysym,
+  uint32_t modifiers, int state, int *id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  *id = -1;
+
+  if (chord_state_ != &chords_ || state == WLR_KEY_RELEASED) {
+    if (dispatch_chord(key_code, modifiers, state, id)) {
+      return true;
+    }
+  }
+
+  auto key_code_result = key_codes_.find(KeyBinding(key_code, modifiers, state));
+  if (key_code_result != key_codes_.end()) {
+    *id = key_code_result->second;
+    return true;
+  }
+
+  if (keysym != XKB_KEY_NoSymbol) {
+    // Keysyms come from the key's first level, so Shift is only in the
+    // modifiers. Some keymaps put capitals there, hence the lowering.
+    auto keysym_result = keysyms_.find(
+      KeyBinding(xkb_keysym_to_lower(keysym), modifiers, state));
+    if (keysym_result != keysyms_.end()) {
+      *id = keysym_result->second;
+      return true;
+    }
+  }
+
+  if (chords_.children.empty()) {
+    return false;
+  }
+
+  return dispatch_chord(key_code, modifiers, state, id);
+}
+
+size_t KeyBindingTable::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+}  // namespace lumin
@@ -1,15 +1,37 @@
 #include "keyboard.h"
 
+#include <spdlog/spdlog.h>
 #include <wlroots.h>
 
+#include "keymap_cache.h"
 #include "seat.h"
 #include "server.h"
 
 namespace lumin {
 
-Keyboard::Keyboard(wlr_input_device *device, Seat* seat)
+// The keysym on the key's first level, so that Shift+1 gives 1 rather than
+// exclam. Shift is matched through the modifiers instead.
+static xkb_keysym_t unshifted_keysym(xkb_state *state, xkb_keycode_t keycode)
+{
+  xkb_layout_index_t layout = xkb_state_key_get_layout(state, keycode);
+  if (layout == XKB_LAYOUT_INVALID) {
+    return XKB_KEY_NoSymbol;
+  }
+
+  const xkb_keysym_t *syms;
+  int count = xkb_keymap_key_get_syms_by_level(xkb_state_get_keymap(state), keycode,
+    layout, 0, &syms);
+  if (count != 1) {
+    return XKB_KEY_NoSymbol;
+  }
+
+  return syms[0];
+}
+
+Keyboard::Keyboard(wlr_input_device *device, Seat* seat, KeymapCache *keymap_cache)
   : device_(device)
   , seat_(seat)
+  , keymap_cache_(keymap_cache)
 {
   /* Here we set up listeners for keyboard events. */
   modifiers.notify = keyboard_modifiers_notify;
@@ -23,12 +45,14 @@ void Keyboard::setup()
 {
   xkb_rule_names rules;
   memset(&rules, 0, sizeof(xkb_rule_names));
-  xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-  xkb_keymap *keymap = xkb_map_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+  xkb_keymap *keymap = keymap_cache_->keymap(rules);
+
+  if (keymap == nullptr) {
+    spdlog::error("No keymap for keyboard {}", device_->name);
+    return;
+  }
 
   wlr_keyboard_set_keymap(device_->keyboard, keymap);
-  xkb_keymap_unref(keymap);
-  xkb_context_unref(context);
 
   wlr_keyboard_set_repeat_info(device_->keyboard, 25, 200);
   seat_->set_keyboard(device_);
@@ -49,8 +73,12 @@ void Keyboard::keyboard_key_notify(wl_listener *listener, void *data)
 
   keyboard->seat_->set_keyboard(keyboard->device_);
 
+  // libinput key codes are offset by 8 from xkb key codes
+  xkb_keysym_t keysym = unshifted_keysym(keyboard->device_->keyboard->xkb_state,
+    event->keycode + 8);
+
   uint32_t modifiers = wlr_keyboard_get_modifiers(keyboard->device_->keyboard);
-  keyboard->on_key.emit(event->time_msec, event->keycode, modifiers, event->state);
+  keyboard->on_key.emit(event->time_msec, event->keycode, keysym, modifiers, event->state);
 }
 
 }  // namespace lumin
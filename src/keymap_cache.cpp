@@ -0,0 +1,74 @@
+#include "keymap_cache.h"
+
+#include <spdlog/spdlog.h>
+#include <xkbcommon/xkbcommon.h>
+
+#include <sstream>
+
+namespace lumin {
+
+static std::string keymap_key(const xkb_rule_names& names)
+{
+  auto name = [](const char *value) { return value == nullptr ? "" : value; };
+
+  std::stringstream key;
+  key << name(names.rules) << ":"
+      << name(names.model) << ":"
+      << name(names.layout) << ":"
+      << name(names.variant) << ":"
+      << name(names.options);
+  return key.str();
+}
+
+KeymapCache::~KeymapCache()
+{
+  for (auto &keymap : keymaps_) {
+    xkb_keymap_unref(keymap.second);
+  }
+
+  if (context_ != nullptr) {
+    xkb_context_unref(context_);
+  }
+}
+
+KeymapCache::KeymapCache()
+  : context_(nullptr)
+{
+
+}
+
+xkb_keymap* KeymapCache::keymap(const xkb_rule_names& names)
+{
+  auto key = keymap_key(names);
+
+  auto result = keymaps_.find(key);
+  if (result != keymaps_.end()) {
+    return result->second;
+  }
+
+  if (context_ == nullptr) {
+    context_ = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+
+    if (context_ == nullptr) {
+      spdlog::error("Failed to create xkb context");
+      return nullptr;
+    }
+  }
+
+  xkb_keymap *keymap = xkb_keymap_new_from_names(context_, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+
+  if (keymap == nullptr) {
+    spdlog::error("Failed to compile keymap {}", key);
+    return nullptr;
+  }
+
+  keymaps_[key] = keymap;
+  return keymap;
+}
+
+size_t KeymapCache::size() const
+{
+  return keymaps_.size();
+}
+
+}  // namespace lumin
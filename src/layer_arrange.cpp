@@ -0,0 +1,74 @@
+#include "layer_arrange.h"
+
+#include <wlroots.h>
+
+namespace lumin {
+
+const uint32_t ANCHOR_TOP = ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP;
+const uint32_t ANCHOR_BOTTOM = ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM;
+const uint32_t ANCHOR_LEFT = ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT;
+const uint32_t ANCHOR_RIGHT = ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT;
+
+const uint32_t ANCHOR_HORIZONTAL = ANCHOR_LEFT | ANCHOR_RIGHT;
+const uint32_t ANCHOR_VERTICAL = ANCHOR_TOP | ANCHOR_BOTTOM;
+
+void arrange_layer_box(const LayerState& state, const wlr_box *bounds, wlr_box *box)
+{
+  box->width = state.width;
+  box->height = state.height;
+
+  // Surfaces anchored to both opposite edges, or neither, are centered
+  uint32_t horizontal = state.anchor & ANCHOR_HORIZONTAL;
+  if (horizontal == ANCHOR_LEFT) {
+    box->x = bounds->x + state.margin_left;
+  } else if (horizontal == ANCHOR_RIGHT) {
+    box->x = bounds->x + bounds->width - box->width - state.margin_right;
+  } else {
+    box->x = bounds->x + (bounds->width - box->width) / 2;
+  }
+
+  uint32_t vertical = state.anchor & ANCHOR_VERTICAL;
+  if (vertical == ANCHOR_TOP) {
+    box->y = bounds->y + state.margin_top;
+  } else if (vertical == ANCHOR_BOTTOM) {
+    box->y = bounds->y + bounds->height - box->height - state.margin_bottom;
+  } else {
+    box->y = bounds->y + (bounds->height - box->height) / 2;
+  }
+
+  // A zero size fills the space between both anchors, less the margins
+  if (box->width == 0) {
+    box->x = bounds->x + state.margin_left;
+    box->width = bounds->width - state.margin_left - state.margin_right;
+  }
+
+  if (box->height == 0) {
+    box->y = bounds->y + state.margin_top;
+    box->height = bounds->height - state.margin_top - state.margin_bottom;
+  }
+}
+
+void apply_exclusive_zone(const LayerState& state, wlr_box *usable_area)
+{
+  if (state.exclusive_zone <= 0) {
+    return;
+  }
+
+  // A surface claims an edge when anchored to it alone or to it and both
+  // of its neighbours, like a panel stretched across the top
+  if (state.anchor == ANCHOR_TOP || state.anchor == (ANCHOR_TOP | ANCHOR_HORIZONTAL)) {
+    int size = state.exclusive_zone + state.margin_top;
+    usable_area->y += size;
+    usable_area->height -= size;
+  } else if (state.anchor == ANCHOR_BOTTOM || state.anchor == (ANCHOR_BOTTOM | ANCHOR_HORIZONTAL)) {
+    usable_area->height -= state.exclusive_zone + state.margin_bottom;
+  } else if (state.anchor == ANCHOR_LEFT || state.anchor == (ANCHOR_LEFT | ANCHOR_VERTICAL)) {
+    int size = state.exclusive_zone + state.margin_left;
+    usable_area->x += size;
+    usable_area->width -= size;
+  } else if (state.anchor == ANCHOR_RIGHT || state.anchor == (ANCHOR_RIGHT | ANCHOR_VERTICAL)) {
+    usable_area->width -= state.exclusive_zone + state.margin_right;
+  }
+}
+
+}  // namespace lumin
@@ -0,0 +1,102 @@
+#include "layer_cache.h"
+
+#include <wlroots.h>
+
+namespace lumin {
+
+static bool same_items(const std::vector<DrawItem>& a, const std::vector<DrawItem>& b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.size(); ++i) {
+    bool same = a[i].surface == b[i].surface &&
+      a[i].texture == b[i].texture &&
+      a[i].x == b[i].x &&
+      a[i].y == b[i].y &&
+      a[i].width == b[i].width &&
+      a[i].height == b[i].height &&
+      a[i].transform == b[i].transform &&
+      a[i].alpha == b[i].alpha;
+    if (!same) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+LayerCache::~LayerCache()
+{
+
+}
+
+LayerCache::LayerCache()
+  : dirty_(true)
+{
+
+}
+
+void LayerCache::invalidate()
+{
+  dirty_ = true;
+}
+
+// Commits mark the cache dirty, and comparing the items catches surfaces
+// that moved, mapped or unmapped without committing
+bool LayerCache::valid(const DrawList& draw_list, int width, int height) const
+{
+  return !dirty_ && target_.texture() != nullptr &&
+    width == target_.width() && height == target_.height() &&
+    same_items(items_, draw_list.items());
+}
+
+wlr_texture* LayerCache::texture() const
+{
+  return target_.texture();
+}
+
+// Must be called with the output's render buffer attached, outside of
+// wlr_renderer_begin and wlr_renderer_end
+bool LayerCache::update(wlr_renderer *renderer, const DrawList& draw_list, int width, int height)
+{
+  if (!target_.resize(renderer, width, height)) {
+    return false;
+  }
+
+  target_.bind();
+
+  wlr_renderer_begin(renderer, width, height);
+  wlr_renderer_scissor(renderer, NULL);
+
+  float transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  wlr_renderer_clear(renderer, transparent);
+
+  float projection[9];
+  wlr_matrix_projection(projection, width, height, WL_OUTPUT_TRANSFORM_NORMAL);
+
+  for (auto &item : draw_list.items()) {
+    wlr_box box = {
+      .x = item.x,
+      .y = item.y,
+      .width = item.width,
+      .height = item.height
+    };
+
+    float matrix[9];
+    auto transform = wlr_output_transform_invert(static_cast<wl_output_transform>(item.transform));
+    wlr_matrix_project_box(matrix, &box, transform, 0, projection);
+    wlr_render_texture_with_matrix(renderer, item.texture, matrix, item.alpha);
+  }
+
+  wlr_renderer_end(renderer);
+
+  target_.unbind();
+
+  items_ = draw_list.items();
+  dirty_ = false;
+  return true;
+}
+
+}  // namespace lumin
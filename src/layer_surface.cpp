@@ -0,0 +1,191 @@
+#include "layer_surface.h"
+
+#include <spdlog/spdlog.h>
+#include <wlroots.h>
+
+#include "output.h"
+
+namespace lumin {
+
+static bool same_state(const LayerState& a, const LayerState& b)
+{
+  return a.anchor == b.anchor &&
+    a.exclusive_zone == b.exclusive_zone &&
+    a.margin_top == b.margin_top &&
+    a.margin_right == b.margin_right &&
+    a.margin_bottom == b.margin_bottom &&
+    a.margin_left == b.margin_left &&
+    a.width == b.width &&
+    a.height == b.height;
+}
+
+LayerSurface::~LayerSurface()
+{
+  wl_list_init(&map_.link);
+  wl_list_remove(&map_.link);
+
+  wl_list_init(&unmap_.link);
+  wl_list_remove(&unmap_.link);
+
+  wl_list_init(&commit_.link);
+  wl_list_remove(&commit_.link);
+
+  wl_list_init(&destroy_.link);
+  wl_list_remove(&destroy_.link);
+}
+
+LayerSurface::LayerSurface(wlr_layer_surface_v1 *layer_surface)
+  : mapped(false)
+  , deleted(false)
+  , x(0)
+  , y(0)
+  , width(0)
+  , height(0)
+  , layer_surface_(layer_surface)
+  , state_changed_(true)
+{
+  state_ = state();
+
+  map_.notify = LayerSurface::layer_surface_map_notify;
+  wl_signal_add(&layer_surface_->events.map, &map_);
+
+  unmap_.notify = LayerSurface::layer_surface_unmap_notify;
+  wl_signal_add(&layer_surface_->events.unmap, &unmap_);
+
+  commit_.notify = LayerSurface::layer_surface_commit_notify;
+  wl_signal_add(&layer_surface_->surface->events.commit, &commit_);
+
+  destroy_.notify = LayerSurface::layer_surface_destroy_notify;
+  wl_signal_add(&layer_surface_->events.destroy, &destroy_);
+}
+
+ViewLayer LayerSurface::layer() const
+{
+  return static_cast<ViewLayer>(layer_surface_->layer);
+}
+
+LayerState LayerSurface::state() const
+{
+  auto &current = layer_surface_->current;
+
+  LayerState state = {
+    .anchor = current.anchor,
+    .exclusive_zone = current.exclusive_zone,
+    .margin_top = static_cast<int>(current.margin.top),
+    .margin_right = static_cast<int>(current.margin.right),
+    .margin_bottom = static_cast<int>(current.margin.bottom),
+    .margin_left = static_cast<int>(current.margin.left),
+    .width = static_cast<int>(current.desired_width),
+    .height = static_cast<int>(current.desired_height)
+  };
+  return state;
+}
+
+Output* LayerSurface::output() const
+{
+  if (layer_surface_->output == nullptr) {
+    return nullptr;
+  }
+  return static_cast<Output*>(layer_surface_->output->data);
+}
+
+void LayerSurface::detach_output()
+{
+  layer_surface_->output = nullptr;
+}
+
+bool LayerSurface::keyboard_interactive() const
+{
+  return layer_surface_->current.keyboard_interactive;
+}
+
+bool LayerSurface::state_changed() const
+{
+  return state_changed_;
+}
+
+void LayerSurface::configure(const wlr_box *box)
+{
+  x = box->x;
+  y = box->y;
+
+  // Clients redraw on every configure, so only send one for a new size
+  if (layer_surface_->configured && width == box->width && height == box->height) {
+    return;
+  }
+
+  width = box->width;
+  height = box->height;
+  wlr_layer_surface_v1_configure(layer_surface_, width, height);
+}
+
+void LayerSurface::close()
+{
+  wlr_layer_surface_v1_close(layer_surface_);
+}
+
+wlr_surface* LayerSurface::surface() const
+{
+  return layer_surface_->surface;
+}
+
+wlr_surface* LayerSurface::surface_at(double ox, double oy, double *sx, double *sy) const
+{
+  return wlr_layer_surface_v1_surface_at(layer_surface_, ox - x, oy - y, sx, sy);
+}
+
+void LayerSurface::for_each_surface(wlr_surface_iterator_func_t iterator, void *data) const
+{
+  wlr_layer_surface_v1_for_each_surface(layer_surface_, iterator, data);
+}
+
+void LayerSurface::layer_surface_map_notify(wl_listener *listener, void *data)
+{
+  LayerSurface *surface = wl_container_of(listener, surface, map_);
+  surface->mapped = true;
+
+  if (surface->layer_surface_->output != nullptr) {
+    wlr_surface_send_enter(surface->surface(), surface->layer_surface_->output);
+  }
+
+  surface->on_map.emit(surface);
+}
+
+void LayerSurface::layer_surface_unmap_notify(wl_listener *listener, void *data)
+{
+  LayerSurface *surface = wl_container_of(listener, surface, unmap_);
+  surface->mapped = false;
+  surface->on_unmap.emit(surface);
+}
+
+void LayerSurface::layer_surface_commit_notify(wl_listener *listener, void *data)
+{
+  LayerSurface *surface = wl_container_of(listener, surface, commit_);
+
+  // Most commits are new buffers, only anchors, margins, sizes and
+  // exclusive zones need the output's layers arranged again
+  auto state = surface->state();
+  surface->state_changed_ = !same_state(state, surface->state_);
+  surface->state_ = state;
+
+  surface->on_commit.emit(surface);
+}
+
+void LayerSurface::layer_surface_destroy_notify(wl_listener *listener, void *data)
+{
+  LayerSurface *surface = wl_container_of(listener, surface, destroy_);
+
+  // The wlroots surface is gone by the time this one is purged
+  wl_list_remove(&surface->map_.link);
+  wl_list_init(&surface->map_.link);
+  wl_list_remove(&surface->unmap_.link);
+  wl_list_init(&surface->unmap_.link);
+  wl_list_remove(&surface->commit_.link);
+  wl_list_init(&surface->commit_.link);
+  wl_list_remove(&surface->destroy_.link);
+  wl_list_init(&surface->destroy_.link);
+
+  surface->on_destroy.emit(surface);
+}
+
+}  // namespace lumin
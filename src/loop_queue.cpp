@@ -0,0 +1,72 @@
+#include "loop_queue.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace lumin {
+
+LoopQueue::LoopQueue()
+  : fd_(-1)
+  , closed_(false)
+{
+
+}
+
+LoopQueue::~LoopQueue()
+{
+  if (fd_ != -1) {
+    ::close(fd_);
+  }
+}
+
+bool LoopQueue::init()
+{
+  fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  return fd_ != -1;
+}
+
+int LoopQueue::fd() const
+{
+  return fd_;
+}
+
+void LoopQueue::post(const std::function<void()>& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return;
+    }
+
+    tasks_.push_back(task);
+  }
+
+  eventfd_write(fd_, 1);
+}
+
+// Tasks may post more tasks, so they run outside the lock and anything
+// they add waits for the next wakeup
+void LoopQueue::run_pending()
+{
+  eventfd_t count;
+  eventfd_read(fd_, &count);
+
+  std::deque<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks.swap(tasks_);
+  }
+
+  for (auto &task : tasks) {
+    task();
+  }
+}
+
+void LoopQueue::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  tasks_.clear();
+}
+
+}  // namespace lumin
@@ -1,30 +1,54 @@
 #include "output.h"
+#include "draw_list.h"
+#include "layer_arrange.h"
+#include "layer_cache.h"
+#include "output_mode.h"
+#include "overview_layout.h"
+#include "software_renderer.h"
+#include "thumbnail.h"
 
 #include <spdlog/spdlog.h>
 #include <wlroots.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <iostream>
 #include <sstream>
 
 #include "cursor.h"
+#include "layer_surface.h"
 #include "view.h"
 #include "server.h"
 
 namespace lumin {
 
 const int ENTER_FRAME_REPEAT_COUNT = 5;
+const int MAX_DAMAGE_RECTS = 16;
+const int OVERVIEW_GAP = 32;
+
+// The org.os.Menu toplevel is kept as a fallback until lumin-menu is a
+// layer surface with an exclusive zone
+const int MENU_HEIGHT = 27;
 
 struct render_data {
   wlr_output *output;
-  wlr_renderer *renderer;
   View *view;
-  timespec *when;
+  double x, y;
   wlr_output_layout *layout;
-  pixman_region32_t *output_damage;
+  DrawList *draw_list;
+};
+
+struct scaled_data {
+  wlr_output *output;
+  DrawList *draw_list;
+  double x, y;
+  double scale_x, scale_y;
+  float alpha;
 };
 
 struct damage_iterator_data {
-  const View *view;
+  double x, y;
   wlr_output *output;
   wlr_output_damage *output_damage;
   wlr_output_layout *output_layout;
@@ -32,6 +56,14 @@ struct damage_iterator_data {
 
 Output::~Output()
 {
+  if (mirror_texture_ != nullptr) {
+    wlr_texture_destroy(mirror_texture_);
+  }
+
+  if (software_texture_ != nullptr) {
+    wlr_texture_destroy(software_texture_);
+  }
+
   wl_list_init(&frame_.link);
   wl_list_remove(&frame_.link);
 
@@ -41,23 +73,55 @@ Output::~Output()
 
 Output::Output()
   : deleted_(false)
+  , mode_policy_(OUTPUT_MODE_PREFERRED)
+  , mode_width_(0)
+  , mode_height_(0)
+  , mode_refresh_(0)
   , enabled_(false)
   , connected_(false)
   , primary_(false)
   , software_cursors_(false)
-  , enter_frames_left_(0) {}
+  , enter_frames_left_(0)
+  , mirror_source_(nullptr)
+  , mirror_readback_(false)
+  , mirror_y_invert_(false)
+  , mirror_texture_(nullptr)
+  , fullscreen_view_(nullptr)
+  , software_(nullptr)
+  , software_frame_valid_(false)
+  , software_texture_(nullptr)
+  , overlay_cache_(std::make_unique<LayerCache>())
+  , overview_(false)
+  , overview_hover_(nullptr)
+  , menubar_height_(0)
+  , usable_area_({
+    .x = 0,
+    .y = 0,
+    .width = 0,
+    .height = 0 }) {}
 
 Output::Output(
   struct wlr_output *output,
   wlr_renderer *renderer,
   wlr_output_damage *damage,
-  wlr_output_layout *layout)
+  wlr_output_layout *layout,
+  SoftwareRenderer *software)
   : Output()
 {
   wlr_output = output;
   renderer_ = renderer;
   damage_ = damage;
   layout_ = layout;
+  software_ = software;
+
+  // Headless outputs all share a make and model, so they go by name
+  if (wlr_output_is_headless(wlr_output)) {
+    id_ = wlr_output->name;
+  } else {
+    std::stringstream id;
+    id << wlr_output->make << " " << wlr_output->model;
+    id_ = id.str();
+  }
 
   destroy_.notify = Output::output_destroy_notify;
   wl_signal_add(&wlr_output->events.destroy, &destroy_);
@@ -95,17 +159,55 @@ void Output::set_connected(bool connected)
   }
 }
 
-void Output::configure(int scale, bool primary, bool enabled, int x, int y)
+// Gives false when the backend rejects the new state, which leaves the
+// output as it was
+bool Output::configure(float scale, bool primary, bool enabled, int x, int y)
 {
-  spdlog::debug("Configuring {} scale:{}", id(), scale);
-  set_enabled(enabled);
-  set_scale(scale);
-  set_mode();
-  commit();
+  // Only touch the state that differs so that unchanged outputs are not
+  // modeset, blanked or repainted when another output comes and goes
+  bool changed = false;
+  bool was_enabled = enabled_;
+
+  if (enabled != enabled_) {
+    set_enabled(enabled);
+    changed = true;
+  }
 
-  add_layout(x, y);
-  set_primary(primary);
-  take_whole_damage();
+  if (wlr_output->scale != scale) {
+    set_scale(scale);
+    changed = true;
+  }
+
+  if (enabled && set_mode()) {
+    changed = true;
+  }
+
+  if (changed) {
+    spdlog::debug("Configuring {} scale:{}", id(), scale);
+    if (!commit()) {
+      wlr_output_rollback(wlr_output);
+      enabled_ = was_enabled;
+      return false;
+    }
+  }
+
+  // Mirrors show the source's frame so they take no space in the layout
+  if (mirror_source_ != nullptr) {
+    primary = false;
+  } else if (update_layout(x, y)) {
+    changed = true;
+  }
+
+  if (primary != primary_) {
+    set_primary(primary);
+    changed = true;
+  }
+
+  if (changed) {
+    arrange_layers();
+    on_configure.emit(this);
+  }
+  return true;
 }
 
 bool Output::primary() const
@@ -118,28 +220,293 @@ void Output::set_primary(bool primary)
   primary_ = primary;
 }
 
-int Output::top_margin() const
+wlr_box Output::usable_area() const
+{
+  wlr_box area = {
+    .x = x() + usable_area_.x,
+    .y = y() + usable_area_.y,
+    .width = usable_area_.width,
+    .height = usable_area_.height
+  };
+  return area;
+}
+
+// Spans the menubar across the top of the output and keeps it out of the
+// usable area, a null view gives the room back
+void Output::set_menubar(View *view)
+{
+  menubar_height_ = view != nullptr ? MENU_HEIGHT : 0;
+
+  if (view != nullptr) {
+    int width, height;
+    wlr_output_effective_resolution(wlr_output, &width, &height);
+    view->move(x(), y());
+    view->resize(width, MENU_HEIGHT);
+  }
+
+  arrange_layers();
+}
+
+void Output::add_layer_surface(LayerSurface *layer_surface)
+{
+  layers_[layer_surface->layer()].push_back(layer_surface);
+  arrange_layers();
+}
+
+void Output::remove_layer_surface(LayerSurface *layer_surface)
+{
+  auto &layer = layers_[layer_surface->layer()];
+  layer.erase(std::remove(layer.begin(), layer.end(), layer_surface), layer.end());
+  arrange_layers();
+}
+
+void Output::close_layer_surfaces()
+{
+  for (auto &layer : layers_) {
+    for (auto layer_surface : layer) {
+      layer_surface->detach_output();
+      layer_surface->close();
+    }
+    layer.clear();
+  }
+}
+
+// Runs when a layer surface maps, unmaps or commits new anchors, margins,
+// sizes or zones, so that maximize and tile can read the cached result
+void Output::arrange_layers()
+{
+  wlr_box full_area = { 0, 0, 0, 0 };
+  wlr_output_effective_resolution(wlr_output, &full_area.width, &full_area.height);
+
+  wlr_box usable_area = full_area;
+  usable_area.y += menubar_height_;
+  usable_area.height -= menubar_height_;
+
+  // Exclusive surfaces claim their edges first, from the top layer down,
+  // and everything else is then placed inside what is left
+  for (bool exclusive : { true, false }) {
+    for (int layer = VIEW_LAYER_MAX - 1; layer >= 0; --layer) {
+      for (auto layer_surface : layers_[layer]) {
+        auto state = layer_surface->state();
+        if ((state.exclusive_zone > 0) != exclusive) {
+          continue;
+        }
+
+        const wlr_box *bounds = state.exclusive_zone == -1 ? &full_area : &usable_area;
+
+        wlr_box box;
+        arrange_layer_box(state, bounds, &box);
+
+        if (box.width < 0 || box.height < 0) {
+          spdlog::warn("Layer surface doesn't fit on {}", id());
+          layer_surface->close();
+          continue;
+        }
+
+        layer_surface->configure(&box);
+
+        if (layer_surface->mapped) {
+          apply_exclusive_zone(state, &usable_area);
+        }
+      }
+    }
+  }
+
+  usable_area_.x = usable_area.x;
+  usable_area_.y = usable_area.y;
+  usable_area_.width = usable_area.width;
+  usable_area_.height = usable_area.height;
+
+  take_whole_damage();
+}
+
+LayerSurface* Output::layer_surface_at(ViewLayer layer, double lx, double ly,
+  wlr_surface **surface, double *sx, double *sy) const
+{
+  double ox = lx - x();
+  double oy = ly - y();
+
+  auto &layer_surfaces = layers_[layer];
+  for (auto it = layer_surfaces.rbegin(); it != layer_surfaces.rend(); ++it) {
+    auto layer_surface = *it;
+    if (!layer_surface->mapped) {
+      continue;
+    }
+
+    auto found = layer_surface->surface_at(ox, oy, sx, sy);
+    if (found != nullptr) {
+      *surface = found;
+      return layer_surface;
+    }
+  }
+
+  return nullptr;
+}
+
+void Output::request_mode(OutputModePolicy policy, int width, int height, int refresh)
+{
+  mode_policy_ = policy;
+  mode_width_ = width;
+  mode_height_ = height;
+  mode_refresh_ = refresh;
+}
+
+OutputModeRequest Output::requested_mode() const
+{
+  OutputModeRequest request = {
+    .policy = mode_policy_,
+    .width = mode_width_,
+    .height = mode_height_,
+    .refresh = mode_refresh_
+  };
+  return request;
+}
+
+wlr_output_mode* Output::find_mode() const
 {
-  return primary_ ? View::MENU_HEIGHT : 0;
+  std::vector<wlr_output_mode*> wlr_modes;
+  std::vector<OutputMode> modes;
+
+  wlr_output_mode *wlr_mode;
+  wl_list_for_each(wlr_mode, &wlr_output->modes, link) {
+    OutputMode mode = {
+      .width = wlr_mode->width,
+      .height = wlr_mode->height,
+      .refresh = wlr_mode->refresh,
+      .preferred = wlr_mode->preferred
+    };
+    modes.push_back(mode);
+    wlr_modes.push_back(wlr_mode);
+  }
+
+  int index = select_output_mode(modes, mode_policy_, mode_width_, mode_height_, mode_refresh_);
+  if (index < 0) {
+    return nullptr;
+  }
+
+  auto mode = wlr_modes[index];
+  if (mode_policy_ == OUTPUT_MODE_EXPLICIT &&
+      (mode->width != mode_width_ || mode->height != mode_height_)) {
+    spdlog::warn("{} has no {}x{} mode", id(), mode_width_, mode_height_);
+  }
+
+  return mode;
 }
 
-void Output::set_mode()
+bool Output::set_mode()
 {
   if (wl_list_empty(&wlr_output->modes)) {
-    return;
+    // Nested and headless outputs take any size
+    if (mode_policy_ != OUTPUT_MODE_EXPLICIT || mode_width_ <= 0 || mode_height_ <= 0) {
+      return false;
+    }
+
+    if (wlr_output->width == mode_width_ && wlr_output->height == mode_height_ &&
+        wlr_output->refresh == mode_refresh_) {
+      return false;
+    }
+
+    wlr_output_set_custom_mode(wlr_output, mode_width_, mode_height_, mode_refresh_);
+    return true;
   }
 
-  struct wlr_output_mode *mode = wlr_output_preferred_mode(wlr_output);
-  if (wlr_output->current_mode == mode) {
-    return;
+  struct wlr_output_mode *mode = find_mode();
+  if (mode == nullptr || wlr_output->current_mode == mode) {
+    return false;
   }
 
   spdlog::debug("{} mode:{}x{}@{}", id(), mode->width, mode->height, mode->refresh * 0.001);
   wlr_output_set_mode(wlr_output, mode);
+  return true;
+}
+
+void Output::mirror(IOutput *source)
+{
+  auto output = dynamic_cast<Output*>(source);
+  if (output == this) {
+    spdlog::warn("{} can't mirror itself", id());
+    output = nullptr;
+  }
+
+  if (output == mirror_source_) {
+    return;
+  }
+
+  if (mirror_source_ != nullptr) {
+    auto &mirrors = mirror_source_->mirrors_;
+    mirrors.erase(std::remove(mirrors.begin(), mirrors.end(), this), mirrors.end());
+  }
+
+  mirror_source_ = output;
+
+  if (mirror_source_ != nullptr) {
+    spdlog::debug("{} mirrors {}", id(), mirror_source_->id());
+    mirror_source_->mirrors_.push_back(this);
+    remove_layout();
+  }
+
+  take_whole_damage();
+}
+
+bool Output::mirroring() const
+{
+  return mirror_source_ != nullptr;
+}
+
+// Fits the source's frame inside the mirror, keeping its aspect ratio
+wlr_box Output::mirror_box() const
+{
+  auto source = mirror_source_->wlr_output;
+  if (source->width <= 0 || source->height <= 0) {
+    return wlr_box { 0, 0, 0, 0 };
+  }
+
+  float scale = std::min(
+    static_cast<float>(wlr_output->width) / source->width,
+    static_cast<float>(wlr_output->height) / source->height);
+
+  int width = std::round(source->width * scale);
+  int height = std::round(source->height * scale);
+
+  wlr_box box = {
+    .x = (wlr_output->width - width) / 2,
+    .y = (wlr_output->height - height) / 2,
+    .width = width,
+    .height = height
+  };
+  return box;
+}
+
+void Output::take_mirror_damage()
+{
+  auto source = mirror_source_->wlr_output;
+  wlr_box box = mirror_box();
+  if (wlr_box_empty(&box)) {
+    return;
+  }
+
+  pixman_region32_t damage;
+  pixman_region32_init(&damage);
+  pixman_region32_copy(&damage, &mirror_source_->damage_->current);
+
+  float scale = static_cast<float>(box.width) / source->width;
+  wlr_region_scale(&damage, &damage, scale);
+  pixman_region32_translate(&damage, box.x, box.y);
+
+  if (scale != 1.0f) {
+    wlr_region_expand(&damage, &damage, 1);
+  }
+
+  wlr_output_damage_add(damage_, &damage);
+  pixman_region32_fini(&damage);
 }
 
 void Output::send_enter(const std::vector<std::shared_ptr<View>>& views)
 {
+  if (mirror_source_ != nullptr) {
+    return;
+  }
+
   if (enter_frames_left_-- > 0) {
     for (auto &view : views) {
       view->enter(this);
@@ -147,12 +514,6 @@ void Output::send_enter(const std::vector<std::shared_ptr<View>>& views)
   }
 }
 
-void Output::set_menubar(View *view)
-{
-  view->move(x(), y());
-  view->resize(wlr_output->width, View::MENU_HEIGHT);
-}
-
 void Output::add_view(View *view)
 {
   wlr_box geometry;
@@ -164,8 +525,8 @@ void Output::add_view(View *view)
   view->x = inside_x;
   view->y = inside_y;
 
-  if (view->y + geometry.y < top_margin()) {
-    view->y = top_margin() - geometry.y;
+  if (view->y + geometry.y < usable_area_.y) {
+    view->y = usable_area_.y - geometry.y;
   }
 
   if (view->y + geometry.height > wlr_output->height - view->y) {
@@ -183,15 +544,60 @@ void Output::place_cursor(Cursor *cursor)
 
 void Output::maximize_view(View *view)
 {
-  int new_width = wlr_output->width / wlr_output->scale;
-  int new_height = wlr_output->height / wlr_output->scale;
+  wlr_box area = usable_area();
+  view->configure(area.x, area.y, area.width, area.height);
+}
+
+void Output::fullscreen_view(View *view)
+{
+  // Fullscreen ignores panels, the view covers the whole output
+  wlr_box *output_box = box();
+  if (output_box == nullptr) {
+    return;
+  }
+
+  view->configure(output_box->x, output_box->y, output_box->width, output_box->height);
+}
+
+bool Output::covered_by(const View *view) const
+{
+  wlr_box geometry;
+  view->geometry(&geometry);
+
+  wlr_box *output_box = box();
+  if (output_box == nullptr) {
+    return false;
+  }
+
+  int view_x = view->x + geometry.x;
+  int view_y = view->y + geometry.y;
+
+  return view_x <= output_box->x && view_y <= output_box->y &&
+    view_x + geometry.width >= output_box->x + output_box->width &&
+    view_y + geometry.height >= output_box->y + output_box->height;
+}
+
+bool Output::opaque(const View *view) const
+{
+  // The old buffers of a pending transaction may not fit the output yet
+  if (!view->saved_buffers().empty()) {
+    return false;
+  }
 
-  view->resize(new_width, new_height - top_margin());
+  wlr_surface *surface = view->surface();
+  if (surface == nullptr || surface->buffer == nullptr) {
+    return false;
+  }
 
-  int new_x = x();
-  int new_y = y() + top_margin();
+  pixman_box32_t surface_box = {
+    .x1 = 0,
+    .y1 = 0,
+    .x2 = surface->current.width,
+    .y2 = surface->current.height
+  };
 
-  view->move(new_x, new_y);
+  auto overlap = pixman_region32_contains_rectangle(&surface->opaque_region, &surface_box);
+  return overlap == PIXMAN_REGION_IN;
 }
 
 void Output::move_view(View *view, double x, double y)
@@ -199,25 +605,31 @@ void Output::move_view(View *view, double x, double y)
   wlr_box box;
   view->geometry(&box);
 
-  if (y + box.y < top_margin()) {
-    y = top_margin() - box.y;
+  wlr_box area = usable_area();
+  if (y + box.y < area.y) {
+    y = area.y - box.y;
   }
 
   view->move(x, y);
 }
 
-void Output::commit()
+bool Output::commit()
 {
   if (!wlr_output_commit(wlr_output)) {
     std::cerr << "Failed to commit output" << std::endl;
+    return false;
   }
+  return true;
+}
+
+void Output::schedule_frame()
+{
+  wlr_output_schedule_frame(wlr_output);
 }
 
 std::string Output::id() const
 {
-  std::stringstream id;
-  id << wlr_output->make << " " << wlr_output->model;
-  return id.str();
+  return id_;
 }
 
 int Output::width() const
@@ -251,18 +663,104 @@ static void scissor_output(struct wlr_output *wlr_output, pixman_box32_t *rect)
   wlr_renderer_scissor(renderer, &box);
 }
 
-static void render_surface(wlr_surface *surface, int sx, int sy, void *data) {
+static void render_texture(struct wlr_output *output, wlr_renderer *renderer,
+  wlr_texture *texture, const wlr_box *box, wl_output_transform surface_transform,
+  pixman_region32_t *output_damage)
+{
+  float matrix[9];
+  enum wl_output_transform transform = wlr_output_transform_invert(surface_transform);
+  wlr_matrix_project_box(matrix, box, transform, 0, output->transform_matrix);
+
+  pixman_region32_t damage;
+  pixman_region32_init(&damage);
+  pixman_region32_union_rect(&damage, &damage, box->x, box->y, box->width, box->height);
+  pixman_region32_intersect(&damage, &damage, output_damage);
+
+  int nrects;
+  pixman_box32_t *rects = pixman_region32_rectangles(&damage, &nrects);
+  for (int i = 0; i < nrects; ++i) {
+    scissor_output(output, &rects[i]);
+    wlr_render_texture_with_matrix(renderer, texture, matrix, 1);
+  }
+
+  pixman_region32_fini(&damage);
+}
+
+// Rounds the edges rather than the size so that neighbouring surfaces
+// still meet without gaps or overlap at fractional scales
+static wlr_box scale_box(double x, double y, int width, int height, float scale)
+{
+  int left = std::round(x * scale);
+  int top = std::round(y * scale);
+  int right = std::round((x + width) * scale);
+  int bottom = std::round((y + height) * scale);
+
+  wlr_box box = {
+    .x = left,
+    .y = top,
+    .width = right - left,
+    .height = bottom - top
+  };
+  return box;
+}
+
+static void render_draw_list(const DrawList& draw_list, struct wlr_output *output,
+  wlr_renderer *renderer, pixman_region32_t *output_damage)
+{
+  int nrects;
+  pixman_box32_t *rects = pixman_region32_rectangles(output_damage, &nrects);
+
+  std::vector<DrawRect> damage;
+  for (int i = 0; i < nrects; ++i) {
+    DrawRect rect = {
+      .x1 = rects[i].x1,
+      .y1 = rects[i].y1,
+      .x2 = rects[i].x2,
+      .y2 = rects[i].y2
+    };
+    damage.push_back(rect);
+  }
+
+  float matrix[9];
+  const DrawItem *projected = nullptr;
+
+  for (auto &call : draw_list.batch(damage)) {
+    auto item = call.item;
+
+    // Calls for one item arrive together, so each quad is projected once
+    if (item != projected) {
+      wlr_box box = {
+        .x = item->x,
+        .y = item->y,
+        .width = item->width,
+        .height = item->height
+      };
+      auto item_transform = static_cast<wl_output_transform>(item->transform);
+      auto transform = wlr_output_transform_invert(item_transform);
+      wlr_matrix_project_box(matrix, &box, transform, 0, output->transform_matrix);
+      projected = item;
+    }
+
+    pixman_box32_t clip = {
+      .x1 = call.clip.x1,
+      .y1 = call.clip.y1,
+      .x2 = call.clip.x2,
+      .y2 = call.clip.y2
+    };
+    scissor_output(output, &clip);
+    wlr_render_texture_with_matrix(renderer, item->texture, matrix, item->alpha);
+  }
+}
+
+static void collect_surface(wlr_surface *surface, int sx, int sy, void *data) {
   if (surface == NULL) {
     return;
   }
 
   /* This function is called for every surface that needs to be rendered. */
   auto rdata = static_cast<struct render_data*>(data);
-  View *view = rdata->view;
   wlr_output_layout *layout = rdata->layout;
   struct wlr_output *output = rdata->output;
-  wlr_renderer *renderer = rdata->renderer;
-  pixman_region32_t *output_damage = rdata->output_damage;
 
   /* We first obtain a wlr_texture, which is a GPU resource. wlroots
    * automatically handles negotiating these with the client. The underlying
@@ -283,96 +781,516 @@ static void render_surface(wlr_surface *surface, int sx, int sy, void *data) {
 
   wlr_output_layout_output_coords(layout, output, &ox, &oy);
 
-  ox += view->x + sx;
-  oy += view->y + sy;
+  ox += rdata->x + sx;
+  oy += rdata->y + sy;
 
-  /* We also have to apply the scale factor for HiDPI outputs. This is only
-   * part of the puzzle, TinyWL does not fully support HiDPI. */
-  struct wlr_box box = {
-    .x = static_cast<int>(ox) * static_cast<int>(output->scale),
-    .y = static_cast<int>(oy) * static_cast<int>(output->scale),
-    .width = surface->current.width * static_cast<int>(output->scale),
-    .height = surface->current.height * static_cast<int>(output->scale),
-  };
+  /* We also have to apply the scale factor for HiDPI outputs. */
+  struct wlr_box box = scale_box(ox, oy, surface->current.width, surface->current.height,
+    output->scale);
 
-  float matrix[9];
-  enum wl_output_transform transform = wlr_output_transform_invert(surface->current.transform);
-  wlr_matrix_project_box(matrix, &box, transform, 0, output->transform_matrix);
+  pixman_box32_t surface_box = {
+    .x1 = 0,
+    .y1 = 0,
+    .x2 = surface->current.width,
+    .y2 = surface->current.height
+  };
+  bool opaque = wlr_texture_is_opaque(texture) ||
+    pixman_region32_contains_rectangle(&surface->opaque_region, &surface_box) == PIXMAN_REGION_IN;
+
+  DrawItem item = {
+    .surface = surface,
+    .texture = texture,
+    .x = box.x,
+    .y = box.y,
+    .width = box.width,
+    .height = box.height,
+    .transform = surface->current.transform,
+    .opaque = opaque,
+    .alpha = 1.0f
+  };
+  rdata->draw_list->add(item);
+}
 
-  pixman_region32_t damage;
-  pixman_region32_init(&damage);
-  pixman_region32_union_rect(&damage, &damage, box.x, box.y, box.width, box.height);
-  pixman_region32_intersect(&damage, &damage, output_damage);
+static void collect_saved_buffer(const SavedBuffer& saved_buffer, struct render_data *rdata)
+{
+  View *view = rdata->view;
+  struct wlr_output *output = rdata->output;
 
-  int nrects;
-  pixman_box32_t *rects = pixman_region32_rectangles(&damage, &nrects);
-  for (int i = 0; i < nrects; ++i) {
-    scissor_output(output, &rects[i]);
-    wlr_render_texture_with_matrix(renderer, texture, matrix, 1);
+  struct wlr_texture *texture = saved_buffer.buffer->texture;
+  if (texture == NULL) {
+    return;
   }
 
-  pixman_region32_fini(&damage);
-}
-
-void surface_damage_output(wlr_surface *surface, int sx, int sy, void *data)
-{
-  auto damage_data = static_cast<damage_iterator_data*>(data);
-  auto view = damage_data->view;
-  auto output = damage_data->output;
-  auto output_damage = damage_data->output_damage;
-  auto layout = damage_data->output_layout;
+  double ox = 0;
+  double oy = 0;
 
-  double output_x = view->x + sx;
-  double output_y = view->y + sy;
-  wlr_output_layout_output_coords(layout, output, &output_x, &output_y);
+  wlr_output_layout_output_coords(rdata->layout, output, &ox, &oy);
 
-  pixman_region32_t damage;
-  pixman_region32_init(&damage);
-  wlr_surface_get_effective_damage(surface, &damage);
-  pixman_region32_translate(&damage, output_x, output_y);
+  ox += view->x + saved_buffer.x;
+  oy += view->y + saved_buffer.y;
 
-  wlr_region_scale(&damage, &damage, output->scale);
+  struct wlr_box box = scale_box(ox, oy, saved_buffer.width, saved_buffer.height,
+    output->scale);
 
-  wlr_output_damage_add(output_damage, &damage);
-  pixman_region32_fini(&damage);
+  DrawItem item = {
+    .surface = nullptr,
+    .texture = texture,
+    .x = box.x,
+    .y = box.y,
+    .width = box.width,
+    .height = box.height,
+    .transform = saved_buffer.transform,
+    .opaque = wlr_texture_is_opaque(texture),
+    .alpha = 1.0f
+  };
+  rdata->draw_list->add(item);
 }
 
-bool Output::is_named(const std::string& name) const
+// Collects a surface of a view drawn somewhere other than where it lives,
+// as in the overview or part way through an animation. The position is
+// output-local, with the view's surfaces scaled about it.
+static void collect_scaled_surface(wlr_surface *surface, int sx, int sy, void *data)
 {
-  bool match = name.compare(wlr_output->name) == 0;
-  return match;
-}
+  auto sdata = static_cast<struct scaled_data*>(data);
 
-void Output::take_whole_damage()
-{
-  wlr_output_damage_add_whole(damage_);
-}
+  wlr_texture *texture = wlr_surface_get_texture(surface);
+  if (texture == NULL) {
+    return;
+  }
 
-void Output::take_damage(const View *view)
-{
-  damage_iterator_data data = {
-    .view = view,
-    .output = wlr_output,
-    .output_damage = damage_,
-    .output_layout = layout_
+  float output_scale = sdata->output->scale;
+  int left = std::round((sdata->x + sx * sdata->scale_x) * output_scale);
+  int top = std::round((sdata->y + sy * sdata->scale_y) * output_scale);
+  int right = std::round(
+    (sdata->x + (sx + surface->current.width) * sdata->scale_x) * output_scale);
+  int bottom = std::round(
+    (sdata->y + (sy + surface->current.height) * sdata->scale_y) * output_scale);
+
+  DrawItem item = {
+    .surface = surface,
+    .texture = texture,
+    .x = left,
+    .y = top,
+    .width = right - left,
+    .height = bottom - top,
+    .transform = surface->current.transform,
+    .opaque = wlr_texture_is_opaque(texture) && sdata->alpha >= 1.0f,
+    .alpha = sdata->alpha
   };
-  view->for_each_surface(surface_damage_output, &data);
+  sdata->draw_list->add(item);
 }
 
-void Output::set_enabled(bool enabled)
+// An animating view is drawn at its animated box, with its surfaces
+// stretched from its geometry to fit
+static void collect_animated_view(View *view, struct render_data *rdata)
 {
-  enter_frames_left_ = ENTER_FRAME_REPEAT_COUNT;
-
-  if (enabled == enabled_) {
+  wlr_box geometry;
+  view->geometry(&geometry);
+  if (geometry.width <= 0 || geometry.height <= 0) {
     return;
   }
 
-  if (!enabled) {
+  double ox = view->animation.x;
+  double oy = view->animation.y;
+  wlr_output_layout_output_coords(rdata->layout, rdata->output, &ox, &oy);
+
+  double scale_x = view->animation.width / geometry.width;
+  double scale_y = view->animation.height / geometry.height;
+
+  struct scaled_data sdata = {
+    .output = rdata->output,
+    .draw_list = rdata->draw_list,
+    .x = ox - geometry.x * scale_x,
+    .y = oy - geometry.y * scale_y,
+    .scale_x = scale_x,
+    .scale_y = scale_y,
+    .alpha = view->animation.alpha
+  };
+  view->for_each_surface(collect_scaled_surface, &sdata);
+}
+
+static void collect_views(const std::vector<std::shared_ptr<View>>& views,
+  struct render_data *rdata)
+{
+  for (auto it = views.rbegin(); it != views.rend(); ++it) {
+    auto &view = (*it);
+
+    rdata->view = view.get();
+    rdata->x = view->x;
+    rdata->y = view->y;
+
+    if (view->animating) {
+      collect_animated_view(view.get(), rdata);
+      continue;
+    }
+
+    // A view waiting on a transaction keeps showing its old buffers,
+    // subsurfaces and popups included
+    auto &saved_buffers = view->saved_buffers();
+    if (!saved_buffers.empty()) {
+      for (auto &saved_buffer : saved_buffers) {
+        collect_saved_buffer(saved_buffer, rdata);
+      }
+      continue;
+    }
+
+    view->for_each_surface(collect_surface, rdata);
+  }
+}
+
+static void collect_layer(const std::vector<LayerSurface*>& layer_surfaces,
+  int output_x, int output_y, struct render_data *rdata)
+{
+  for (auto layer_surface : layer_surfaces) {
+    if (!layer_surface->mapped) {
+      continue;
+    }
+
+    rdata->view = nullptr;
+    rdata->x = output_x + layer_surface->x;
+    rdata->y = output_y + layer_surface->y;
+
+    layer_surface->for_each_surface(collect_surface, rdata);
+  }
+}
+
+// Every window is drawn scaled into its slot with its live textures, as
+// part of the same draw list as the rest of the frame
+static void collect_overview(const std::vector<OverviewSlot>& slots, wlr_output *output,
+  DrawList *draw_list)
+{
+  for (auto it = slots.rbegin(); it != slots.rend(); ++it) {
+    auto view = it->view.lock();
+    if (!view) {
+      continue;
+    }
+
+    wlr_box geometry;
+    view->geometry(&geometry);
+    if (geometry.width <= 0) {
+      continue;
+    }
+
+    double scale = static_cast<double>(it->width) / geometry.width;
+    struct scaled_data sdata = {
+      .output = output,
+      .draw_list = draw_list,
+      .x = it->x - geometry.x * scale,
+      .y = it->y - geometry.y * scale,
+      .scale_x = scale,
+      .scale_y = scale,
+      .alpha = 1.0f
+    };
+    view->for_each_surface(collect_scaled_surface, &sdata);
+  }
+}
+
+void surface_damage_output(wlr_surface *surface, int sx, int sy, void *data)
+{
+  auto damage_data = static_cast<damage_iterator_data*>(data);
+  auto output = damage_data->output;
+  auto output_damage = damage_data->output_damage;
+  auto layout = damage_data->output_layout;
+
+  double output_x = damage_data->x + sx;
+  double output_y = damage_data->y + sy;
+  wlr_output_layout_output_coords(layout, output, &output_x, &output_y);
+
+  pixman_region32_t damage;
+  pixman_region32_init(&damage);
+  wlr_surface_get_effective_damage(surface, &damage);
+  pixman_region32_translate(&damage, std::floor(output_x), std::floor(output_y));
+
+  wlr_region_scale(&damage, &damage, output->scale);
+
+  // Fractional scales round surface edges to the nearest pixel, so grow
+  // the damage to cover the pixels on either side
+  if (output->scale != std::floor(output->scale)) {
+    wlr_region_expand(&damage, &damage, 1);
+  }
+
+  wlr_output_damage_add(output_damage, &damage);
+  pixman_region32_fini(&damage);
+}
+
+bool Output::is_named(const std::string& name) const
+{
+  bool match = name.compare(wlr_output->name) == 0;
+  return match;
+}
+
+void Output::take_whole_damage()
+{
+  overlay_cache_->invalidate();
+  wlr_output_damage_add_whole(damage_);
+}
+
+void Output::take_damage(const View *view)
+{
+  if (mirror_source_ != nullptr) {
+    return;
+  }
+
+  if (view->layer() == VIEW_LAYER_OVERLAY) {
+    overlay_cache_->invalidate();
+  }
+
+  if (overview_ && view->layer() == VIEW_LAYER_TOP) {
+    take_overview_damage(view);
+    return;
+  }
+
+  // Nothing but the fullscreen view is drawn, so nothing else can damage it
+  if (fullscreen_view_ != nullptr && fullscreen_view_ != view) {
+    return;
+  }
+
+  damage_iterator_data data = {
+    .x = view->x,
+    .y = view->y,
+    .output = wlr_output,
+    .output_damage = damage_,
+    .output_layout = layout_
+  };
+  view->for_each_surface(surface_damage_output, &data);
+}
+
+void Output::set_overview(bool overview)
+{
+  overview_ = overview;
+  overview_hover_ = nullptr;
+  overview_slots_.clear();
+  take_whole_damage();
+}
+
+void Output::set_overview_hover(const View *view)
+{
+  overview_hover_ = view;
+}
+
+std::shared_ptr<View> Output::overview_view_at(double lx, double ly) const
+{
+  double ox = lx - x();
+  double oy = ly - y();
+
+  for (auto &slot : overview_slots_) {
+    bool inside = ox >= slot.x && ox < slot.x + slot.width &&
+      oy >= slot.y && oy < slot.y + slot.height;
+    if (!inside) {
+      continue;
+    }
+
+    auto view = slot.view.lock();
+    if (!view || view->deleted) {
+      return nullptr;
+    }
+    return view;
+  }
+
+  return nullptr;
+}
+
+const OverviewSlot* Output::overview_slot(const View *view) const
+{
+  if (view == nullptr) {
+    return nullptr;
+  }
+
+  for (auto &slot : overview_slots_) {
+    if (slot.view.lock().get() == view) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+// The whole grid is laid out in one go from the views' current sizes.
+// Returns true when any slot moved, so the output can be damaged whole.
+bool Output::layout_overview(const std::vector<std::shared_ptr<View>>& views) const
+{
+  std::vector<std::shared_ptr<View>> overview_views;
+  std::copy_if(views.begin(), views.end(), std::back_inserter(overview_views), [](auto &view) {
+    return !view->deleted && view->mapped && !view->minimized && view->layer() == VIEW_LAYER_TOP;
+  });
+
+  std::vector<wlr_box> sizes;
+  for (auto &view : overview_views) {
+    wlr_box geometry;
+    view->geometry(&geometry);
+    sizes.push_back(geometry);
+  }
+
+  wlr_box area = {
+    .x = usable_area_.x,
+    .y = usable_area_.y,
+    .width = usable_area_.width,
+    .height = usable_area_.height
+  };
+
+  std::vector<wlr_box> boxes;
+  overview_layout(&area, OVERVIEW_GAP, sizes, &boxes);
+
+  std::vector<OverviewSlot> slots;
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    OverviewSlot slot = {
+      .view = overview_views[i],
+      .x = boxes[i].x,
+      .y = boxes[i].y,
+      .width = boxes[i].width,
+      .height = boxes[i].height
+    };
+    slots.push_back(slot);
+  }
+
+  bool changed = slots.size() != overview_slots_.size();
+  for (size_t i = 0; i < slots.size() && !changed; ++i) {
+    auto &a = slots[i];
+    auto &b = overview_slots_[i];
+    changed = a.view.lock() != b.view.lock() || a.x != b.x || a.y != b.y ||
+      a.width != b.width || a.height != b.height;
+  }
+
+  overview_slots_ = slots;
+  return changed;
+}
+
+void Output::take_box_damage(const wlr_box *box)
+{
+  if (mirror_source_ != nullptr || fullscreen_view_ != nullptr) {
+    return;
+  }
+
+  double ox = box->x;
+  double oy = box->y;
+  wlr_output_layout_output_coords(layout_, wlr_output, &ox, &oy);
+
+  wlr_box damage = scale_box(ox, oy, box->width, box->height, wlr_output->scale);
+  wlr_output_damage_add_box(damage_, &damage);
+}
+
+// Where a box in layout coordinates lies in the output's buffer, clipped
+// to the output, the whole of it for a null box
+bool Output::buffer_area(const wlr_box *box, wlr_box *area) const
+{
+  int width, height;
+  wlr_output_transformed_resolution(wlr_output, &width, &height);
+
+  wlr_box output_area = { .x = 0, .y = 0, .width = width, .height = height };
+  wlr_box clipped = output_area;
+  if (box != nullptr) {
+    double ox = box->x;
+    double oy = box->y;
+    wlr_output_layout_output_coords(layout_, wlr_output, &ox, &oy);
+
+    wlr_box scaled = scale_box(ox, oy, box->width, box->height, wlr_output->scale);
+    if (!wlr_box_intersection(&clipped, &output_area, &scaled)) {
+      return false;
+    }
+  }
+
+  // Rotated outputs are read back the way their buffer lies
+  enum wl_output_transform transform = wlr_output_transform_invert(wlr_output->transform);
+  wlr_box_transform(area, &clipped, transform, width, height);
+  return true;
+}
+
+bool Output::queue_capture(const wlr_box *box, bool damaged_only, const CaptureCallback& done)
+{
+  wlr_box area;
+  if (!enabled_ || !buffer_area(box, &area)) {
+    return false;
+  }
+
+  CaptureRequest request = {
+    .x = area.x,
+    .y = area.y,
+    .width = area.width,
+    .height = area.height,
+    .damaged_only = damaged_only,
+    .done = done
+  };
+  captures_.push_back(request);
+  return true;
+}
+
+// The request is only queued and read back by the next frame. The box is
+// in layout coordinates, a null box captures the whole output.
+bool Output::capture(const wlr_box *box, const CaptureCallback& done)
+{
+  if (!queue_capture(box, false, done)) {
+    return false;
+  }
+
+  // The buffer is already up to date, so no damage is added. That would
+  // show up as a change to everyone following the output's damage.
+  schedule_frame();
+  return true;
+}
+
+// Waits for a frame that damages the box instead of asking for one
+bool Output::capture_damage(const wlr_box *box, const CaptureCallback& done)
+{
+  return queue_capture(box, true, done);
+}
+
+bool Output::capturing() const
+{
+  return std::any_of(captures_.begin(), captures_.end(), [](auto &el) {
+    return !el.damaged_only;
+  });
+}
+
+// A window in the overview only ever covers its own slot
+void Output::take_overview_damage(const View *view)
+{
+  auto slot = overview_slot(view);
+  if (slot == nullptr) {
+    return;
+  }
+
+  wlr_box box = scale_box(slot->x, slot->y, slot->width, slot->height, wlr_output->scale);
+  wlr_output_damage_add_box(damage_, &box);
+}
+
+void Output::take_layer_damage(const LayerSurface *layer_surface)
+{
+  if (layer_surface->layer() == VIEW_LAYER_OVERLAY) {
+    overlay_cache_->invalidate();
+  }
+
+  if (fullscreen_view_ != nullptr) {
+    return;
+  }
+
+  damage_iterator_data data = {
+    .x = static_cast<double>(x() + layer_surface->x),
+    .y = static_cast<double>(y() + layer_surface->y),
+    .output = wlr_output,
+    .output_damage = damage_,
+    .output_layout = layout_
+  };
+  layer_surface->for_each_surface(surface_damage_output, &data);
+}
+
+void Output::set_enabled(bool enabled)
+{
+  enter_frames_left_ = ENTER_FRAME_REPEAT_COUNT;
+
+  if (enabled == enabled_) {
+    return;
+  }
+
+  if (!enabled) {
     wlr_output_rollback(wlr_output);
   }
 
   wlr_output_enable(wlr_output, enabled);
   enabled_ = enabled;
+
+  // A disabled output draws no more frames to read them from
+  if (!enabled_) {
+    fail_captures();
+  }
 }
 
 static void send_frame_done(wlr_surface *surface, int sx, int sy, void *data) {
@@ -380,24 +1298,336 @@ static void send_frame_done(wlr_surface *surface, int sx, int sy, void *data) {
   wlr_surface_send_frame_done(surface, when);
 }
 
-void Output::render(const std::vector<std::shared_ptr<View>>& views) const
+// Only used when the source's buffer can't be shared as a dmabuf, e.g.
+// on headless outputs, so the frame is read back while it is still bound
+void Output::read_mirror_pixels() const
+{
+  int stride = wlr_output->width * 4;
+  mirror_pixels_.resize(stride * wlr_output->height);
+
+  uint32_t flags = 0;
+  bool read = wlr_renderer_read_pixels(renderer_, WL_SHM_FORMAT_ARGB8888, &flags, stride,
+    wlr_output->width, wlr_output->height, 0, 0, 0, 0, mirror_pixels_.data());
+
+  if (!read) {
+    mirror_pixels_.clear();
+    return;
+  }
+
+  mirror_y_invert_ = flags & WLR_RENDERER_READ_PIXELS_Y_INVERT;
+}
+
+static void fail_capture_requests(const std::vector<CaptureRequest>& captures)
+{
+  for (auto &capture : captures) {
+    CapturedFrame frame = {
+      .pixels = nullptr,
+      .x = 0,
+      .y = 0,
+      .width = 0,
+      .height = 0,
+      .stride = 0,
+      .rows = 0,
+      .y_invert = false
+    };
+    capture.done(std::move(frame));
+  }
+}
+
+// Every capture this frame serves shares one readback of the area they
+// cover together, and each is handed a view of its own part of it. Ones
+// that only want changes stay queued until the frame damages their part.
+void Output::read_captures(const pixman_region32_t *damage) const
+{
+  std::vector<CaptureRequest> captures;
+  auto waiting = std::partition(captures_.begin(), captures_.end(), [damage](auto &el) {
+    pixman_box32_t box = { el.x, el.y, el.x + el.width, el.y + el.height };
+    return !el.damaged_only || pixman_region32_contains_rectangle(
+      const_cast<pixman_region32_t*>(damage), &box) != PIXMAN_REGION_OUT;
+  });
+  std::move(captures_.begin(), waiting, std::back_inserter(captures));
+  captures_.erase(captures_.begin(), waiting);
+
+  if (captures.empty()) {
+    return;
+  }
+
+  int left = captures[0].x;
+  int top = captures[0].y;
+  int right = captures[0].x + captures[0].width;
+  int bottom = captures[0].y + captures[0].height;
+  for (auto &capture : captures) {
+    left = std::min(left, capture.x);
+    top = std::min(top, capture.y);
+    right = std::max(right, capture.x + capture.width);
+    bottom = std::max(bottom, capture.y + capture.height);
+  }
+
+  // Left uninitialized, zeroing a whole 4K frame costs more than reading it
+  int width = right - left;
+  int height = bottom - top;
+  int stride = width * 4;
+  std::shared_ptr<uint8_t[]> pixels(new uint8_t[stride * height]);
+
+  uint32_t flags = 0;
+  bool read = wlr_renderer_read_pixels(renderer_, WL_SHM_FORMAT_ARGB8888, &flags, stride,
+    width, height, left, top, 0, 0, pixels.get());
+
+  if (!read) {
+    spdlog::error("Unable to read back output {} for a capture", id_);
+    fail_capture_requests(captures);
+    return;
+  }
+
+  for (auto &capture : captures) {
+    CapturedFrame frame = {
+      .pixels = pixels,
+      .x = capture.x - left,
+      .y = capture.y - top,
+      .width = capture.width,
+      .height = capture.height,
+      .stride = stride,
+      .rows = height,
+      .y_invert = (flags & WLR_RENDERER_READ_PIXELS_Y_INVERT) != 0
+    };
+    capture.done(std::move(frame));
+  }
+}
+
+void Output::fail_captures() const
+{
+  std::vector<CaptureRequest> captures;
+  captures.swap(captures_);
+  fail_capture_requests(captures);
+}
+
+wlr_texture* Output::upload_mirror_pixels() const
+{
+  auto source = mirror_source_;
+  if (source->mirror_pixels_.empty()) {
+    return nullptr;
+  }
+
+  int width = source->wlr_output->width;
+  int height = source->wlr_output->height;
+  int stride = width * 4;
+
+  if (mirror_texture_ != nullptr) {
+    int texture_width, texture_height;
+    wlr_texture_get_size(mirror_texture_, &texture_width, &texture_height);
+
+    if (texture_width == width && texture_height == height) {
+      wlr_texture_write_pixels(mirror_texture_, stride, width, height, 0, 0, 0, 0,
+        source->mirror_pixels_.data());
+      return mirror_texture_;
+    }
+
+    wlr_texture_destroy(mirror_texture_);
+  }
+
+  mirror_texture_ = wlr_texture_from_pixels(renderer_, WL_SHM_FORMAT_ARGB8888, stride,
+    width, height, source->mirror_pixels_.data());
+  return mirror_texture_;
+}
+
+void Output::render_mirror() const
+{
+  bool needs_frame = false;
+  pixman_region32_t buffer_damage;
+  pixman_region32_init(&buffer_damage);
+  wlr_output_damage_attach_render(damage_, &needs_frame, &buffer_damage);
+
+  if (!needs_frame && !capturing()) {
+    pixman_region32_fini(&buffer_damage);
+    return;
+  }
+
+  auto source = mirror_source_;
+  enum wl_output_transform transform = WL_OUTPUT_TRANSFORM_NORMAL;
+
+  // Sample the source's last committed buffer directly on the GPU
+  wlr_texture *texture = nullptr;
+  wlr_dmabuf_attributes attributes;
+  bool exported = wlr_output_export_dmabuf(source->wlr_output, &attributes);
+  if (exported) {
+    texture = wlr_texture_from_dmabuf(renderer_, &attributes);
+  }
+
+  bool readback = texture == nullptr;
+  if (readback != source->mirror_readback_) {
+    source->mirror_readback_ = readback;
+    source->take_whole_damage();
+  }
+
+  if (readback) {
+    texture = upload_mirror_pixels();
+    if (source->mirror_y_invert_) {
+      transform = WL_OUTPUT_TRANSFORM_FLIPPED_180;
+    }
+  }
+
+  wlr_renderer_begin(renderer_, wlr_output->width, wlr_output->height);
+
+  float clear_color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+  int nrects;
+  pixman_box32_t *rects = pixman_region32_rectangles(&buffer_damage, &nrects);
+  for (int i = 0; i < nrects; ++i) {
+    scissor_output(wlr_output, &rects[i]);
+    wlr_renderer_clear(renderer_, clear_color);
+  }
+
+  if (texture != nullptr) {
+    wlr_box box = mirror_box();
+    render_texture(wlr_output, renderer_, texture, &box, transform, &buffer_damage);
+  }
+
+  wlr_renderer_scissor(renderer_, NULL);
+
+  pixman_region32_t frame_damage;
+  pixman_region32_init(&frame_damage);
+
+  enum wl_output_transform output_transform = wlr_output_transform_invert(wlr_output->transform);
+  wlr_region_transform(&frame_damage, &damage_->current, output_transform,
+    wlr_output->width, wlr_output->height);
+
+  on_damage.emit(&frame_damage);
+  read_captures(&frame_damage);
+
+  wlr_renderer_end(renderer_);
+
+  wlr_output_set_damage(wlr_output, &frame_damage);
+  pixman_region32_fini(&frame_damage);
+
+  wlr_output_commit(wlr_output);
+
+  pixman_region32_fini(&buffer_damage);
+
+  if (exported) {
+    if (texture != nullptr) {
+      wlr_texture_destroy(texture);
+    }
+    wlr_dmabuf_attributes_finish(&attributes);
+  }
+}
+
+// Composites the damaged part of the frame on the CPU and uploads just
+// that part, so an emulated GL only ever draws one quad per frame
+wlr_texture* Output::composite_software(const DrawList& draw_list, pixman_region32_t *damage) const
+{
+  if (software_ == nullptr || !software_->can_composite(draw_list)) {
+    software_frame_valid_ = false;
+    return nullptr;
+  }
+
+  int width, height;
+  wlr_output_transformed_resolution(wlr_output, &width, &height);
+  int stride = width * 4;
+
+  bool resized = software_pixels_.size() != static_cast<size_t>(width) * height;
+  if (resized) {
+    software_pixels_.resize(static_cast<size_t>(width) * height);
+    software_frame_valid_ = false;
+  }
+
+  if (software_texture_ != nullptr) {
+    int texture_width, texture_height;
+    wlr_texture_get_size(software_texture_, &texture_width, &texture_height);
+
+    if (texture_width != width || texture_height != height) {
+      wlr_texture_destroy(software_texture_);
+      software_texture_ = nullptr;
+    }
+  }
+
+  // Frames drawn by GL in between left the CPU copy stale
+  pixman_region32_t region;
+  if (software_frame_valid_ && software_texture_ != nullptr) {
+    pixman_region32_init(&region);
+    pixman_region32_intersect_rect(&region, damage, 0, 0, width, height);
+  } else {
+    pixman_region32_init_rect(&region, 0, 0, width, height);
+  }
+
+  int nrects;
+  pixman_box32_t *rects = pixman_region32_rectangles(&region, &nrects);
+  for (int i = 0; i < nrects; ++i) {
+    software_->composite(draw_list, software_pixels_.data(), stride, rects[i].x1, rects[i].y1,
+      rects[i].x2 - rects[i].x1, rects[i].y2 - rects[i].y1);
+  }
+
+  if (software_texture_ == nullptr) {
+    software_texture_ = wlr_texture_from_pixels(renderer_, WL_SHM_FORMAT_XRGB8888, stride,
+      width, height, software_pixels_.data());
+  } else {
+    for (int i = 0; i < nrects; ++i) {
+      wlr_texture_write_pixels(software_texture_, stride, rects[i].x2 - rects[i].x1,
+        rects[i].y2 - rects[i].y1, rects[i].x1, rects[i].y1, rects[i].x1, rects[i].y1,
+        software_pixels_.data());
+    }
+  }
+
+  pixman_region32_fini(&region);
+
+  software_frame_valid_ = software_texture_ != nullptr;
+  return software_texture_;
+}
+
+void Output::render(const std::vector<std::shared_ptr<View>>& views,
+  const std::vector<Thumbnail*>& thumbnails) const
 {
   if (!enabled_) {
     return;
   }
 
+  // Mirrors reuse the source's composited frame instead of the views
+  if (mirror_source_ != nullptr) {
+    render_mirror();
+    return;
+  }
+
+  // A disconnected output stays enabled until it's configured again, but
+  // it has left the layout and there's nowhere to draw the views
+  if (box() == nullptr) {
+    fail_captures();
+    return;
+  }
+
   struct timespec now;
   clock_gettime(CLOCK_MONOTONIC, &now);
 
+  // Laid out before attaching, so a grid that moved is redrawn this frame
+  if (overview_ && layout_overview(views)) {
+    wlr_output_damage_add_whole(damage_);
+  }
+
   bool needs_frame = false;
   pixman_region32_t buffer_damage;
   pixman_region32_init(&buffer_damage);
   wlr_output_damage_attach_render(damage_, &needs_frame, &buffer_damage);
 
-  if (!needs_frame) {
+  // Attaching made the renderer's context current, which is all thumbnails
+  // need, so they're drawn whether or not the output itself has damage
+  uint32_t now_msec = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+  for (auto thumbnail : thumbnails) {
+    thumbnail->render(renderer_, now_msec);
+  }
+
+  // Captures need a frame even without damage, they read what the buffer
+  // already holds
+  if (!needs_frame && !capturing()) {
     return;
   }
 
+  // Past a point every extra scissor costs more than redrawing the gaps
+  // between the rects, and software GL pays for each draw in full
+  int damage_rects;
+  pixman_region32_rectangles(&buffer_damage, &damage_rects);
+  if (damage_rects > MAX_DAMAGE_RECTS) {
+    pixman_box32_t extents = *pixman_region32_extents(&buffer_damage);
+    pixman_region32_reset(&buffer_damage, &extents);
+  }
+
   std::vector<std::shared_ptr<View>> mapped_views;
   std::copy_if(views.begin(), views.end(), std::back_inserter(mapped_views), [](auto &view) {
     return !view->deleted && view->mapped;
@@ -405,9 +1635,24 @@ void Output::render(const std::vector<std::shared_ptr<View>>& views) const
 
   std::vector<std::shared_ptr<View>> active_views;
   std::copy_if(mapped_views.begin(), mapped_views.end(), std::back_inserter(active_views), [](auto &view) {
-    return !view->minimized;
+    return !view->minimized || view->animating;
   });
 
+  // A fullscreen view at the top of the stack owns the whole output, so
+  // everything else including the panels and overlays is culled
+  fullscreen_view_ = nullptr;
+  if (!active_views.empty() && !overview_) {
+    auto &top_view = active_views.front();
+    if (top_view->fullscreen() && top_view->layer() == VIEW_LAYER_TOP && !top_view->animating &&
+      covered_by(top_view.get())) {
+      fullscreen_view_ = top_view.get();
+    }
+  }
+
+  if (fullscreen_view_ != nullptr) {
+    active_views.resize(1);
+  }
+
   std::vector<std::shared_ptr<View>> top_layer_views;
   bool maximized_view = false;
   std::copy_if(active_views.begin(), active_views.end(), std::back_inserter(top_layer_views), [maximized_view](auto &view) mutable {
@@ -416,7 +1661,9 @@ void Output::render(const std::vector<std::shared_ptr<View>>& views) const
       return false;
     }
 
-    if (view->layer() == VIEW_LAYER_TOP && !maximized_view && view->maximized()) {
+    // Until it finishes growing, a maximized view doesn't hide anything
+    if (view->layer() == VIEW_LAYER_TOP && !maximized_view && view->maximized() &&
+        !view->animating) {
       maximized_view = true;
     }
 
@@ -430,51 +1677,128 @@ void Output::render(const std::vector<std::shared_ptr<View>>& views) const
 
   std::vector<std::shared_ptr<View>> render_list;
   render_list.insert(render_list.end(), overlay_layer_views.begin(), overlay_layer_views.end());
-  render_list.insert(render_list.end(), top_layer_views.begin(), top_layer_views.end());
+  if (!overview_) {
+    render_list.insert(render_list.end(), top_layer_views.begin(), top_layer_views.end());
+  }
+
+  // Snapshot everything that will be drawn before touching the renderer, so
+  // the draw pass only reads the list and never walks the scene graph
+  int width, height;
+  wlr_output_transformed_resolution(wlr_output, &width, &height);
+  DrawList draw_list(width, height);
+  DrawList overlay_list(width, height);
+
+  struct render_data render_data = {
+    .output = wlr_output,
+    .view = nullptr,
+    .x = 0,
+    .y = 0,
+    .layout = layout_,
+    .draw_list = &draw_list,
+  };
+
+  if (fullscreen_view_ != nullptr) {
+    collect_views(top_layer_views, &render_data);
+  } else {
+    collect_layer(layers_[VIEW_LAYER_BACKGROUND], x(), y(), &render_data);
+    collect_layer(layers_[VIEW_LAYER_BOTTOM], x(), y(), &render_data);
+    if (overview_) {
+      collect_overview(overview_slots_, wlr_output, &draw_list);
+    } else {
+      collect_views(top_layer_views, &render_data);
+    }
+    collect_layer(layers_[VIEW_LAYER_TOP], x(), y(), &render_data);
+
+    // The shell sits on top of everything, so it can be drawn as one layer
+    render_data.draw_list = &overlay_list;
+    collect_views(overlay_layer_views, &render_data);
+    collect_layer(layers_[VIEW_LAYER_OVERLAY], x(), y(), &render_data);
+  }
 
   if (!wlr_output_attach_render(wlr_output, NULL)) {
     return;
   }
 
+  wlr_texture *software_texture = nullptr;
+  if (software_ != nullptr) {
+    DrawList frame_list(width, height);
+    frame_list.append(draw_list);
+    frame_list.append(overlay_list);
+    software_texture = composite_software(frame_list, &buffer_damage);
+  }
+
+  wlr_texture *overlay_texture = nullptr;
+  if (software_texture == nullptr && !overlay_list.empty()) {
+    bool cached = overlay_cache_->valid(overlay_list, width, height) ||
+      overlay_cache_->update(renderer_, overlay_list, width, height);
+    if (cached) {
+      overlay_texture = overlay_cache_->texture();
+    }
+  }
+
   wlr_renderer_begin(renderer_, wlr_output->width, wlr_output->height);
 
   float clear_color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
 
+  // An opaque fullscreen view paints every pixel itself, and so does the
+  // CPU composited frame
+  bool needs_clear = software_texture == nullptr &&
+    (fullscreen_view_ == nullptr || !opaque(fullscreen_view_));
+
   int nrects;
   pixman_box32_t *rects = pixman_region32_rectangles(&buffer_damage, &nrects);
-  for (int i = 0; i < nrects; ++i) {
+  for (int i = 0; i < nrects && needs_clear; ++i) {
     scissor_output(wlr_output, &rects[i]);
     wlr_renderer_clear(renderer_, clear_color);
   }
 
-  for (auto it = render_list.rbegin(); it != render_list.rend(); ++it) {
-    auto &view = (*it);
-
-    struct render_data render_data = {
-      .output = wlr_output,
-      .renderer = renderer_,
-      .view = view.get(),
-      .when = &now,
-      .layout = layout_,
-      .output_damage = &buffer_damage,
-    };
+  if (software_texture != nullptr) {
+    wlr_box box = { .x = 0, .y = 0, .width = width, .height = height };
+    render_texture(wlr_output, renderer_, software_texture, &box, WL_OUTPUT_TRANSFORM_NORMAL,
+      &buffer_damage);
+  } else {
+    render_draw_list(draw_list, wlr_output, renderer_, &buffer_damage);
+  }
 
-    view->for_each_surface(render_surface, &render_data);
+  // The cache was drawn bottom up into GL's framebuffer, so it comes out flipped
+  if (overlay_texture != nullptr) {
+    wlr_box box = { .x = 0, .y = 0, .width = width, .height = height };
+    render_texture(wlr_output, renderer_, overlay_texture, &box, WL_OUTPUT_TRANSFORM_FLIPPED_180,
+      &buffer_damage);
+  } else if (software_texture == nullptr) {
+    render_draw_list(overlay_list, wlr_output, renderer_, &buffer_damage);
   }
 
   wlr_renderer_scissor(renderer_, NULL);
-  wlr_output_render_software_cursors(wlr_output, &buffer_damage);
-  wlr_renderer_end(renderer_);
 
   pixman_region32_t frame_damage;
   pixman_region32_init(&frame_damage);
 
   enum wl_output_transform transform = wlr_output_transform_invert(wlr_output->transform);
-  wlr_region_transform(&frame_damage, &damage_->current, transform, wlr_output->width, wlr_output->height);
+  wlr_region_transform(&frame_damage, &damage_->current, transform,
+    wlr_output->width, wlr_output->height);
+
+  // Whoever follows the damage hears about it before the pixels are read,
+  // which happens before the cursor is drawn so captures leave it out
+  on_damage.emit(&frame_damage);
+  read_captures(&frame_damage);
+
+  wlr_output_render_software_cursors(wlr_output, &buffer_damage);
+
+  if (mirror_readback_ && !mirrors_.empty()) {
+    read_mirror_pixels();
+  }
+
+  wlr_renderer_end(renderer_);
 
   wlr_output_set_damage(wlr_output, &frame_damage);
   pixman_region32_fini(&frame_damage);
 
+  // Mirrors only repaint what changed here, once the frame is committed
+  for (auto mirror : mirrors_) {
+    mirror->take_mirror_damage();
+  }
+
   wlr_output_commit(wlr_output);
 
   pixman_region32_fini(&buffer_damage);
@@ -482,11 +1806,34 @@ void Output::render(const std::vector<std::shared_ptr<View>>& views) const
   for (auto &view : render_list) {
     view->for_each_surface(send_frame_done, &now);
   }
+
+  // The rest of the overview gets its frames from the server's timer
+  if (overview_) {
+    auto slot = overview_slot(overview_hover_);
+    auto view = slot != nullptr ? slot->view.lock() : nullptr;
+    if (view) {
+      view->for_each_surface(send_frame_done, &now);
+    }
+  }
+
+  // Panels wait until they are visible again rather than redrawing unseen
+  if (fullscreen_view_ != nullptr) {
+    return;
+  }
+
+  for (auto &layer : layers_) {
+    for (auto layer_surface : layer) {
+      if (layer_surface->mapped) {
+        layer_surface->for_each_surface(send_frame_done, &now);
+      }
+    }
+  }
 }
 
 void Output::output_mode_notify(wl_listener *listener, void *data)
 {
   Output *output = wl_container_of(listener, output, mode_);
+  output->arrange_layers();
   output->on_mode.emit(output);
 }
 
@@ -499,20 +1846,28 @@ void Output::output_frame_notify(wl_listener *listener, void *data)
 void Output::output_destroy_notify(wl_listener *listener, void *data)
 {
   Output *output = wl_container_of(listener, output, destroy_);
+  output->mirror(nullptr);
+
+  for (auto mirror : output->mirrors_) {
+    mirror->mirror_source_ = nullptr;
+  }
+  output->mirrors_.clear();
+
+  output->fail_captures();
   output->on_destroy.emit(output);
 }
 
 int Output::x() const {
   auto box = wlr_output_layout_get_box(layout_, wlr_output);
-  return box->x;
+  return box != nullptr ? box->x : 0;
 }
 
 int Output::y() const {
   auto box = wlr_output_layout_get_box(layout_, wlr_output);
-  return box->y;
+  return box != nullptr ? box->y : 0;
 }
 
-void Output::set_scale(int scale)
+void Output::set_scale(float scale)
 {
   wlr_output_set_scale(wlr_output, scale);
 }
@@ -540,6 +1895,17 @@ void Output::add_layout(int x, int y)
   wlr_output_layout_add(layout_, wlr_output, x, y);
 }
 
+bool Output::update_layout(int x, int y)
+{
+  auto layout_output = wlr_output_layout_get(layout_, wlr_output);
+  if (layout_output != nullptr && layout_output->x == x && layout_output->y == y) {
+    return false;
+  }
+
+  add_layout(x, y);
+  return true;
+}
+
 void Output::lock_software_cursors()
 {
   if (software_cursors_) {
@@ -558,6 +1924,8 @@ void Output::unlock_software_cursors()
   software_cursors_ = false;
 }
 
+// Null while the output is out of the layout, when it's disconnected or
+// mirroring another output
 wlr_box* Output::box() const
 {
   return wlr_output_layout_get_box(layout_, wlr_output);
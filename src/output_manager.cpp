@@ -0,0 +1,206 @@
+#include "output_manager.h"
+
+#include <spdlog/spdlog.h>
+#include <wlroots.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "output.h"
+
+namespace lumin {
+
+OutputManager::OutputManager(wlr_output_manager_v1 *output_manager, wlr_output_layout *layout)
+  : output_manager_(output_manager)
+  , layout_(layout)
+  , applying_(false)
+{
+  apply.notify = apply_notify;
+  wl_signal_add(&output_manager_->events.apply, &apply);
+
+  test.notify = test_notify;
+  wl_signal_add(&output_manager_->events.test, &test);
+}
+
+void OutputManager::add_output(Output *output)
+{
+  output->on_configure.connect_member(this, &OutputManager::output_configured);
+  output->on_destroy.connect_member(this, &OutputManager::output_destroyed);
+  outputs_.push_back(output);
+  update();
+}
+
+void OutputManager::update()
+{
+  if (applying_) {
+    return;
+  }
+
+  wlr_output_manager_v1_set_configuration(output_manager_, current_configuration());
+}
+
+wlr_output_configuration_v1* OutputManager::current_configuration() const
+{
+  auto config = wlr_output_configuration_v1_create();
+
+  for (auto output : outputs_) {
+    auto head = wlr_output_configuration_head_v1_create(config, output->wlr_output);
+
+    auto layout_output = wlr_output_layout_get(layout_, output->wlr_output);
+    if (layout_output != nullptr) {
+      head->state.x = layout_output->x;
+      head->state.y = layout_output->y;
+    }
+  }
+
+  return config;
+}
+
+bool OutputManager::test_configuration(wlr_output_configuration_v1 *config) const
+{
+  wlr_output_configuration_head_v1 *head;
+  wl_list_for_each(head, &config->heads, link) {
+    auto &state = head->state;
+    auto name = state.output->name;
+
+    if (!state.enabled) {
+      continue;
+    }
+
+    if (state.scale <= 0) {
+      spdlog::debug("{} rejected scale {}", name, state.scale);
+      return false;
+    }
+
+    if (state.transform != WL_OUTPUT_TRANSFORM_NORMAL) {
+      spdlog::debug("{} rejected transform {}", name, state.transform);
+      return false;
+    }
+
+    if (state.mode != nullptr) {
+      continue;
+    }
+
+    // Custom modes only make sense for outputs without a fixed mode list,
+    // such as nested or headless outputs
+    bool has_modes = !wl_list_empty(&state.output->modes);
+    if (has_modes || state.custom_mode.width <= 0 || state.custom_mode.height <= 0) {
+      spdlog::debug("{} rejected custom mode {}x{}", name,
+        state.custom_mode.width, state.custom_mode.height);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool OutputManager::apply_head(const wlr_output_head_v1_state& state)
+{
+  auto output = static_cast<Output*>(state.output->data);
+
+  if (state.enabled && state.mode != nullptr) {
+    output->request_mode(OUTPUT_MODE_EXPLICIT, state.mode->width, state.mode->height,
+      state.mode->refresh);
+  } else if (state.enabled) {
+    output->request_mode(OUTPUT_MODE_EXPLICIT, state.custom_mode.width,
+      state.custom_mode.height, state.custom_mode.refresh);
+  }
+
+  return output->configure(state.scale, output->primary(), state.enabled,
+    state.x, state.y);
+}
+
+// A head the backend rejects puts every output touched so far, itself
+// included, back the way it was along with the mode it asked for, so the
+// configuration lands whole or not at all
+bool OutputManager::apply_configuration(wlr_output_configuration_v1 *config)
+{
+  applying_ = true;
+
+  auto previous = current_configuration();
+  std::vector<std::pair<Output*, OutputModeRequest>> touched;
+  bool succeeded = true;
+
+  wlr_output_configuration_head_v1 *head;
+  wl_list_for_each(head, &config->heads, link) {
+    auto output = static_cast<Output*>(head->state.output->data);
+    touched.emplace_back(output, output->requested_mode());
+
+    if (!apply_head(head->state)) {
+      spdlog::error("{} rejected the new configuration", head->state.output->name);
+      succeeded = false;
+      break;
+    }
+  }
+
+  if (!succeeded) {
+    wl_list_for_each(head, &previous->heads, link) {
+      auto &state = head->state;
+      auto output = static_cast<Output*>(state.output->data);
+
+      auto saved = std::find_if(touched.begin(), touched.end(),
+        [output](const auto& entry) { return entry.first == output; });
+      if (saved == touched.end()) {
+        continue;
+      }
+
+      auto &mode = saved->second;
+      output->request_mode(mode.policy, mode.width, mode.height, mode.refresh);
+
+      if (!output->configure(state.scale, output->primary(), state.enabled, state.x, state.y)) {
+        spdlog::error("Failed to restore the configuration of {}", state.output->name);
+      }
+    }
+  }
+
+  wlr_output_configuration_v1_destroy(previous);
+
+  applying_ = false;
+
+  update();
+  return succeeded;
+}
+
+void OutputManager::output_configured(Output *output)
+{
+  update();
+}
+
+void OutputManager::output_destroyed(Output *output)
+{
+  std::erase(outputs_, output);
+  update();
+}
+
+void OutputManager::apply_notify(wl_listener *listener, void *data)
+{
+  OutputManager *manager = wl_container_of(listener, manager, apply);
+  auto config = static_cast<wlr_output_configuration_v1*>(data);
+
+  // Every head is validated before any output is touched so that a bad
+  // head can't leave the outputs half configured
+  if (manager->test_configuration(config) && manager->apply_configuration(config)) {
+    wlr_output_configuration_v1_send_succeeded(config);
+  } else {
+    wlr_output_configuration_v1_send_failed(config);
+  }
+
+  wlr_output_configuration_v1_destroy(config);
+}
+
+void OutputManager::test_notify(wl_listener *listener, void *data)
+{
+  OutputManager *manager = wl_container_of(listener, manager, test);
+  auto config = static_cast<wlr_output_configuration_v1*>(data);
+
+  if (manager->test_configuration(config)) {
+    wlr_output_configuration_v1_send_succeeded(config);
+  } else {
+    wlr_output_configuration_v1_send_failed(config);
+  }
+
+  wlr_output_configuration_v1_destroy(config);
+}
+
+}  // namespace lumin
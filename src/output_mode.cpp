@@ -0,0 +1,74 @@
+#include "output_mode.h"
+
+#include <stdlib.h>
+
+namespace lumin {
+
+static int preferred_mode(const std::vector<OutputMode>& modes)
+{
+  for (size_t i = 0; i < modes.size(); i++) {
+    if (modes[i].preferred) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+static int highest_refresh_mode(const std::vector<OutputMode>& modes, int width, int height)
+{
+  int result = -1;
+  for (size_t i = 0; i < modes.size(); i++) {
+    if (modes[i].width != width || modes[i].height != height) {
+      continue;
+    }
+    if (result < 0 || modes[i].refresh > modes[result].refresh) {
+      result = i;
+    }
+  }
+  return result;
+}
+
+static int closest_refresh_mode(const std::vector<OutputMode>& modes,
+  int width, int height, int refresh)
+{
+  int result = -1;
+  for (size_t i = 0; i < modes.size(); i++) {
+    if (modes[i].width != width || modes[i].height != height) {
+      continue;
+    }
+    // Panels advertise rates like 143.998Hz for a nominal 144Hz
+    if (result < 0 || abs(modes[i].refresh - refresh) < abs(modes[result].refresh - refresh)) {
+      result = i;
+    }
+  }
+  return result;
+}
+
+int select_output_mode(const std::vector<OutputMode>& modes, OutputModePolicy policy,
+  int width, int height, int refresh)
+{
+  if (modes.empty()) {
+    return -1;
+  }
+
+  int preferred = preferred_mode(modes);
+
+  switch (policy) {
+    case OUTPUT_MODE_HIGHEST_REFRESH: {
+      auto &native = modes[preferred];
+      return highest_refresh_mode(modes, native.width, native.height);
+    }
+    case OUTPUT_MODE_EXPLICIT: {
+      int result = refresh > 0
+        ? closest_refresh_mode(modes, width, height, refresh)
+        : highest_refresh_mode(modes, width, height);
+      return result < 0 ? preferred : result;
+    }
+    case OUTPUT_MODE_PREFERRED:
+      break;
+  }
+
+  return preferred;
+}
+
+}  // namespace lumin
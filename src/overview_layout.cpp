@@ -0,0 +1,69 @@
+#include "overview_layout.h"
+
+#include <wlroots.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace lumin {
+
+// Picks as many columns as make cells about the shape of the windows
+// themselves, so the grid fills the area rather than one side of it
+static int overview_columns(const wlr_box *area, const std::vector<wlr_box>& sizes)
+{
+  double window_aspect = 0;
+  for (auto &size : sizes) {
+    window_aspect += static_cast<double>(std::max(size.width, 1)) / std::max(size.height, 1);
+  }
+  window_aspect /= sizes.size();
+
+  double area_aspect = static_cast<double>(area->width) / area->height;
+  int columns = std::ceil(std::sqrt(sizes.size() * area_aspect / window_aspect));
+  return std::clamp(columns, 1, static_cast<int>(sizes.size()));
+}
+
+void overview_layout(const wlr_box *area, int gap, const std::vector<wlr_box>& sizes,
+  std::vector<wlr_box> *boxes)
+{
+  boxes->clear();
+  if (sizes.empty() || area->width <= 0 || area->height <= 0) {
+    return;
+  }
+
+  int count = sizes.size();
+  int columns = overview_columns(area, sizes);
+  int rows = (count + columns - 1) / columns;
+
+  int cell_width = std::max(1, (area->width - gap * (columns + 1)) / columns);
+  int cell_height = std::max(1, (area->height - gap * (rows + 1)) / rows);
+
+  for (int i = 0; i < count; ++i) {
+    int row = i / columns;
+    int column = i % columns;
+
+    // The last row is centered when it isn't full
+    int row_columns = std::min(columns, count - row * columns);
+    int row_offset = (columns - row_columns) * (cell_width + gap) / 2;
+
+    auto &size = sizes[i];
+    double scale = std::min({ 1.0,
+      static_cast<double>(cell_width) / std::max(size.width, 1),
+      static_cast<double>(cell_height) / std::max(size.height, 1) });
+
+    int width = std::max(1, static_cast<int>(std::round(size.width * scale)));
+    int height = std::max(1, static_cast<int>(std::round(size.height * scale)));
+
+    int cell_x = area->x + gap + row_offset + column * (cell_width + gap);
+    int cell_y = area->y + gap + row * (cell_height + gap);
+
+    wlr_box box = {
+      .x = cell_x + (cell_width - width) / 2,
+      .y = cell_y + (cell_height - height) / 2,
+      .width = width,
+      .height = height
+    };
+    boxes->push_back(box);
+  }
+}
+
+}  // namespace lumin
@@ -1,8 +1,15 @@
 #include "posix_os.h"
 
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <unistd.h>
 
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -13,6 +20,13 @@ using std::filesystem::path;
 
 namespace lumin {
 
+PosixOS::~PosixOS()
+{
+  for (auto &watch : watches_) {
+    stop_watch(watch.get());
+  }
+}
+
 void PosixOS::set_env(const std::string& name, const std::string& value)
 {
   setenv(name.c_str(), value.c_str(), true);
@@ -39,4 +53,105 @@ void PosixOS::execute(const std::string& command)
   }
 }
 
+int PosixOS::watch_file(const std::string& filepath, const std::function<void()>& on_change)
+{
+  path file_path(filepath);
+
+  int inotify_fd = inotify_init1(IN_CLOEXEC);
+  if (inotify_fd < 0) {
+    spdlog::error("Failed to create inotify instance for {}", filepath);
+    return -1;
+  }
+
+  // Watch the directory so that editors replacing the file are noticed
+  uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+  std::string directory = file_path.parent_path().string();
+  if (inotify_add_watch(inotify_fd, directory.c_str(), mask) < 0) {
+    spdlog::warn("Failed to watch {}", directory);
+    close(inotify_fd);
+    return -1;
+  }
+
+  int stop_fd = eventfd(0, EFD_CLOEXEC);
+  if (stop_fd < 0) {
+    spdlog::error("Failed to create eventfd for {}", filepath);
+    close(inotify_fd);
+    return -1;
+  }
+
+  auto watch = std::make_unique<FileWatch>();
+  watch->id = next_watch_id_++;
+  watch->inotify_fd = inotify_fd;
+  watch->stop_fd = stop_fd;
+  watch->thread = std::thread(&PosixOS::watch_thread, inotify_fd, stop_fd,
+    file_path.filename().string(), on_change);
+  int id = watch->id;
+  watches_.push_back(std::move(watch));
+  return id;
+}
+
+// Once this returns the watch's callback is never called again
+void PosixOS::unwatch_file(int watch)
+{
+  auto result = std::find_if(watches_.begin(), watches_.end(), [watch](auto &el) {
+    return el->id == watch;
+  });
+  if (result == watches_.end()) {
+    return;
+  }
+
+  stop_watch(result->get());
+  watches_.erase(result);
+}
+
+void PosixOS::stop_watch(FileWatch *watch)
+{
+  eventfd_write(watch->stop_fd, 1);
+  watch->thread.join();
+  close(watch->inotify_fd);
+  close(watch->stop_fd);
+}
+
+void PosixOS::watch_thread(int inotify_fd, int stop_fd, const std::string& filename,
+  const std::function<void()>& on_change)
+{
+  alignas(inotify_event) char buffer[4096];
+
+  pollfd fds[2] = {
+    { .fd = inotify_fd, .events = POLLIN, .revents = 0 },
+    { .fd = stop_fd, .events = POLLIN, .revents = 0 }
+  };
+
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      return;
+    }
+
+    ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+    if (length <= 0) {
+      continue;
+    }
+
+    bool changed = false;
+    for (char *ptr = buffer; ptr < buffer + length;) {
+      auto event = reinterpret_cast<inotify_event*>(ptr);
+      if (event->len > 0 && filename == event->name) {
+        changed = true;
+      }
+      ptr += sizeof(inotify_event) + event->len;
+    }
+
+    if (changed) {
+      on_change();
+    }
+  }
+}
+
 }  // namespace lumin
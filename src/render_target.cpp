@@ -0,0 +1,114 @@
+#include "render_target.h"
+
+#include <wlroots.h>
+#include <GLES2/gl2.h>
+#include <spdlog/spdlog.h>
+
+#include <vector>
+
+namespace lumin {
+
+RenderTarget::~RenderTarget()
+{
+  destroy();
+}
+
+RenderTarget::RenderTarget()
+  : texture_(nullptr)
+  , framebuffer_(0)
+  , previous_framebuffer_(0)
+  , width_(0)
+  , height_(0)
+{
+
+}
+
+wlr_texture* RenderTarget::texture() const
+{
+  return texture_;
+}
+
+int RenderTarget::width() const
+{
+  return width_;
+}
+
+int RenderTarget::height() const
+{
+  return height_;
+}
+
+void RenderTarget::destroy()
+{
+  // Destroying the texture makes the renderer's context current again
+  if (texture_ != nullptr) {
+    wlr_texture_destroy(texture_);
+    texture_ = nullptr;
+  }
+
+  if (framebuffer_ != 0) {
+    glDeleteFramebuffers(1, &framebuffer_);
+    framebuffer_ = 0;
+  }
+
+  width_ = 0;
+  height_ = 0;
+}
+
+bool RenderTarget::resize(wlr_renderer *renderer, int width, int height)
+{
+  if (texture_ != nullptr && width == width_ && height == height_) {
+    return true;
+  }
+
+  destroy();
+
+  std::vector<uint32_t> pixels(static_cast<size_t>(width) * height, 0);
+  texture_ = wlr_texture_from_pixels(renderer, WL_SHM_FORMAT_ARGB8888, width * 4,
+    width, height, pixels.data());
+
+  if (texture_ == nullptr || !wlr_texture_is_gles2(texture_)) {
+    spdlog::warn("Offscreen rendering needs a GLES2 texture");
+    destroy();
+    return false;
+  }
+
+  wlr_gles2_texture_attribs attribs;
+  wlr_gles2_texture_get_attribs(texture_, &attribs);
+
+  GLint previous = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+
+  glGenFramebuffers(1, &framebuffer_);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, attribs.target, attribs.tex, 0);
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    spdlog::warn("Offscreen texture can't be drawn to");
+    destroy();
+    return false;
+  }
+
+  width_ = width;
+  height_ = height;
+  return true;
+}
+
+void RenderTarget::bind()
+{
+  GLint previous = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+  previous_framebuffer_ = previous;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void RenderTarget::unbind()
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer_);
+}
+
+}  // namespace lumin
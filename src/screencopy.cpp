@@ -0,0 +1,502 @@
+#include "screencopy.h"
+
+#include <spdlog/spdlog.h>
+#include <wlroots.h>
+#include <wayland-server.h>
+#include <wlr-screencopy-unstable-v1-protocol.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include "output.h"
+
+const int SCREENCOPY_VERSION = 2;
+
+namespace lumin {
+
+struct ScreencopyFrame {
+  ScreencopyManager *manager;
+  wl_resource *resource;
+  wl_resource *manager_resource;  // null once the client has destroyed it
+  Output *output;
+  bool whole_output;
+  wlr_box box;   // in layout coordinates, unless the whole output
+  wlr_box area;  // in the output's buffer
+  wl_resource *buffer;
+  bool used;
+  bool with_damage;
+};
+
+// A client buffer frames have been copied into. What the output changed
+// since its last copy is kept, so the next damage-aware copy into it only
+// writes that.
+struct ScreencopyBuffer {
+  ScreencopyManager *manager;
+  wl_resource *resource;
+  wl_listener destroy;
+  Output *output;
+  wlr_box area;
+  bool written;
+  pixman_region32_t stale;
+};
+
+// What changed on an output since a client's manager last copied from
+// it, reported to it with damage events
+struct ScreencopyDamage {
+  pixman_region32_t region;
+};
+
+static bool same_area(const wlr_box& a, const wlr_box& b)
+{
+  return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static void frame_copy(wl_client *client, wl_resource *resource, wl_resource *buffer)
+{
+  auto frame = static_cast<ScreencopyFrame*>(wl_resource_get_user_data(resource));
+  frame->manager->copy(frame, buffer, false);
+}
+
+static void frame_copy_with_damage(wl_client *client, wl_resource *resource, wl_resource *buffer)
+{
+  auto frame = static_cast<ScreencopyFrame*>(wl_resource_get_user_data(resource));
+  frame->manager->copy(frame, buffer, true);
+}
+
+static void frame_destroy(wl_client *client, wl_resource *resource)
+{
+  wl_resource_destroy(resource);
+}
+
+static const struct zwlr_screencopy_frame_v1_interface frame_impl = {
+  .copy = frame_copy,
+  .destroy = frame_destroy,
+  .copy_with_damage = frame_copy_with_damage
+};
+
+static void frame_resource_destroy(wl_resource *resource)
+{
+  auto frame = static_cast<ScreencopyFrame*>(wl_resource_get_user_data(resource));
+  frame->manager->frame_destroyed(frame);
+}
+
+static void capture_output(wl_client *client, wl_resource *resource, uint32_t id,
+  int32_t overlay_cursor, wl_resource *output)
+{
+  auto manager = static_cast<ScreencopyManager*>(wl_resource_get_user_data(resource));
+  manager->capture_output(resource, id, output, nullptr);
+}
+
+static void capture_output_region(wl_client *client, wl_resource *resource, uint32_t id,
+  int32_t overlay_cursor, wl_resource *output, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+  auto manager = static_cast<ScreencopyManager*>(wl_resource_get_user_data(resource));
+  wlr_box box = { .x = x, .y = y, .width = width, .height = height };
+  manager->capture_output(resource, id, output, &box);
+}
+
+static void manager_destroy(wl_client *client, wl_resource *resource)
+{
+  wl_resource_destroy(resource);
+}
+
+static const struct zwlr_screencopy_manager_v1_interface manager_impl = {
+  .capture_output = capture_output,
+  .capture_output_region = capture_output_region,
+  .destroy = manager_destroy
+};
+
+static void manager_resource_destroy(wl_resource *resource)
+{
+  auto manager = static_cast<ScreencopyManager*>(wl_resource_get_user_data(resource));
+  manager->manager_destroyed(resource);
+}
+
+static void manager_bind(wl_client *client, void *data, uint32_t version, uint32_t id)
+{
+  wl_resource *resource = wl_resource_create(client, &zwlr_screencopy_manager_v1_interface,
+    version, id);
+  if (resource == nullptr) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+  wl_resource_set_implementation(resource, &manager_impl, data, manager_resource_destroy);
+}
+
+static void buffer_destroy_notify(wl_listener *listener, void *data)
+{
+  ScreencopyBuffer *buffer = wl_container_of(listener, buffer, destroy);
+  buffer->manager->buffer_destroyed(buffer);
+}
+
+ScreencopyManager::ScreencopyManager(wl_display *display, wlr_output_layout *layout)
+  : layout_(layout)
+{
+  global_ = wl_global_create(display, &zwlr_screencopy_manager_v1_interface,
+    SCREENCOPY_VERSION, this, manager_bind);
+}
+
+ScreencopyManager::~ScreencopyManager()
+{
+  for (auto &el : buffers_) {
+    wl_list_remove(&el.second->destroy.link);
+    pixman_region32_fini(&el.second->stale);
+  }
+
+  for (auto &el : damage_) {
+    pixman_region32_fini(&el.second->region);
+  }
+}
+
+void ScreencopyManager::add_output(Output *output)
+{
+  output->on_damage.connect([this, output](const pixman_region32_t *damage) {
+    output_damaged(output, damage);
+  });
+  output->on_destroy.connect_member(this, &ScreencopyManager::output_destroyed);
+}
+
+void ScreencopyManager::capture_output(wl_resource *manager, uint32_t id,
+  wl_resource *output_resource, const wlr_box *box)
+{
+  auto client = wl_resource_get_client(manager);
+  auto resource = wl_resource_create(client, &zwlr_screencopy_frame_v1_interface,
+    wl_resource_get_version(manager), id);
+
+  if (resource == nullptr) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  auto frame = std::make_shared<ScreencopyFrame>();
+  frame->manager = this;
+  frame->resource = resource;
+  frame->manager_resource = manager;
+  frame->output = nullptr;
+  frame->whole_output = box == nullptr;
+  frame->box = {};
+  frame->area = {};
+  frame->buffer = nullptr;
+  frame->used = false;
+  frame->with_damage = false;
+
+  wl_resource_set_implementation(resource, &frame_impl, frame.get(), frame_resource_destroy);
+  frames_.push_back(frame);
+
+  auto wlr_output = wlr_output_from_resource(output_resource);
+  if (wlr_output == nullptr || wlr_output->data == nullptr) {
+    zwlr_screencopy_frame_v1_send_failed(resource);
+    return;
+  }
+
+  auto output = static_cast<Output*>(wlr_output->data);
+
+  // The region comes relative to the output, captures take layout coordinates
+  if (box != nullptr) {
+    frame->box = *box;
+    auto layout_box = wlr_output_layout_get_box(layout_, wlr_output);
+    if (layout_box != nullptr) {
+      frame->box.x += layout_box->x;
+      frame->box.y += layout_box->y;
+    }
+  }
+
+  if (!output->buffer_area(frame->whole_output ? nullptr : &frame->box, &frame->area)) {
+    zwlr_screencopy_frame_v1_send_failed(resource);
+    return;
+  }
+
+  frame->output = output;
+  zwlr_screencopy_frame_v1_send_buffer(resource, WL_SHM_FORMAT_XRGB8888,
+    frame->area.width, frame->area.height, frame->area.width * 4);
+}
+
+void ScreencopyManager::copy(ScreencopyFrame *frame, wl_resource *buffer, bool with_damage)
+{
+  if (frame->used) {
+    wl_resource_post_error(frame->resource, ZWLR_SCREENCOPY_FRAME_V1_ERROR_ALREADY_USED,
+      "frame already used");
+    return;
+  }
+
+  auto shm_buffer = wl_shm_buffer_get(buffer);
+  if (shm_buffer == nullptr) {
+    wl_resource_post_error(frame->resource, ZWLR_SCREENCOPY_FRAME_V1_ERROR_INVALID_BUFFER,
+      "unsupported buffer type");
+    return;
+  }
+
+  auto format = wl_shm_buffer_get_format(shm_buffer);
+  if (format != WL_SHM_FORMAT_XRGB8888 && format != WL_SHM_FORMAT_ARGB8888) {
+    wl_resource_post_error(frame->resource, ZWLR_SCREENCOPY_FRAME_V1_ERROR_INVALID_BUFFER,
+      "unsupported buffer format");
+    return;
+  }
+
+  if (wl_shm_buffer_get_width(shm_buffer) != frame->area.width ||
+      wl_shm_buffer_get_height(shm_buffer) != frame->area.height ||
+      wl_shm_buffer_get_stride(shm_buffer) < frame->area.width * 4) {
+    wl_resource_post_error(frame->resource, ZWLR_SCREENCOPY_FRAME_V1_ERROR_INVALID_BUFFER,
+      "invalid buffer attributes");
+    return;
+  }
+
+  frame->used = true;
+
+  if (frame->output == nullptr) {
+    zwlr_screencopy_frame_v1_send_failed(frame->resource);
+    return;
+  }
+
+  frame->buffer = buffer;
+  frame->with_damage = with_damage;
+  buffer_for(frame);
+
+  auto it = std::find_if(frames_.begin(), frames_.end(), [frame](auto &el) {
+    return el.get() == frame;
+  });
+  std::weak_ptr<ScreencopyFrame> weak_frame = *it;
+
+  auto done = [this, weak_frame](CapturedFrame&& pixels) {
+    auto frame = weak_frame.lock();
+    if (frame) {
+      frame_captured(frame.get(), std::move(pixels));
+    }
+  };
+
+  const wlr_box *box = frame->whole_output ? nullptr : &frame->box;
+
+  // Without anything new to copy the frame waits for the output to change
+  // instead of asking it for one
+  bool changed = true;
+  auto damage = with_damage ? damage_for(frame) : nullptr;
+  if (damage != nullptr) {
+    pixman_box32_t area = { frame->area.x, frame->area.y,
+      frame->area.x + frame->area.width, frame->area.y + frame->area.height };
+    changed = pixman_region32_contains_rectangle(&damage->region, &area) != PIXMAN_REGION_OUT;
+  }
+
+  bool queued = changed ? frame->output->capture(box, done) :
+    frame->output->capture_damage(box, done);
+  if (!queued) {
+    zwlr_screencopy_frame_v1_send_failed(frame->resource);
+  }
+}
+
+void ScreencopyManager::frame_captured(ScreencopyFrame *frame, CapturedFrame&& pixels)
+{
+  // Already failed when the buffer went away first
+  if (frame->buffer == nullptr) {
+    return;
+  }
+
+  // The mode can change between the buffer event and the capture, and
+  // the output may have gone before it had a frame to read
+  if (pixels.pixels == nullptr || pixels.width != frame->area.width ||
+      pixels.height != frame->area.height) {
+    zwlr_screencopy_frame_v1_send_failed(frame->resource);
+    frame->buffer = nullptr;
+    return;
+  }
+
+  copy_pixels(frame, pixels, wl_shm_buffer_get(frame->buffer));
+  zwlr_screencopy_frame_v1_send_flags(frame->resource, 0);
+
+  auto damage = damage_for(frame);
+  if (damage != nullptr) {
+    if (frame->with_damage) {
+      pixman_region32_t region;
+      pixman_region32_init(&region);
+      pixman_region32_intersect_rect(&region, &damage->region,
+        frame->area.x, frame->area.y, frame->area.width, frame->area.height);
+
+      int nrects;
+      pixman_box32_t *rects = pixman_region32_rectangles(&region, &nrects);
+      for (int i = 0; i < nrects; ++i) {
+        zwlr_screencopy_frame_v1_send_damage(frame->resource,
+          rects[i].x1 - frame->area.x, rects[i].y1 - frame->area.y,
+          rects[i].x2 - rects[i].x1, rects[i].y2 - rects[i].y1);
+      }
+      pixman_region32_fini(&region);
+    }
+
+    pixman_region32_clear(&damage->region);
+  }
+
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t seconds = now.tv_sec;
+  zwlr_screencopy_frame_v1_send_ready(frame->resource, seconds >> 32, seconds & 0xffffffff,
+    now.tv_nsec);
+
+  frame->buffer = nullptr;
+}
+
+// The pixels come from a readback shared with every other capture of the
+// frame, the client's buffer gets its own part of it. A buffer whose
+// owner follows the damage keeps what it held last time, so only what
+// changed since is written into it.
+void ScreencopyManager::copy_pixels(ScreencopyFrame *frame, const CapturedFrame& pixels,
+  wl_shm_buffer *shm_buffer)
+{
+  auto buffer = buffer_for(frame);
+  auto &area = frame->area;
+
+  pixman_region32_t region;
+  pixman_region32_init_rect(&region, area.x, area.y, area.width, area.height);
+  if (frame->with_damage && buffer->written) {
+    pixman_region32_intersect(&region, &region, &buffer->stale);
+  }
+
+  int stride = wl_shm_buffer_get_stride(shm_buffer);
+  wl_shm_buffer_begin_access(shm_buffer);
+  auto data = static_cast<uint8_t*>(wl_shm_buffer_get_data(shm_buffer));
+
+  int nrects;
+  pixman_box32_t *rects = pixman_region32_rectangles(&region, &nrects);
+  for (int i = 0; i < nrects; ++i) {
+    int x = rects[i].x1 - area.x;
+    int size = (rects[i].x2 - rects[i].x1) * 4;
+    for (int y = rects[i].y1 - area.y; y < rects[i].y2 - area.y; ++y) {
+      memcpy(data + y * stride + x * 4, pixels.row(y) + x * 4, size);
+    }
+  }
+
+  wl_shm_buffer_end_access(shm_buffer);
+  pixman_region32_fini(&region);
+
+  buffer->written = true;
+  pixman_region32_clear(&buffer->stale);
+}
+
+ScreencopyBuffer* ScreencopyManager::buffer_for(ScreencopyFrame *frame)
+{
+  auto &buffer = buffers_[frame->buffer];
+  if (!buffer) {
+    buffer = std::make_unique<ScreencopyBuffer>();
+    buffer->manager = this;
+    buffer->resource = frame->buffer;
+    buffer->destroy.notify = buffer_destroy_notify;
+    wl_resource_add_destroy_listener(frame->buffer, &buffer->destroy);
+    buffer->output = frame->output;
+    buffer->area = frame->area;
+    buffer->written = false;
+    pixman_region32_init(&buffer->stale);
+  }
+
+  // What it holds is of no use for another part of the screen
+  if (buffer->output != frame->output || !same_area(buffer->area, frame->area)) {
+    buffer->output = frame->output;
+    buffer->area = frame->area;
+    buffer->written = false;
+    pixman_region32_clear(&buffer->stale);
+  }
+
+  return buffer.get();
+}
+
+ScreencopyDamage* ScreencopyManager::damage_for(ScreencopyFrame *frame)
+{
+  if (frame->manager_resource == nullptr || frame->output == nullptr) {
+    return nullptr;
+  }
+
+  // A manager's first copy reports all of it as changed
+  auto &damage = damage_[std::make_pair(frame->manager_resource, frame->output)];
+  if (!damage) {
+    damage = std::make_unique<ScreencopyDamage>();
+    pixman_region32_init_rect(&damage->region, frame->area.x, frame->area.y,
+      frame->area.width, frame->area.height);
+  }
+  return damage.get();
+}
+
+void ScreencopyManager::output_damaged(Output *output, const pixman_region32_t *damage)
+{
+  auto region = const_cast<pixman_region32_t*>(damage);
+
+  for (auto &el : damage_) {
+    if (el.first.second == output) {
+      pixman_region32_union(&el.second->region, &el.second->region, region);
+    }
+  }
+
+  for (auto &el : buffers_) {
+    if (el.second->output == output) {
+      pixman_region32_union(&el.second->stale, &el.second->stale, region);
+    }
+  }
+}
+
+void ScreencopyManager::output_destroyed(Output *output)
+{
+  for (auto &frame : frames_) {
+    if (frame->output != output) {
+      continue;
+    }
+
+    if (frame->buffer != nullptr) {
+      zwlr_screencopy_frame_v1_send_failed(frame->resource);
+      frame->buffer = nullptr;
+    }
+    frame->output = nullptr;
+  }
+
+  for (auto it = damage_.begin(); it != damage_.end();) {
+    if (it->first.second == output) {
+      pixman_region32_fini(&it->second->region);
+      it = damage_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto &el : buffers_) {
+    if (el.second->output == output) {
+      el.second->output = nullptr;
+      el.second->written = false;
+    }
+  }
+}
+
+void ScreencopyManager::manager_destroyed(wl_resource *manager)
+{
+  for (auto &frame : frames_) {
+    if (frame->manager_resource == manager) {
+      frame->manager_resource = nullptr;
+    }
+  }
+
+  for (auto it = damage_.begin(); it != damage_.end();) {
+    if (it->first.first == manager) {
+      pixman_region32_fini(&it->second->region);
+      it = damage_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ScreencopyManager::frame_destroyed(ScreencopyFrame *frame)
+{
+  std::erase_if(frames_, [frame](auto &el) {
+    return el.get() == frame;
+  });
+}
+
+void ScreencopyManager::buffer_destroyed(ScreencopyBuffer *buffer)
+{
+  for (auto &frame : frames_) {
+    if (frame->buffer == buffer->resource) {
+      zwlr_screencopy_frame_v1_send_failed(frame->resource);
+      frame->buffer = nullptr;
+    }
+  }
+
+  wl_list_remove(&buffer->destroy.link);
+  pixman_region32_fini(&buffer->stale);
+  buffers_.erase(buffer->resource);
+}
+
+}  // namespace lumin
@@ -0,0 +1,95 @@
+#include "screenshot_writer.h"
+
+#include <spdlog/spdlog.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "image_encoder.h"
+
+namespace lumin {
+
+ScreenshotWriter::~ScreenshotWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  wake_.notify_one();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+ScreenshotWriter::ScreenshotWriter()
+  : quit_(false)
+{
+
+}
+
+void ScreenshotWriter::write(CapturedFrame&& frame, const std::string& path)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back({ .frame = std::move(frame), .path = path });
+  }
+  wake_.notify_one();
+
+  if (!thread_.joinable()) {
+    thread_ = std::thread(&ScreenshotWriter::run, this);
+  }
+}
+
+void ScreenshotWriter::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return quit_ || !jobs_.empty(); });
+    if (jobs_.empty()) {
+      return;
+    }
+
+    Job job = std::move(jobs_.front());
+    jobs_.pop_front();
+
+    lock.unlock();
+    if (save(job)) {
+      spdlog::info("Saved screenshot to {}", job.path);
+    }
+    lock.lock();
+  }
+}
+
+// Written next to the destination and renamed into place, so nothing
+// watching the directory sees a half written image
+bool ScreenshotWriter::save(const Job& job)
+{
+  std::vector<uint8_t> data;
+  if (!encode_image(job.frame, image_format_from_path(job.path), &data)) {
+    spdlog::error("Unable to encode screenshot {}", job.path);
+    return false;
+  }
+
+  std::string partial_path = job.path + ".part";
+  std::ofstream file(partial_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(data.data()), data.size());
+  file.close();
+
+  if (!file) {
+    spdlog::error("Unable to write screenshot {}", job.path);
+    std::remove(partial_path.c_str());
+    return false;
+  }
+
+  if (std::rename(partial_path.c_str(), job.path.c_str()) != 0) {
+    spdlog::error("Unable to move screenshot into place at {}", job.path);
+    std::remove(partial_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace lumin
@@ -1,15 +1,20 @@
 #include "server.h"
 
 #include <linux/input-event-codes.h>
+#include <unistd.h>
 #include <wlroots.h>
 #include <xkbcommon/xkbcommon.h>
 
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <vector>
 
 #include "wlroots_platform.h"
@@ -17,19 +22,49 @@
 
 #include "cursor.h"
 #include "keyboard.h"
+#include "layer_surface.h"
 #include "output.h"
+#include "screenshot_writer.h"
 #include "seat.h"
+#include "transaction.h"
 #include "dbus/adapters/compositor.h"
+#include "workspace.h"
 #include "xdg_view.h"
 
 #include "key_binding.h"
 #include "display_config.h"
+#include "shortcut_config.h"
+#include "virtual_output_config.h"
+#include "xwayland_config.h"
+
+// Views on hidden workspaces still get the odd frame callback so that
+// clients don't stall, just far less often than the display refreshes
+const int WORKSPACE_COUNT = 4;
+const int HIDDEN_FRAME_INTERVAL_MS = 1000;
+
+// Damaged thumbnails wait for the next frame on any output, or this long
+// when nothing else is being drawn
+const int THUMBNAIL_FRAME_INTERVAL_MS = 500;
+
+// Windows in the overview other than the hovered one redraw at this pace,
+// so dozens of clients aren't all committing every frame
+const int OVERVIEW_FRAME_INTERVAL_MS = 100;
+
+const int MAP_ANIMATION_MS = 150;
+const int MINIMIZE_ANIMATION_MS = 200;
+const int CONFIGURE_ANIMATION_MS = 200;
+const int DEFAULT_FRAME_MS = 16;
 
 namespace lumin {
 
 Server::~Server() {}
 
 Server::Server()
+  : hidden_frame_timer_(nullptr)
+  , overview_(false)
+  , overview_frame_timer_(nullptr)
+  , thumbnail_timer_(nullptr)
+  , screenshot_writer_(std::make_shared<ScreenshotWriter>())
 {
   platform_ = std::make_shared<WlRootsPlatform>();
   os_ = std::make_shared<PosixOS>();
@@ -42,7 +77,12 @@ Server::Server(
   const std::shared_ptr<IDisplayConfig>& display_config,
   const std::shared_ptr<ICursor>& cursor
 )
-  : platform_(platform)
+  : hidden_frame_timer_(nullptr)
+  , overview_(false)
+  , overview_frame_timer_(nullptr)
+  , thumbnail_timer_(nullptr)
+  , screenshot_writer_(std::make_shared<ScreenshotWriter>())
+  , platform_(platform)
   , os_(os)
   , display_config_(display_config)
   , cursor_(cursor)
@@ -67,6 +107,60 @@ std::vector<std::shared_ptr<View>> filter_mapped_views(const std::vector<std::sh
   return filtered_views;
 }
 
+// The launcher and the shell belong to the desktop rather than to one
+// workspace, so they're shown whichever workspace is active
+static bool follows_workspaces(const View *view)
+{
+  return view->layer() == VIEW_LAYER_TOP && !view->is_shell();
+}
+
+// Where the view lives, which is where it's drawn when not animating
+static ViewTransform real_transform(const View *view)
+{
+  wlr_box geometry;
+  view->geometry(&geometry);
+
+  ViewTransform transform = {
+    .x = view->x,
+    .y = view->y,
+    .width = static_cast<double>(geometry.width),
+    .height = static_cast<double>(geometry.height),
+    .alpha = 1.0f
+  };
+  return transform;
+}
+
+static ViewTransform current_transform(const View *view)
+{
+  return view->animating ? view->animation : real_transform(view);
+}
+
+static ViewTransform shrunk_transform(const ViewTransform& transform, double scale)
+{
+  ViewTransform shrunk = {
+    .x = transform.x + transform.width * (1.0 - scale) / 2,
+    .y = transform.y + transform.height * (1.0 - scale) / 2,
+    .width = transform.width * scale,
+    .height = transform.height * scale,
+    .alpha = 0.0f
+  };
+  return shrunk;
+}
+
+static void add_surface_bounds(wlr_surface *surface, int sx, int sy, void *data)
+{
+  auto bounds = static_cast<wlr_box*>(data);
+  int left = std::min(bounds->x, sx);
+  int top = std::min(bounds->y, sy);
+  int right = std::max(bounds->x + bounds->width, sx + surface->current.width);
+  int bottom = std::max(bounds->y + bounds->height, sy + surface->current.height);
+
+  bounds->x = left;
+  bounds->y = top;
+  bounds->width = right - left;
+  bounds->height = bottom - top;
+}
+
 void Server::quit()
 {
   platform_->terminate();
@@ -90,6 +184,194 @@ std::vector<std::string> Server::apps() const
   return apps;
 }
 
+// The thumbnail starts out dirty and is drawn by the next output frame,
+// until then it reads as empty
+bool Server::thumbnail(const std::string& app_id, ThumbnailBuffer *buffer)
+{
+  auto mapped_views = filter_mapped_views(views_);
+  auto condition = [app_id](auto &el) { return el->is_root() && el->id() == app_id; };
+  auto result = std::find_if(mapped_views.begin(), mapped_views.end(), condition);
+  if (result == mapped_views.end()) {
+    return false;
+  }
+  auto view = (*result).get();
+
+  auto it = thumbnails_.find(view);
+  if (it == thumbnails_.end()) {
+    auto thumbnail = std::make_shared<Thumbnail>(view);
+    if (!thumbnail->init()) {
+      return false;
+    }
+    thumbnail->on_render.connect_member(this, &Server::thumbnail_rendered);
+    it = thumbnails_.emplace(view, thumbnail).first;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  it->second->request(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+
+  *buffer = it->second->buffer();
+  buffer->fd = dup(buffer->fd);
+  return buffer->fd != -1;
+}
+
+// Thumbnails the shell stopped asking for are no longer kept up to date
+void Server::expire_thumbnails()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint32_t now_msec = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+  std::erase_if(thumbnails_, [now_msec](auto &entry) {
+    return entry.second->expired(now_msec);
+  });
+}
+
+void Server::thumbnail_rendered(Thumbnail *thumbnail)
+{
+  if (endpoint_) {
+    endpoint_->ThumbnailChanged(thumbnail->view->id(), thumbnail->buffer().serial);
+  }
+}
+
+std::vector<Thumbnail*> Server::due_thumbnails() const
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint32_t now_msec = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+  std::vector<Thumbnail*> due;
+  for (auto &entry : thumbnails_) {
+    if (entry.second->due(now_msec)) {
+      due.push_back(entry.second.get());
+    }
+  }
+  return due;
+}
+
+// "window" captures the window on top, anything else the output under
+// the cursor, saved to the pictures directory
+void Server::screenshot(const std::string& target)
+{
+  if (target == "window") {
+    auto unminimized_views = filter_unminimized_views(filter_mapped_views(workspace_views()));
+    if (!unminimized_views.empty()) {
+      screenshot_view(unminimized_views.front().get(), screenshot_path());
+    }
+    return;
+  }
+
+  Output *output = platform_->output_at(cursor_->x(), cursor_->y());
+  if (output != nullptr) {
+    capture_screenshot(output, nullptr, screenshot_path());
+  }
+}
+
+// The screenshot is only queued, it is saved once the next frame has been
+// drawn and encoded
+bool Server::screenshot_output(const std::string& output_id, const std::string& name)
+{
+  auto path = screenshot_path(name);
+  if (path.empty()) {
+    return false;
+  }
+
+  auto condition = [output_id](auto &el) { return !el->deleted() && el->id() == output_id; };
+  auto result = std::find_if(outputs_.begin(), outputs_.end(), condition);
+  if (result == outputs_.end()) {
+    return false;
+  }
+
+  return capture_screenshot((*result).get(), nullptr, path);
+}
+
+// Only a window that is on screen can be read back from its output
+bool Server::screenshot_app(const std::string& app_id, const std::string& name)
+{
+  auto path = screenshot_path(name);
+  if (path.empty()) {
+    return false;
+  }
+
+  auto shown_views = filter_unminimized_views(filter_mapped_views(workspace_views()));
+  auto condition = [app_id](auto &el) { return el->is_root() && el->id() == app_id; };
+  auto result = std::find_if(shown_views.begin(), shown_views.end(), condition);
+  if (result == shown_views.end()) {
+    return false;
+  }
+
+  return screenshot_view((*result).get(), path);
+}
+
+// A window is read back from the output it is centered on, as it looks
+// there including anything overlapping it
+bool Server::screenshot_view(View *view, const std::string& path)
+{
+  wlr_box geometry;
+  view->geometry(&geometry);
+
+  wlr_box box = {
+    .x = static_cast<int>(view->x) + geometry.x,
+    .y = static_cast<int>(view->y) + geometry.y,
+    .width = geometry.width,
+    .height = geometry.height
+  };
+
+  Output *output = platform_->output_at(box.x + box.width / 2.0, box.y + box.height / 2.0);
+  if (output == nullptr) {
+    return false;
+  }
+
+  return capture_screenshot(output, &box, path);
+}
+
+bool Server::capture_screenshot(IOutput *output, const wlr_box *box, const std::string& path)
+{
+  auto writer = screenshot_writer_;
+  bool queued = output->capture(box, [writer, path](CapturedFrame&& frame) {
+    if (frame.pixels == nullptr) {
+      spdlog::warn("Unable to take a screenshot for {}", path);
+      return;
+    }
+    writer->write(std::move(frame), path);
+  });
+
+  if (!queued) {
+    spdlog::warn("Unable to capture output {} for a screenshot", output->id());
+  }
+  return queued;
+}
+
+// Named after the time like other desktops do unless a name is given, in
+// the pictures directory when there is one. Clients only pick the file
+// name, anything that could leave the directory gives an empty path.
+std::string Server::screenshot_path(const std::string& name) const
+{
+  if (name.find('/') != std::string::npos || name == "." || name == "..") {
+    return "";
+  }
+
+  const char *home = getenv("HOME");
+  std::string directory = home != nullptr ? home : ".";
+  if (os_->file_exists(directory + "/Pictures")) {
+    directory += "/Pictures";
+  }
+
+  if (!name.empty()) {
+    return directory + "/" + name;
+  }
+
+  char timed_name[64];
+  time_t now = time(nullptr);
+  struct tm local;
+  localtime_r(&now, &local);
+  strftime(timed_name, sizeof(timed_name), "Screenshot from %Y-%m-%d %H-%M-%S.png", &local);
+
+  std::stringstream path;
+  path << directory << "/" << timed_name;
+  return path.str();
+}
+
 void Server::damage_outputs()
 {
   for (auto &output : outputs_) {
@@ -99,6 +381,10 @@ void Server::damage_outputs()
 
 void Server::damage_output(View *view)
 {
+  if (view->workspace != nullptr && !view->workspace->active) {
+    return;
+  }
+
   for (auto &output : outputs_) {
     output->take_damage(view);
   }
@@ -117,35 +403,94 @@ void Server::dbus_thread(Server *server)
   dispatcher.enter();
 }
 
+int Server::run_queued_tasks(int fd, uint32_t mask, void *data)
+{
+  auto server = static_cast<Server*>(data);
+  server->loop_queue_.run_pending();
+  return 0;
+}
+
 int Server::add_keybinding(int key_code, int modifiers, int state)
 {
-  unsigned int id = 0;
-  bool exists = false;
-  for (auto &pair : key_bindings) {
-    if (pair.second.key_code_ == key_code && pair.second.modifiers_ == modifiers &&
-      pair.second.state_ == state) {
-      exists = true;
-      id = pair.first;
-      break;
-    }
-  }
+  return key_bindings.add(key_code, modifiers, state);
+}
 
-  if (exists) {
-    return id;
-  }
+int Server::add_keysym_binding(xkb_keysym_t keysym, int modifiers, int state)
+{
+  return key_bindings.add_keysym(keysym, modifiers, state);
+}
 
-  if (!key_bindings.empty()) {
-    auto it = key_bindings.end();
-    id = (*it).first + 1;
-  }
+int Server::add_chord(const std::vector<KeyBinding>& sequence)
+{
+  return key_bindings.add_chord(sequence);
+}
 
-  KeyBinding key_binding(key_code, modifiers, state);
-  key_bindings.insert(std::make_pair(id, key_binding));
+std::vector<int> Server::add_keybindings(const std::vector<KeyBinding>& bindings)
+{
+  return key_bindings.add_all(bindings);
+}
 
+int Server::add_action(xkb_keysym_t keysym, int modifiers, const Action& action)
+{
+  int id = key_bindings.add_keysym(keysym, modifiers, WLR_KEY_PRESSED);
+  actions_[id] = action;
   return id;
 }
 
-bool Server::key(uint32_t keycode, uint32_t modifiers, int state)
+void Server::load_actions()
+{
+  ShortcutConfig config(os_);
+  auto bindings = config.load();
+
+  for (auto &binding : bindings) {
+    auto keysym = xkb_keysym_from_name(binding.key.c_str(), XKB_KEYSYM_CASE_INSENSITIVE);
+    if (keysym == XKB_KEY_NoSymbol) {
+      spdlog::warn("Unknown key {}", binding.key);
+      continue;
+    }
+    add_action(keysym, binding.modifiers, binding.action);
+  }
+}
+
+void Server::run_action(const Action& action)
+{
+  switch (action.type) {
+    case ACTION_DOCK_LEFT:
+      dock_left();
+      break;
+    case ACTION_DOCK_RIGHT:
+      dock_right();
+      break;
+    case ACTION_TOGGLE_MAXIMIZE:
+      toggle_maximize();
+      break;
+    case ACTION_MINIMIZE_TOP:
+      minimize_top();
+      break;
+    case ACTION_FOCUS_APP:
+      focus_app(action.argument);
+      break;
+    case ACTION_EXEC:
+      os_->execute(action.argument);
+      break;
+    case ACTION_SWITCH_WORKSPACE:
+      switch_workspace(std::atoi(action.argument.c_str()));
+      break;
+    case ACTION_MOVE_TO_WORKSPACE:
+      move_to_workspace(std::atoi(action.argument.c_str()));
+      break;
+    case ACTION_TOGGLE_OVERVIEW:
+      toggle_overview();
+      break;
+    case ACTION_SCREENSHOT:
+      screenshot(action.argument);
+      break;
+    case ACTION_NONE:
+      break;
+  }
+}
+
+bool Server::key(uint32_t keycode, xkb_keysym_t keysym, uint32_t modifiers, int state)
 {
   // Global shortcut to quit the compositor
   if (keycode == KEY_BACKSPACE && modifiers == (WLR_MODIFIER_CTRL | WLR_MODIFIER_ALT)) {
@@ -153,15 +498,31 @@ bool Server::key(uint32_t keycode, uint32_t modifiers, int state)
     return true;
   }
 
-  for (auto &pair : key_bindings) {
-    bool matched = pair.second.matches(modifiers, keycode, (wlr_key_state)state);
-    if (matched) {
-      endpoint_->Shortcut(pair.first);
-      return true;
+  if (overview_ && keysym == XKB_KEY_Escape) {
+    if (state == WLR_KEY_PRESSED) {
+      toggle_overview();
     }
+    return true;
   }
 
-  return false;
+  int id = -1;
+  bool handled = key_bindings.dispatch(keycode, keysym, modifiers, state, &id);
+
+  if (id < 0) {
+    return handled;
+  }
+
+  auto action = actions_.find(id);
+  if (action != actions_.end()) {
+    run_action(action->second);
+    return handled;
+  }
+
+  if (endpoint_) {
+    endpoint_->Shortcut(id);
+  }
+
+  return handled;
 }
 
 void Server::focus_app(const std::string& app_id)
@@ -184,8 +545,17 @@ void Server::view_focused(View *view)
   }
 
   if (view->steals_focus() && prev_surface != nullptr) {
+    // The keyboard may have been on a layer surface rather than a view
     View *previous_view = view_from_surface(prev_surface);
-    previous_view->unfocus();
+    if (previous_view != nullptr) {
+      previous_view->unfocus();
+    }
+  }
+
+  // Outputs only draw a fullscreen view while it is on top, so anything
+  // raised above one needs the rest of the output repainted
+  if (!views_.empty() && views_.front().get() != view && views_.front()->fullscreen()) {
+    damage_outputs();
   }
 
   auto condition = [view](auto &el) { return el.get() == view; };
@@ -195,6 +565,21 @@ void Server::view_focused(View *view)
     views_.erase(result);
     views_.insert(views_.begin(), resultValue);
   }
+
+  // A view restored part way through minimizing turns back from there
+  if (view->animating) {
+    animate_view(view, view->animation, real_transform(view), MINIMIZE_ANIMATION_MS);
+  }
+
+  auto workspace = view->workspace;
+  if (workspace != nullptr) {
+    workspace->raise_view(view);
+
+    // Focusing an app on another workspace brings that workspace along
+    if (!workspace->active) {
+      activate_workspace(workspace);
+    }
+  }
 }
 
 void Server::purge_deleted_outputs(void *data)
@@ -205,21 +590,133 @@ void Server::purge_deleted_outputs(void *data)
 
 void Server::output_destroyed(Output *output)
 {
+  output->close_layer_surfaces();
+
+  // Views on a disconnected output move to whichever output is left
+  auto other_output = std::find_if(outputs_.begin(), outputs_.end(), [output](auto &el) {
+    return el.get() != output && !el->deleted();
+  });
+
+  if (other_output != outputs_.end() && workspaces_.count(output->id()) > 0) {
+    auto target = active_workspace((*other_output)->id());
+    for (auto &workspace : workspaces_[output->id()]) {
+      for (auto &view : workspace->views()) {
+        view->workspace = target;
+        target->add_view(view);
+      }
+    }
+    workspaces_.erase(output->id());
+  }
+
   auto condition = [output](auto &el) { return el.get() == output; };
   auto result = std::find_if(outputs_.begin(), outputs_.end(), condition);
   if (result != outputs_.end()) {
     (*result)->mark_deleted();
+    virtual_outputs_.erase((*result)->id());
   }
 
   platform_->add_idle(&Server::purge_deleted_outputs, this);
 }
 
+void Server::animate_view(View *view, const ViewTransform& from, const ViewTransform& to,
+  uint32_t duration_msec)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint32_t now_msec = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+  animator_.animate(view, from, to, duration_msec, now_msec);
+
+  // The first frame is what gets the animation stepping
+  damage_animation(view, from);
+}
+
+// Damages the view's surfaces, popups and all, where the transform puts them
+void Server::damage_animation(View *view, const ViewTransform& transform)
+{
+  wlr_box geometry;
+  view->geometry(&geometry);
+  if (geometry.width <= 0 || geometry.height <= 0) {
+    return;
+  }
+
+  wlr_box bounds = geometry;
+  view->for_each_surface(add_surface_bounds, &bounds);
+
+  double scale_x = transform.width / geometry.width;
+  double scale_y = transform.height / geometry.height;
+
+  int left = std::floor(transform.x + (bounds.x - geometry.x) * scale_x);
+  int top = std::floor(transform.y + (bounds.y - geometry.y) * scale_y);
+  int right = std::ceil(transform.x + (bounds.x + bounds.width - geometry.x) * scale_x);
+  int bottom = std::ceil(transform.y + (bounds.y + bounds.height - geometry.y) * scale_y);
+
+  wlr_box box = {
+    .x = left,
+    .y = top,
+    .width = right - left,
+    .height = bottom - top
+  };
+
+  for (auto &output : outputs_) {
+    output->take_box_damage(&box);
+  }
+}
+
+// Each step only repaints where the views were and where they are now
+void Server::step_animations(Output *output)
+{
+  if (!animator_.active()) {
+    return;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint32_t now_msec = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+  int refresh = output->wlr_output->refresh;
+  uint32_t frame_msec = refresh > 0 ? 1000000 / refresh : DEFAULT_FRAME_MS;
+
+  for (auto &step : animator_.step(now_msec, frame_msec)) {
+    damage_animation(step.view, step.before);
+    damage_animation(step.view, step.after);
+  }
+}
+
 void Server::output_frame(Output *output)
 {
-  auto mapped_views = filter_mapped_views(views_);
-  auto unminimized_views = filter_unminimized_views(mapped_views);
+  step_animations(output);
+
+  // Minimized views stay on screen until they finish animating away
+  auto mapped_views = filter_mapped_views(visible_views(output->id()));
+  std::vector<std::shared_ptr<View>> unminimized_views;
+  std::copy_if(mapped_views.begin(), mapped_views.end(), std::back_inserter(unminimized_views),
+    [](auto &view) { return !view->minimized || view->animating; });
   output->send_enter(unminimized_views);
-  output->render(unminimized_views);
+
+  // The overview lays out only the output's own windows, the ones spilling
+  // over from a neighbour show up in that neighbour's overview
+  if (overview_) {
+    auto workspace = active_workspace(output->id());
+    auto spilled = [workspace](auto &view) {
+      return view->layer() == VIEW_LAYER_TOP && view->workspace != workspace;
+    };
+    std::erase_if(unminimized_views, spilled);
+  }
+
+  // Mirrors never attach the renderer for views, so they leave thumbnails
+  // to the next output that does
+  std::vector<Thumbnail*> thumbnails;
+  if (!output->mirroring()) {
+    expire_thumbnails();
+    thumbnails = due_thumbnails();
+  }
+
+  output->render(unminimized_views, thumbnails);
+
+  if (animator_.active()) {
+    output->schedule_frame();
+  }
 }
 
 void Server::output_mode(Output *output)
@@ -227,27 +724,196 @@ void Server::output_mode(Output *output)
   if (!output->primary()) {
     return;
   }
-}
+}
+
+void Server::purge_deleted_views(void *data)
+{
+  Server *server = static_cast<Server*>(data);
+  std::erase_if(server->views_, [](const auto &el) { return el.get()->deleted; });
+}
+
+void Server::purge_deleted_layer_surfaces(void *data)
+{
+  Server *server = static_cast<Server*>(data);
+  std::erase_if(server->layer_surfaces_, [](const auto &el) { return el.get()->deleted; });
+}
+
+void Server::layer_surface_created(const std::shared_ptr<LayerSurface>& layer_surface)
+{
+  layer_surface->on_map.connect_member(this, &Server::layer_surface_mapped);
+  layer_surface->on_unmap.connect_member(this, &Server::layer_surface_unmapped);
+  layer_surface->on_commit.connect_member(this, &Server::layer_surface_committed);
+  layer_surface->on_destroy.connect_member(this, &Server::layer_surface_destroyed);
+
+  layer_surfaces_.push_back(layer_surface);
+
+  // Sends the first configure so that the client can map
+  layer_surface->output()->add_layer_surface(layer_surface.get());
+}
+
+void Server::layer_surface_mapped(LayerSurface *layer_surface)
+{
+  auto output = layer_surface->output();
+  if (output != nullptr) {
+    output->arrange_layers();
+  }
+
+  if (layer_surface->keyboard_interactive()) {
+    platform_->seat()->keyboard_notify_enter(layer_surface->surface());
+  }
+}
+
+void Server::layer_surface_unmapped(LayerSurface *layer_surface)
+{
+  auto output = layer_surface->output();
+  if (output != nullptr) {
+    output->arrange_layers();
+  }
+
+  auto seat = platform_->seat();
+  if (seat->keyboard_focused_surface() == layer_surface->surface()) {
+    focus_top();
+  }
+}
+
+void Server::layer_surface_committed(LayerSurface *layer_surface)
+{
+  auto output = layer_surface->output();
+  if (output == nullptr) {
+    return;
+  }
+
+  if (layer_surface->state_changed()) {
+    output->arrange_layers();
+    return;
+  }
+
+  output->take_layer_damage(layer_surface);
+}
+
+void Server::layer_surface_destroyed(LayerSurface *layer_surface)
+{
+  auto output = layer_surface->output();
+  if (output != nullptr) {
+    output->remove_layer_surface(layer_surface);
+  }
+
+  layer_surface->deleted = true;
+  platform_->add_idle(&Server::purge_deleted_layer_surfaces, this);
+}
+
+void Server::view_damaged(View *view)
+{
+  damage_output(view);
+
+  auto it = thumbnails_.find(view);
+  if (it != thumbnails_.end()) {
+    it->second->damage();
+    schedule_thumbnails();
+  }
+}
+
+void Server::view_destroyed(View *view)
+{
+  auto condition = [view](auto &el) { return el.get() == view; };
+  auto result = std::find_if(views_.begin(), views_.end(), condition);
+  if (result != views_.end()) {
+    (*result)->deleted = true;
+  }
+
+  if (pending_transaction_) {
+    pending_transaction_->remove(view);
+  }
+
+  for (auto &transaction : transactions_) {
+    transaction->remove(view);
+  }
+
+  view->release_buffers();
+
+  animator_.cancel(view);
+  animation_origins_.erase(view);
+
+  thumbnails_.erase(view);
+
+  if (view->workspace != nullptr) {
+    view->workspace->remove_view(view);
+    view->workspace = nullptr;
+  }
+
+  platform_->add_idle(&Server::purge_deleted_views, this);
+}
+
+void Server::view_configured(View *view, int x, int y, int width, int height)
+{
+  if (!pending_transaction_) {
+    pending_transaction_ = std::make_shared<Transaction>(platform_.get());
+    platform_->add_idle(&Server::commit_transaction, this);
+  }
+
+  pending_transaction_->add(view, x, y, width, height);
+}
+
+void Server::view_committed(View *view)
+{
+  for (auto &transaction : transactions_) {
+    transaction->view_committed(view);
+  }
+}
+
+void Server::commit_transaction(void *data)
+{
+  Server *server = static_cast<Server*>(data);
+  auto transaction = server->pending_transaction_;
+  server->pending_transaction_.reset();
+
+  if (!transaction) {
+    return;
+  }
+
+  // The newest layout wins for views that are still waiting on an older one
+  for (auto &view : transaction->views()) {
+    for (auto &in_flight : server->transactions_) {
+      in_flight->remove(view);
+    }
+  }
+
+  // Views animate from wherever they were drawn when the layout changed
+  for (auto &view : transaction->views()) {
+    server->animation_origins_[view] = current_transform(view);
+  }
 
-void Server::purge_deleted_views(void *data)
-{
-  Server *server = static_cast<Server*>(data);
-  std::erase_if(server->views_, [](const auto &el) { return el.get()->deleted; });
+  transaction->on_apply.connect_member(server, &Server::transaction_applied);
+  server->transactions_.push_back(transaction);
+  transaction->commit();
 }
 
-void Server::view_damaged(View *view)
+void Server::transaction_applied(Transaction *transaction)
 {
-  damage_output(view);
+  for (auto &view : transaction->views()) {
+    auto origin = animation_origins_.find(view);
+    if (origin == animation_origins_.end()) {
+      continue;
+    }
+
+    auto from = origin->second;
+    animation_origins_.erase(origin);
+
+    auto to = real_transform(view);
+    bool moved = from.x != to.x || from.y != to.y ||
+      from.width != to.width || from.height != to.height;
+    if (moved) {
+      animate_view(view, from, to, CONFIGURE_ANIMATION_MS);
+    }
+  }
+
+  platform_->add_idle(&Server::purge_applied_transactions, this);
 }
 
-void Server::view_destroyed(View *view)
+void Server::purge_applied_transactions(void *data)
 {
-  auto condition = [view](auto &el) { return el.get() == view; };
-  auto result = std::find_if(views_.begin(), views_.end(), condition);
-  if (result != views_.end()) {
-    (*result)->deleted = true;
-  }
-  platform_->add_idle(&Server::purge_deleted_views, this);
+  Server *server = static_cast<Server*>(data);
+  std::erase_if(server->transactions_, [](const auto &el) { return el->done(); });
 }
 
 void Server::view_moved(View *view)
@@ -257,21 +923,61 @@ void Server::view_moved(View *view)
 
 void Server::view_mapped(View *view)
 {
+  // Dialogs and menus stay with their parent, everything else opens on
+  // the workspace being shown under the cursor
+  Workspace *workspace = nullptr;
+  if (follows_workspaces(view->root())) {
+    workspace = view->is_root() ? nullptr : view->root()->workspace;
+    if (workspace == nullptr) {
+      workspace = current_workspace();
+    }
+  }
+
+  auto condition = [view](auto &el) { return el.get() == view; };
+  auto result = std::find_if(views_.begin(), views_.end(), condition);
+  if (workspace != nullptr && result != views_.end()) {
+    view->workspace = workspace;
+    workspace->add_view(*result);
+  }
+
   position_view(view);
   view->focus();
-  damage_output(view);
+
+  if (view->layer() == VIEW_LAYER_TOP) {
+    auto to = real_transform(view);
+    animate_view(view, shrunk_transform(to, 0.95), to, MAP_ANIMATION_MS);
+  }
+
+  // A new window reshuffles the whole overview grid
+  if (overview_) {
+    damage_outputs();
+  } else {
+    damage_output(view);
+  }
 }
 
 void Server::view_unmapped(View *view)
 {
+  if (view->is_menubar()) {
+    for (auto &output : outputs_) {
+      output->set_menubar(nullptr);
+    }
+  }
+
+  if (view->workspace != nullptr) {
+    view->workspace->remove_view(view);
+    view->workspace = nullptr;
+  }
+
   focus_top();
   damage_outputs();
 }
 
-void Server::keyboard_key(uint32_t time_msec, uint32_t keycode, uint32_t modifiers, int state)
+void Server::keyboard_key(uint32_t time_msec, uint32_t keycode, xkb_keysym_t keysym,
+  uint32_t modifiers, int state)
 {
   auto seat = platform_->seat();
-  bool handled = key(keycode, modifiers, state);
+  bool handled = key(keycode, keysym, modifiers, state);
 
   if (!handled) {
     seat->keyboard_notify_key(time_msec, keycode, state);
@@ -287,10 +993,31 @@ void Server::lid_switch(bool enabled)
   }
 }
 
-void Server::cursor_button(ICursor *cursor, int x, int y)
+void Server::cursor_button(ICursor *cursor, double x, double y)
 {
+  // A click in the overview picks a window, or dismisses it over nothing
+  if (overview_) {
+    Output *output = platform_->output_at(x, y);
+    auto view = output != nullptr ? output->overview_view_at(x, y) : nullptr;
+    toggle_overview();
+    if (view) {
+      view->focus();
+    }
+    return;
+  }
+
   double sx, sy;
   wlr_surface *surface;
+
+  auto layer_surface = layer_surface_at({ VIEW_LAYER_OVERLAY, VIEW_LAYER_TOP }, x, y,
+    &surface, &sx, &sy);
+  if (layer_surface != nullptr) {
+    if (layer_surface->keyboard_interactive()) {
+      platform_->seat()->keyboard_notify_enter(layer_surface->surface());
+    }
+    return;
+  }
+
   View *view = desktop_view_at(x, y, &surface, &sx, &sy);
 
   if (view == nullptr) {
@@ -302,6 +1029,9 @@ void Server::cursor_button(ICursor *cursor, int x, int y)
 
 void Server::view_minimized(View *view)
 {
+  auto from = current_transform(view);
+  animate_view(view, from, shrunk_transform(from, 0.8), MINIMIZE_ANIMATION_MS);
+
   auto condition = [view](auto &el) { return el.get() == view; };
   auto result = std::find_if(views_.begin(), views_.end(), condition);
   if (result != views_.end()) {
@@ -310,6 +1040,10 @@ void Server::view_minimized(View *view)
     views_.push_back(resultValue);
   }
 
+  if (view->workspace != nullptr) {
+    view->workspace->lower_view(view);
+  }
+
   focus_top();
 }
 
@@ -326,7 +1060,7 @@ void Server::maximize_view(View *view)
 
 void Server::focus_top()
 {
-  auto mapped_views = filter_mapped_views(views_);
+  auto mapped_views = filter_mapped_views(workspace_views());
   auto unminimized_views = filter_unminimized_views(mapped_views);
   if (unminimized_views.empty()) return;
 
@@ -336,16 +1070,29 @@ void Server::focus_top()
 
 void Server::minimize_top()
 {
-  auto mapped_views = filter_mapped_views(views_);
+  auto mapped_views = filter_mapped_views(workspace_views());
   if (mapped_views.empty()) return;
 
   auto top_view = mapped_views.front();
   top_view->minimize();
 }
 
+void Server::toggle_overview()
+{
+  overview_ = !overview_;
+
+  for (auto &output : outputs_) {
+    output->set_overview(overview_);
+  }
+
+  if (overview_) {
+    schedule_overview_frames();
+  }
+}
+
 void Server::toggle_maximize()
 {
-  auto mapped_views = filter_mapped_views(views_);
+  auto mapped_views = filter_mapped_views(workspace_views());
   if (mapped_views.empty()) return;
 
   auto top_view = mapped_views.front();
@@ -354,7 +1101,7 @@ void Server::toggle_maximize()
 
 void Server::dock_left()
 {
-  auto mapped_views = filter_mapped_views(views_);
+  auto mapped_views = filter_mapped_views(workspace_views());
   if (mapped_views.empty()) return;
 
   auto top_view = mapped_views.front();
@@ -363,7 +1110,7 @@ void Server::dock_left()
 
 void Server::dock_right()
 {
-  auto mapped_views = filter_mapped_views(views_);
+  auto mapped_views = filter_mapped_views(workspace_views());
   if (mapped_views.empty()) return;
 
   auto top_view = mapped_views.front();
@@ -374,12 +1121,21 @@ void Server::output_created(const std::shared_ptr<Output>& output)
 {
   outputs_.push_back(output);
 
+  if (pending_virtual_output_) {
+    virtual_outputs_[output->id()] = *pending_virtual_output_;
+    pending_virtual_output_.reset();
+  }
+
   output->on_destroy.connect_member(this, &Server::output_destroyed);
   output->on_frame.connect_member(this, &Server::output_frame);
   output->on_mode.connect_member(this, &Server::output_mode);
   output->on_connect.connect_member(this, &Server::outputs_changed);
   output->on_disconnect.connect_member(this, &Server::outputs_changed);
 
+  if (overview_) {
+    output->set_overview(true);
+  }
+
   output->set_connected(true);
 }
 
@@ -394,18 +1150,44 @@ void Server::view_created(const std::shared_ptr<View>& view)
   view->on_destroy.connect_member(this, &Server::view_destroyed);
   view->on_move.connect_member(this, &Server::view_moved);
   view->on_focus.connect_member(this, &Server::view_focused);
+  view->on_configure.connect_member(this, &Server::view_configured);
+  view->on_commit.connect_member(this, &Server::view_committed);
 
   views_.push_back(view);
 }
 
-void Server::cursor_motion(ICursor* cursor, int x, int y, uint32_t time)
+void Server::cursor_motion(ICursor* cursor, double x, double y, uint32_t time)
 {
+  // Windows in the overview are only pictures of themselves, so the pointer
+  // never enters them
+  if (overview_) {
+    Output *output = platform_->output_at(x, y);
+    if (output != nullptr) {
+      output->set_overview_hover(output->overview_view_at(x, y).get());
+    }
+    cursor->set_image("left_ptr");
+    platform_->seat()->pointer_clear_focus();
+    return;
+  }
+
   /* Otherwise, find the view under the pointer and send the event along. */
   double sx, sy;
   wlr_surface *surface = NULL;
-  View *view = desktop_view_at(x, y, &surface, &sx, &sy);
+  View *view = nullptr;
+
+  // Panels and overlays sit above the views, wallpapers and docks below
+  auto layer_surface = layer_surface_at({ VIEW_LAYER_OVERLAY, VIEW_LAYER_TOP }, x, y,
+    &surface, &sx, &sy);
+  if (layer_surface == nullptr) {
+    view = desktop_view_at(x, y, &surface, &sx, &sy);
+  }
+
+  if (layer_surface == nullptr && view == nullptr) {
+    layer_surface = layer_surface_at({ VIEW_LAYER_BOTTOM, VIEW_LAYER_BACKGROUND }, x, y,
+      &surface, &sx, &sy);
+  }
 
-  if (!view) {
+  if (!view && !layer_surface) {
     cursor->set_image("left_ptr");
   }
 
@@ -448,23 +1230,36 @@ bool Server::init()
 
   platform_->on_new_output.connect_member(this, &Server::output_created);
   platform_->on_new_view.connect_member(this, &Server::view_created);
+  platform_->on_new_layer_surface.connect_member(this, &Server::layer_surface_created);
   platform_->on_new_keyboard.connect_member(this, &Server::keyboard_created);
   platform_->on_lid_switch.connect_member(this, &Server::lid_switch);
 
   cursor_->on_button.connect_member(this, &Server::cursor_button);
   cursor_->on_move.connect_member(this, &Server::cursor_motion);
 
+  load_actions();
+  load_xwayland();
+
   bool platform_start_result = platform_->start();
   if (!platform_start_result) {
     return false;
   }
 
+  load_virtual_outputs();
+
   os_->set_env("MOZ_ENABLE_WAYLAND", "1");
   os_->set_env("QT_QPA_PLATFORM", "wayland");
   os_->set_env("QT_QPA_PLATFORMTHEME", "gnome");
   os_->set_env("XDG_CURRENT_DESKTOP", "sway");
   os_->set_env("XDG_SESSION_TYPE", "wayland");
 
+  // D-Bus requests touch the same state as the loop, so the endpoint
+  // hands them over to run here
+  if (!loop_queue_.init()) {
+    return false;
+  }
+  platform_->add_fd(loop_queue_.fd(), &Server::run_queued_tasks, this);
+
   dbus_ = std::thread(Server::dbus_thread, this);
 
   os_->execute("lumin-menu");
@@ -482,6 +1277,7 @@ void Server::destroy()
 {
   spdlog::warn("quitting");
 
+  loop_queue_.close();
   platform_->destroy();
 }
 
@@ -497,9 +1293,57 @@ void Server::enable_output(const std::string& name, bool enabled)
   output->set_connected(enabled);
 }
 
+std::string Server::create_virtual_output(const OutputConfig& config)
+{
+  pending_virtual_output_ = std::make_unique<OutputConfig>(config);
+  auto id = platform_->create_virtual_output(config.width, config.height);
+  pending_virtual_output_.reset();
+  return id;
+}
+
+bool Server::destroy_virtual_output(const std::string& id)
+{
+  if (virtual_outputs_.count(id) == 0) {
+    return false;
+  }
+
+  return platform_->destroy_virtual_output(id);
+}
+
+void Server::load_xwayland()
+{
+  XWaylandConfig config(os_);
+  auto settings = config.load();
+
+  platform_->set_xwayland_idle_timeout(settings.idle_timeout);
+}
+
+void Server::load_virtual_outputs()
+{
+  VirtualOutputConfig config(os_);
+  auto outputs = config.load();
+
+  for (auto &output : outputs) {
+    create_virtual_output(output);
+  }
+}
+
 void Server::outputs_changed(IOutput* _output)
 {
-  auto display_config = display_config_->find_layout(outputs_);
+  // Virtual outputs are placed by their own config so that adding one
+  // doesn't change which monitor profile matches
+  auto physical_outputs = outputs_;
+  if (!virtual_outputs_.empty()) {
+    std::erase_if(physical_outputs, [this](const auto &output) {
+      return virtual_outputs_.count(output->id()) > 0;
+    });
+  }
+
+  auto display_config = display_config_->find_layout(physical_outputs);
+  for (auto &virtual_output : virtual_outputs_) {
+    display_config[virtual_output.first] = virtual_output.second;
+  }
+
   for (auto& configKV : display_config) {
     auto name = configKV.first;
 
@@ -510,8 +1354,25 @@ void Server::outputs_changed(IOutput* _output)
 
     auto output = (*it);
     auto config = configKV.second;
+
+    IOutput *source = nullptr;
+    if (!config.mirror.empty()) {
+      auto source_it = std::find_if(outputs_.begin(), outputs_.end(),
+        [&config](auto &output) -> bool { return config.mirror.compare(output->id()) == 0; });
+
+      if (source_it != outputs_.end()) {
+        source = source_it->get();
+      } else {
+        spdlog::warn("{} can't mirror missing output {}", name, config.mirror);
+      }
+    }
+
+    output->mirror(source);
     cursor_->load_scale(config.scale);
-    output->configure(config.scale, config.primary, config.enabled, config.x, config.y);
+    output->request_mode(config.mode, config.width, config.height, config.refresh);
+    if (!output->configure(config.scale, config.primary, config.enabled, config.x, config.y)) {
+      spdlog::error("Failed to configure output {}", name);
+    }
   }
 }
 
@@ -524,7 +1385,12 @@ void Server::keyboard_created(const std::shared_ptr<Keyboard>& keyboard)
 View* Server::desktop_view_at(double lx, double ly,
   wlr_surface **surface, double *sx, double *sy)
 {
-  for (auto &view : views_) {
+  Output *output = platform_->output_at(lx, ly);
+  if (output == nullptr) {
+    return NULL;
+  }
+
+  for (auto &view : visible_views(output->id())) {
     if (view->view_at(lx, ly, surface, sx, sy)) {
       return view.get();
     }
@@ -532,6 +1398,24 @@ View* Server::desktop_view_at(double lx, double ly,
   return NULL;
 }
 
+LayerSurface* Server::layer_surface_at(const std::vector<ViewLayer>& layers, double lx, double ly,
+  wlr_surface **surface, double *sx, double *sy)
+{
+  Output *output = platform_->output_at(lx, ly);
+  if (output == nullptr) {
+    return nullptr;
+  }
+
+  for (auto layer : layers) {
+    auto layer_surface = output->layer_surface_at(layer, lx, ly, surface, sx, sy);
+    if (layer_surface != nullptr) {
+      return layer_surface;
+    }
+  }
+
+  return nullptr;
+}
+
 View* Server::view_from_surface(wlr_surface *surface)
 {
   for (auto &view : views_) {
@@ -542,24 +1426,276 @@ View* Server::view_from_surface(wlr_surface *surface)
   return NULL;
 }
 
-Output* Server::primary_output() const
+std::vector<std::shared_ptr<Workspace>>& Server::output_workspaces(const std::string& output_id)
 {
-  auto condition = [](auto &el) { return el->primary(); };
-  auto result = std::find_if(outputs_.begin(), outputs_.end(), condition);
+  auto &workspaces = workspaces_[output_id];
 
-  if (result == outputs_.end()) {
-    spdlog::error("Failed to find primary output");
+  if (workspaces.empty()) {
+    for (int i = 0; i < WORKSPACE_COUNT; i++) {
+      workspaces.push_back(std::make_shared<Workspace>(output_id, i));
+    }
+    workspaces.front()->active = true;
+  }
+
+  return workspaces;
+}
+
+Workspace* Server::active_workspace(const std::string& output_id)
+{
+  for (auto &workspace : output_workspaces(output_id)) {
+    if (workspace->active) {
+      return workspace.get();
+    }
+  }
+  return nullptr;
+}
+
+Workspace* Server::current_workspace()
+{
+  Output *output = platform_->output_at(cursor_->x(), cursor_->y());
+  if (output == nullptr) {
     return nullptr;
   }
+  return active_workspace(output->id());
+}
+
+void Server::activate_workspace(Workspace *workspace)
+{
+  auto previous = active_workspace(workspace->output);
+  if (previous == workspace) {
+    return;
+  }
+
+  previous->active = false;
+  workspace->active = true;
+
+  damage_outputs();
+  schedule_hidden_frames();
+}
+
+bool Server::switch_workspace(int index)
+{
+  if (index < 0 || index >= WORKSPACE_COUNT) {
+    spdlog::warn("No workspace {}", index);
+    return false;
+  }
+
+  auto current = current_workspace();
+  if (current == nullptr) {
+    return false;
+  }
+
+  auto workspace = output_workspaces(current->output)[index].get();
+  if (workspace == current) {
+    return false;
+  }
+
+  activate_workspace(workspace);
+  focus_top();
+  return true;
+}
+
+bool Server::move_to_workspace(int index)
+{
+  if (index < 0 || index >= WORKSPACE_COUNT) {
+    spdlog::warn("No workspace {}", index);
+    return false;
+  }
+
+  auto current = current_workspace();
+  if (current == nullptr) {
+    return false;
+  }
+
+  auto mapped_views = filter_mapped_views(current->views());
+  if (mapped_views.empty()) {
+    return false;
+  }
+
+  auto workspace = output_workspaces(current->output)[index].get();
+  if (workspace == current) {
+    return false;
+  }
+
+  auto top_view = mapped_views.front();
+  current->remove_view(top_view.get());
+  workspace->add_view(top_view);
+  top_view->workspace = workspace;
+
+  damage_outputs();
+  schedule_hidden_frames();
+  focus_top();
+  return true;
+}
+
+std::vector<std::shared_ptr<View>> Server::visible_views(const std::string& output_id) const
+{
+  std::vector<std::shared_ptr<View>> views;
+
+  // The output's own workspace stacks above views that spill over from
+  // the workspaces shown on its neighbours
+  auto own = workspaces_.find(output_id);
+  if (own != workspaces_.end()) {
+    for (auto &workspace : own->second) {
+      if (workspace->active) {
+        views.insert(views.end(), workspace->views().begin(), workspace->views().end());
+      }
+    }
+  }
+
+  for (auto &entry : workspaces_) {
+    if (entry.first == output_id) {
+      continue;
+    }
+    for (auto &workspace : entry.second) {
+      if (workspace->active) {
+        views.insert(views.end(), workspace->views().begin(), workspace->views().end());
+      }
+    }
+  }
 
-  return (Output*)(*result).get();
+  // Views outside any workspace, the launcher and the shell or windows
+  // mapped while there was no output, are shown on all of them
+  std::copy_if(views_.begin(), views_.end(), std::back_inserter(views), [](auto &view) {
+    return view->workspace == nullptr;
+  });
+
+  return views;
+}
+
+std::vector<std::shared_ptr<View>> Server::workspace_views() const
+{
+  std::vector<std::shared_ptr<View>> filtered_views;
+  std::copy_if(views_.begin(), views_.end(), std::back_inserter(filtered_views), [](auto &view) {
+    return view->workspace == nullptr || view->workspace->active;
+  });
+  return filtered_views;
+}
+
+void Server::schedule_hidden_frames()
+{
+  if (hidden_frame_timer_ != nullptr) {
+    return;
+  }
+
+  hidden_frame_timer_ = platform_->add_timer(HIDDEN_FRAME_INTERVAL_MS,
+    &Server::send_hidden_frames, this);
+}
+
+void Server::schedule_thumbnails()
+{
+  if (thumbnail_timer_ != nullptr) {
+    return;
+  }
+
+  thumbnail_timer_ = platform_->add_timer(THUMBNAIL_FRAME_INTERVAL_MS,
+    &Server::send_thumbnail_frames, this);
+}
+
+// A damaged view may be minimized or on a hidden workspace, with no output
+// drawing a frame for it, so one is asked for
+int Server::send_thumbnail_frames(void *data)
+{
+  Server *server = static_cast<Server*>(data);
+
+  server->platform_->remove_timer(server->thumbnail_timer_);
+  server->thumbnail_timer_ = nullptr;
+
+  server->expire_thumbnails();
+  if (!server->due_thumbnails().empty()) {
+    for (auto &output : server->outputs_) {
+      output->schedule_frame();
+    }
+    return 0;
+  }
+
+  // Damaged too soon after the last redraw, so check back later
+  for (auto &entry : server->thumbnails_) {
+    if (entry.second->dirty()) {
+      server->schedule_thumbnails();
+      break;
+    }
+  }
+
+  return 0;
+}
+
+static void send_frame_done(wlr_surface *surface, int sx, int sy, void *data)
+{
+  auto when = static_cast<timespec*>(data);
+  wlr_surface_send_frame_done(surface, when);
+}
+
+void Server::schedule_overview_frames()
+{
+  if (overview_frame_timer_ != nullptr) {
+    return;
+  }
+
+  overview_frame_timer_ = platform_->add_timer(OVERVIEW_FRAME_INTERVAL_MS,
+    &Server::send_overview_frames, this);
+}
+
+int Server::send_overview_frames(void *data)
+{
+  Server *server = static_cast<Server*>(data);
+
+  server->platform_->remove_timer(server->overview_frame_timer_);
+  server->overview_frame_timer_ = nullptr;
+
+  if (!server->overview_) {
+    return 0;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  for (auto &view : filter_unminimized_views(filter_mapped_views(server->workspace_views()))) {
+    view->for_each_surface(send_frame_done, &now);
+  }
+
+  server->schedule_overview_frames();
+  return 0;
+}
+
+int Server::send_hidden_frames(void *data)
+{
+  Server *server = static_cast<Server*>(data);
+
+  server->platform_->remove_timer(server->hidden_frame_timer_);
+  server->hidden_frame_timer_ = nullptr;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  bool hidden_views = false;
+  for (auto &entry : server->workspaces_) {
+    for (auto &workspace : entry.second) {
+      if (workspace->active) {
+        continue;
+      }
+      for (auto &view : filter_mapped_views(workspace->views())) {
+        view->for_each_surface(send_frame_done, &now);
+        hidden_views = true;
+      }
+    }
+  }
+
+  if (hidden_views) {
+    server->schedule_hidden_frames();
+  }
+
+  return 0;
 }
 
 void Server::position_view(View *view)
 {
   if (view->is_menubar()) {
-    auto output = primary_output();
-    output->set_menubar(view);
+    auto condition = [](auto &el) { return !el->deleted() && el->primary(); };
+    auto result = std::find_if(outputs_.begin(), outputs_.end(), condition);
+    if (result != outputs_.end()) {
+      (*result)->set_menubar(view);
+    }
     return;
   }
 
@@ -0,0 +1,121 @@
+#include "shortcut_config.h"
+
+#include <spdlog/spdlog.h>
+#include <wlroots.h>
+#include <yaml-cpp/yaml.h>
+
+#include <map>
+#include <sstream>
+
+#include "action.h"
+#include "ios.h"
+
+namespace lumin {
+
+ActionType action_type_from_name(const std::string& name)
+{
+  static const std::map<std::string, ActionType> action_types = {
+    { "dock_left", ACTION_DOCK_LEFT },
+    { "dock_right", ACTION_DOCK_RIGHT },
+    { "toggle_maximize", ACTION_TOGGLE_MAXIMIZE },
+    { "minimize_top", ACTION_MINIMIZE_TOP },
+    { "focus_app", ACTION_FOCUS_APP },
+    { "exec", ACTION_EXEC },
+    { "switch_workspace", ACTION_SWITCH_WORKSPACE },
+    { "move_to_workspace", ACTION_MOVE_TO_WORKSPACE },
+    { "toggle_overview", ACTION_TOGGLE_OVERVIEW },
+    { "screenshot", ACTION_SCREENSHOT }
+  };
+
+  auto result = action_types.find(name);
+  if (result == action_types.end()) {
+    return ACTION_NONE;
+  }
+  return result->second;
+}
+
+static int modifier_from_name(const std::string& name)
+{
+  static const std::map<std::string, int> modifiers = {
+    { "shift", WLR_MODIFIER_SHIFT },
+    { "caps", WLR_MODIFIER_CAPS },
+    { "ctrl", WLR_MODIFIER_CTRL },
+    { "alt", WLR_MODIFIER_ALT },
+    { "mod2", WLR_MODIFIER_MOD2 },
+    { "mod3", WLR_MODIFIER_MOD3 },
+    { "logo", WLR_MODIFIER_LOGO },
+    { "mod5", WLR_MODIFIER_MOD5 }
+  };
+
+  auto result = modifiers.find(name);
+  if (result == modifiers.end()) {
+    spdlog::warn("Unknown modifier {}", name);
+    return 0;
+  }
+  return result->second;
+}
+
+ShortcutConfig::ShortcutConfig(const std::shared_ptr<IOS>& os)
+  : os_(os)
+{
+
+}
+
+std::vector<ActionBinding> ShortcutConfig::load()
+{
+  std::vector<ActionBinding> bindings;
+
+  const char *home = getenv("HOME");
+  std::stringstream configFilePathStream;
+  configFilePathStream << home << "/.config/shortcuts";
+  std::string configFilePath = configFilePathStream.str();
+
+  bool configFileExists = os_->file_exists(configFilePath);
+
+  if (!configFileExists) {
+    return bindings;
+  }
+
+  auto configFileData = os_->open_file(configFilePath);
+
+  YAML::Node document;
+  try {
+    document = YAML::Load(configFileData);
+  } catch (const YAML::Exception& e) {
+    spdlog::error("Failed to parse {}: {}", configFilePath, e.what());
+    return bindings;
+  }
+
+  for (auto node : document) {
+    try {
+      auto action_name = node["action"].as<std::string>();
+      auto type = action_type_from_name(action_name);
+
+      if (type == ACTION_NONE) {
+        spdlog::warn("Unknown action {}", action_name);
+        continue;
+      }
+
+      int modifiers = 0;
+      for (auto modifier : node["modifiers"]) {
+        modifiers |= modifier_from_name(modifier.as<std::string>());
+      }
+
+      ActionBinding binding = {
+        .key = node["key"].as<std::string>(),
+        .modifiers = modifiers,
+        .action = {
+          .type = type,
+          .argument = node["argument"].as<std::string>("")
+        }
+      };
+      bindings.push_back(binding);
+    } catch (const YAML::Exception& e) {
+      spdlog::warn("Skipping shortcut in {}: {}", configFilePath, e.what());
+    }
+  }
+
+  return bindings;
+}
+
+}  // namespace lumin
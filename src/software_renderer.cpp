@@ -0,0 +1,224 @@
+#include "software_renderer.h"
+
+#include <wlroots.h>
+
+#include <algorithm>
+
+#include "blit.h"
+#include "draw_list.h"
+
+namespace lumin {
+
+const uint32_t CLEAR_COLOR = 0xff000000;
+
+static void remove_listeners(ShadowBuffer *shadow)
+{
+  wl_list_remove(&shadow->commit.link);
+  wl_list_remove(&shadow->destroy.link);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+  for (auto &it : shadows) {
+    remove_listeners(it.second.get());
+  }
+
+  wl_list_init(&new_surface.link);
+  wl_list_remove(&new_surface.link);
+}
+
+SoftwareRenderer::SoftwareRenderer()
+  : compositor_(nullptr)
+{
+
+}
+
+void SoftwareRenderer::init(wlr_compositor *compositor)
+{
+  compositor_ = compositor;
+
+  new_surface.notify = SoftwareRenderer::new_surface_notify;
+  wl_signal_add(&compositor_->events.new_surface, &new_surface);
+}
+
+const ShadowBuffer* SoftwareRenderer::shadow(const wlr_surface *surface) const
+{
+  auto it = shadows.find(surface);
+  if (it == shadows.end() || !it->second->valid) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+bool SoftwareRenderer::can_composite(const DrawList& draw_list) const
+{
+  // Anything scaled, rotated, faded or without a shadow needs the GL path
+  for (auto &item : draw_list.items()) {
+    if (item.surface == nullptr || item.transform != WL_OUTPUT_TRANSFORM_NORMAL ||
+        item.alpha < 1.0f) {
+      return false;
+    }
+
+    auto shadow_buffer = shadow(item.surface);
+    if (shadow_buffer == nullptr) {
+      return false;
+    }
+
+    if (shadow_buffer->width != item.width || shadow_buffer->height != item.height) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void SoftwareRenderer::composite(const DrawList& draw_list, uint32_t *pixels, int stride,
+  int x, int y, int width, int height) const
+{
+  auto origin = reinterpret_cast<uint8_t*>(pixels);
+  auto at = [origin, stride](int px, int py) {
+    return reinterpret_cast<uint32_t*>(origin + static_cast<long>(py) * stride) + px;
+  };
+
+  blit_fill(at(x, y), stride, CLEAR_COLOR, width, height);
+
+  for (auto &item : draw_list.items()) {
+    auto shadow_buffer = shadow(item.surface);
+    if (shadow_buffer == nullptr) {
+      continue;
+    }
+
+    int x1 = std::max(x, item.x);
+    int y1 = std::max(y, item.y);
+    int x2 = std::min(x + width, item.x + item.width);
+    int y2 = std::min(y + height, item.y + item.height);
+    if (x1 >= x2 || y1 >= y2) {
+      continue;
+    }
+
+    int src_stride = shadow_buffer->width * sizeof(uint32_t);
+    auto src = shadow_buffer->pixels.data() +
+      static_cast<long>(y1 - item.y) * shadow_buffer->width + (x1 - item.x);
+
+    if (shadow_buffer->opaque) {
+      blit_copy(at(x1, y1), stride, src, src_stride, x2 - x1, y2 - y1);
+    } else {
+      blit_over(at(x1, y1), stride, src, src_stride, x2 - x1, y2 - y1);
+    }
+  }
+}
+
+void SoftwareRenderer::track_surface(wlr_surface *surface)
+{
+  auto shadow = std::make_unique<ShadowBuffer>();
+  shadow->surface = surface;
+  shadow->renderer = this;
+  shadow->width = 0;
+  shadow->height = 0;
+  shadow->opaque = false;
+  shadow->valid = false;
+
+  shadow->commit.notify = SoftwareRenderer::surface_commit_notify;
+  wl_signal_add(&surface->events.commit, &shadow->commit);
+
+  shadow->destroy.notify = SoftwareRenderer::surface_destroy_notify;
+  wl_signal_add(&surface->events.destroy, &shadow->destroy);
+
+  shadows[surface] = std::move(shadow);
+}
+
+void SoftwareRenderer::update_shadow(ShadowBuffer *shadow)
+{
+  wlr_surface *surface = shadow->surface;
+
+  // Frame callbacks and state-only commits leave the buffer alone, and by
+  // then it has already been released back to the client
+  if (!(surface->current.committed & WLR_SURFACE_STATE_BUFFER)) {
+    return;
+  }
+
+  wl_shm_buffer *shm_buffer = nullptr;
+  if (surface->current.buffer_resource != nullptr) {
+    shm_buffer = wl_shm_buffer_get(surface->current.buffer_resource);
+  }
+
+  if (shm_buffer == nullptr) {
+    shadow->valid = false;
+    shadow->pixels.clear();
+    return;
+  }
+
+  uint32_t format = wl_shm_buffer_get_format(shm_buffer);
+  if (format != WL_SHM_FORMAT_ARGB8888 && format != WL_SHM_FORMAT_XRGB8888) {
+    shadow->valid = false;
+    shadow->pixels.clear();
+    return;
+  }
+
+  int width = wl_shm_buffer_get_width(shm_buffer);
+  int height = wl_shm_buffer_get_height(shm_buffer);
+  int stride = wl_shm_buffer_get_stride(shm_buffer);
+
+  bool resized = !shadow->valid || width != shadow->width || height != shadow->height;
+  if (resized) {
+    shadow->pixels.resize(static_cast<size_t>(width) * height);
+  }
+
+  shadow->width = width;
+  shadow->height = height;
+  shadow->opaque = format == WL_SHM_FORMAT_XRGB8888;
+  shadow->valid = true;
+
+  int dst_stride = width * sizeof(uint32_t);
+
+  wl_shm_buffer_begin_access(shm_buffer);
+  auto data = static_cast<const uint8_t*>(wl_shm_buffer_get_data(shm_buffer));
+
+  if (resized) {
+    blit_copy(shadow->pixels.data(), dst_stride, reinterpret_cast<const uint32_t*>(data), stride,
+      width, height);
+  } else {
+    // Only what the client said it redrew needs to cross over
+    int nrects;
+    pixman_box32_t *rects = pixman_region32_rectangles(&surface->buffer_damage, &nrects);
+    for (int i = 0; i < nrects; ++i) {
+      int x1 = std::max(rects[i].x1, 0);
+      int y1 = std::max(rects[i].y1, 0);
+      int x2 = std::min(rects[i].x2, width);
+      int y2 = std::min(rects[i].y2, height);
+      if (x1 >= x2 || y1 >= y2) {
+        continue;
+      }
+
+      auto src = reinterpret_cast<const uint32_t*>(data + static_cast<long>(y1) * stride) + x1;
+      auto dst = shadow->pixels.data() + static_cast<long>(y1) * width + x1;
+      blit_copy(dst, dst_stride, src, stride, x2 - x1, y2 - y1);
+    }
+  }
+
+  wl_shm_buffer_end_access(shm_buffer);
+}
+
+void SoftwareRenderer::new_surface_notify(wl_listener *listener, void *data)
+{
+  SoftwareRenderer *renderer = wl_container_of(listener, renderer, new_surface);
+  auto surface = static_cast<wlr_surface*>(data);
+  renderer->track_surface(surface);
+}
+
+void SoftwareRenderer::surface_commit_notify(wl_listener *listener, void *data)
+{
+  ShadowBuffer *shadow = wl_container_of(listener, shadow, commit);
+  shadow->renderer->update_shadow(shadow);
+}
+
+void SoftwareRenderer::surface_destroy_notify(wl_listener *listener, void *data)
+{
+  ShadowBuffer *shadow = wl_container_of(listener, shadow, destroy);
+  auto renderer = shadow->renderer;
+
+  remove_listeners(shadow);
+  renderer->shadows.erase(shadow->surface);
+}
+
+}  // namespace lumin
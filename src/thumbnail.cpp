@@ -0,0 +1,234 @@
+#include "thumbnail.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <wlroots.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "view.h"
+
+namespace lumin {
+
+const int THUMBNAIL_SIZE = 256;
+const int THUMBNAIL_STRIDE = THUMBNAIL_SIZE * 4;
+const int THUMBNAIL_SLOT_SIZE = THUMBNAIL_STRIDE * THUMBNAIL_SIZE;
+const int THUMBNAIL_SLOTS = 2;
+const uint32_t THUMBNAIL_INTERVAL_MS = 500;
+const uint32_t THUMBNAIL_EXPIRY_MS = 30000;
+
+struct thumbnail_data {
+  wlr_renderer *renderer;
+  const float *projection;
+  float scale;
+  int x, y;
+};
+
+static void render_surface(wlr_surface *surface, int sx, int sy, void *data)
+{
+  auto tdata = static_cast<struct thumbnail_data*>(data);
+
+  wlr_texture *texture = wlr_surface_get_texture(surface);
+  if (texture == nullptr) {
+    return;
+  }
+
+  wlr_box box = {
+    .x = static_cast<int>(std::round((sx - tdata->x) * tdata->scale)),
+    .y = static_cast<int>(std::round((sy - tdata->y) * tdata->scale)),
+    .width = static_cast<int>(std::round(surface->current.width * tdata->scale)),
+    .height = static_cast<int>(std::round(surface->current.height * tdata->scale))
+  };
+
+  float matrix[9];
+  auto transform = wlr_output_transform_invert(surface->current.transform);
+  wlr_matrix_project_box(matrix, &box, transform, 0, tdata->projection);
+  wlr_render_texture_with_matrix(tdata->renderer, texture, matrix, 1);
+}
+
+static void flip_rows(uint8_t *data, int stride, int height)
+{
+  std::vector<uint8_t> row(stride);
+  for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom) {
+    std::copy_n(data + top * stride, stride, row.data());
+    std::copy_n(data + bottom * stride, stride, data + top * stride);
+    std::copy_n(row.data(), stride, data + bottom * stride);
+  }
+}
+
+Thumbnail::~Thumbnail()
+{
+  if (data_ != nullptr) {
+    munmap(data_, THUMBNAIL_SLOT_SIZE * THUMBNAIL_SLOTS);
+  }
+
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+Thumbnail::Thumbnail(View *view_)
+  : view(view_)
+  , fd_(-1)
+  , data_(nullptr)
+  , width_(0)
+  , height_(0)
+  , serial_(0)
+  , dirty_(true)
+  , rendered_(false)
+  , rendered_msec_(0)
+  , requested_msec_(0)
+{
+
+}
+
+bool Thumbnail::init()
+{
+  size_t size = THUMBNAIL_SLOT_SIZE * THUMBNAIL_SLOTS;
+
+  fd_ = memfd_create("lumin-thumbnail", MFD_CLOEXEC);
+  if (fd_ == -1) {
+    spdlog::error("Unable to create thumbnail memfd");
+    return false;
+  }
+
+  if (ftruncate(fd_, size) == -1) {
+    spdlog::error("Unable to size thumbnail memfd");
+    return false;
+  }
+
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    spdlog::error("Unable to map thumbnail memfd");
+    return false;
+  }
+
+  data_ = static_cast<uint8_t*>(data);
+  return true;
+}
+
+void Thumbnail::damage()
+{
+  dirty_ = true;
+}
+
+bool Thumbnail::dirty() const
+{
+  return dirty_;
+}
+
+bool Thumbnail::due(uint32_t now_msec) const
+{
+  if (!dirty_) {
+    return false;
+  }
+
+  return !rendered_ || now_msec - rendered_msec_ >= THUMBNAIL_INTERVAL_MS;
+}
+
+void Thumbnail::request(uint32_t now_msec)
+{
+  requested_msec_ = now_msec;
+}
+
+bool Thumbnail::expired(uint32_t now_msec) const
+{
+  return now_msec - requested_msec_ >= THUMBNAIL_EXPIRY_MS;
+}
+
+ThumbnailBuffer Thumbnail::buffer() const
+{
+  ThumbnailBuffer buffer = {
+    .fd = fd_,
+    .width = width_,
+    .height = height_,
+    .stride = THUMBNAIL_STRIDE,
+    .slot_size = THUMBNAIL_SLOT_SIZE,
+    .serial = serial_
+  };
+  return buffer;
+}
+
+// Scales down to fit the thumbnail size keeping the aspect ratio, but never up
+void Thumbnail::fit(int width, int height, int *fit_width, int *fit_height)
+{
+  float scale = std::min({ 1.0f,
+    static_cast<float>(THUMBNAIL_SIZE) / width,
+    static_cast<float>(THUMBNAIL_SIZE) / height });
+
+  *fit_width = std::max(1, static_cast<int>(std::round(width * scale)));
+  *fit_height = std::max(1, static_cast<int>(std::round(height * scale)));
+}
+
+// Must be called with an output's render buffer attached, outside of
+// wlr_renderer_begin and wlr_renderer_end
+void Thumbnail::render(wlr_renderer *renderer, uint32_t now_msec)
+{
+  wlr_box geometry;
+  view->geometry(&geometry);
+  if (geometry.width <= 0 || geometry.height <= 0) {
+    return;
+  }
+
+  int width, height;
+  fit(geometry.width, geometry.height, &width, &height);
+
+  if (!target_.resize(renderer, width, height)) {
+    return;
+  }
+
+  target_.bind();
+
+  wlr_renderer_begin(renderer, width, height);
+  wlr_renderer_scissor(renderer, NULL);
+
+  float transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  wlr_renderer_clear(renderer, transparent);
+
+  float projection[9];
+  wlr_matrix_projection(projection, width, height, WL_OUTPUT_TRANSFORM_NORMAL);
+
+  struct thumbnail_data tdata = {
+    .renderer = renderer,
+    .projection = projection,
+    .scale = static_cast<float>(width) / geometry.width,
+    .x = geometry.x,
+    .y = geometry.y
+  };
+  view->for_each_surface(render_surface, &tdata);
+
+  // The slot for the next serial, the shell may still be reading the other
+  uint8_t *slot = data_ + ((serial_ + 1) % THUMBNAIL_SLOTS) * THUMBNAIL_SLOT_SIZE;
+
+  uint32_t flags = 0;
+  bool read = wlr_renderer_read_pixels(renderer, WL_SHM_FORMAT_ARGB8888, &flags,
+    THUMBNAIL_STRIDE, width, height, 0, 0, 0, 0, slot);
+
+  wlr_renderer_end(renderer);
+
+  target_.unbind();
+
+  if (!read) {
+    return;
+  }
+
+  if (flags & WLR_RENDERER_READ_PIXELS_Y_INVERT) {
+    flip_rows(slot, THUMBNAIL_STRIDE, height);
+  }
+
+  dirty_ = false;
+  rendered_ = true;
+  rendered_msec_ = now_msec;
+
+  width_ = width;
+  height_ = height;
+  serial_++;
+
+  on_render.emit(this);
+}
+
+}  // namespace lumin
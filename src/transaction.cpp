@@ -0,0 +1,163 @@
+#include "transaction.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+#include "iplatform.h"
+#include "view.h"
+
+namespace lumin {
+
+const int TRANSACTION_TIMEOUT_MS = 200;
+
+Transaction::~Transaction()
+{
+  if (timer_ != nullptr) {
+    platform_->remove_timer(timer_);
+  }
+}
+
+Transaction::Transaction(IPlatform *platform)
+  : platform_(platform)
+  , timer_(nullptr)
+  , committed_(false)
+  , done_(false)
+{
+
+}
+
+void Transaction::add(View *view, int x, int y, int width, int height)
+{
+  auto condition = [view](auto &el) { return el.view == view; };
+  auto result = std::find_if(instructions_.begin(), instructions_.end(), condition);
+
+  if (result != instructions_.end()) {
+    (*result).x = x;
+    (*result).y = y;
+    (*result).width = width;
+    (*result).height = height;
+    return;
+  }
+
+  Instruction instruction = {
+    .view = view,
+    .x = x,
+    .y = y,
+    .width = width,
+    .height = height,
+    .serial = 0,
+    .ready = false
+  };
+  instructions_.push_back(instruction);
+}
+
+void Transaction::remove(View *view)
+{
+  std::erase_if(instructions_, [view](const auto &el) { return el.view == view; });
+
+  if (committed_ && ready()) {
+    apply();
+  }
+}
+
+bool Transaction::contains(const View *view) const
+{
+  auto condition = [view](auto &el) { return el.view == view; };
+  auto result = std::find_if(instructions_.begin(), instructions_.end(), condition);
+  return result != instructions_.end();
+}
+
+bool Transaction::empty() const
+{
+  return instructions_.empty();
+}
+
+std::vector<View*> Transaction::views() const
+{
+  std::vector<View*> views;
+  for (auto &instruction : instructions_) {
+    views.push_back(instruction.view);
+  }
+  return views;
+}
+
+void Transaction::commit()
+{
+  for (auto &instruction : instructions_) {
+    instruction.view->save_buffers();
+    instruction.serial = instruction.view->set_size(instruction.width, instruction.height);
+
+    // No configure was sent when the size didn't change, so there is no
+    // commit to wait for and an idle client might never send one
+    if (instruction.serial == 0) {
+      instruction.ready = true;
+    }
+  }
+
+  committed_ = true;
+
+  if (ready()) {
+    apply();
+    return;
+  }
+
+  timer_ = platform_->add_timer(TRANSACTION_TIMEOUT_MS, &Transaction::timeout_notify, this);
+}
+
+void Transaction::view_committed(View *view)
+{
+  if (!committed_ || done_) {
+    return;
+  }
+
+  uint32_t serial = view->configure_serial();
+
+  for (auto &instruction : instructions_) {
+    if (instruction.view == view && serial >= instruction.serial) {
+      instruction.ready = true;
+    }
+  }
+
+  if (ready()) {
+    apply();
+  }
+}
+
+bool Transaction::ready() const
+{
+  return std::all_of(instructions_.begin(), instructions_.end(), [](auto &el) {
+    return el.ready;
+  });
+}
+
+bool Transaction::done() const
+{
+  return done_;
+}
+
+void Transaction::apply()
+{
+  if (done_) {
+    return;
+  }
+
+  done_ = true;
+
+  for (auto &instruction : instructions_) {
+    instruction.view->release_buffers();
+    instruction.view->move(instruction.x, instruction.y);
+  }
+
+  on_apply.emit(this);
+}
+
+int Transaction::timeout_notify(void *data)
+{
+  auto transaction = static_cast<Transaction*>(data);
+  spdlog::debug("Transaction timed out waiting for {} views", transaction->instructions_.size());
+  transaction->apply();
+  return 0;
+}
+
+}  // namespace lumin
@@ -19,6 +19,14 @@ View::View(ICursor *cursor, wlr_output_layout *layout, Seat *seat)
   , y(0)
   , minimized(false)
   , deleted(false)
+  , workspace(nullptr)
+  , animating(false)
+  , animation({
+    .x = 0,
+    .y = 0,
+    .width = 0,
+    .height = 0,
+    .alpha = 1.0f })
   , state(WM_WINDOW_STATE_WINDOW)
   , saved_state_({
     .width = DEFAULT_MINIMUM_WIDTH,
@@ -138,6 +146,8 @@ ViewLayer View::layer() const
   return VIEW_LAYER_TOP;
 }
 
+// Transitional, lumin-menu still maps an xdg toplevel rather than a
+// layer surface
 bool View::is_menubar() const
 {
   bool result = id().compare("org.os.Menu") == 0;
@@ -190,12 +200,10 @@ void View::tile_left()
     return;
   }
 
-  int width = (output->width / 2.0f) / output->scale;
-  int height = output->height / output->scale;
-  resize(width, height - MENU_HEIGHT);
-  move(0, MENU_HEIGHT);
+  wlr_box area = static_cast<Output*>(output->data)->usable_area();
 
-  wlr_output_layout_output_coords(layout_, output, &x, &y);
+  int width = area.width / 2;
+  configure(area.x, area.y, width, area.height);
 }
 
 void View::tile_right()
@@ -214,18 +222,11 @@ void View::tile_right()
     return;
   }
 
-  int new_y = MENU_HEIGHT;
-  int new_x = 0;
-
-  wlr_output_layout_output_coords(layout_, output, &x, &y);
+  wlr_box area = static_cast<Output*>(output->data)->usable_area();
 
   // middle of the screen
-  new_x += (output->width / 2.0f) / output->scale;
-
-  int width = (output->width / 2.0f) / output->scale;
-  int height = output->height / output->scale;
-  resize(width, height - MENU_HEIGHT);
-  move(new_x, new_y);
+  int width = area.width / 2;
+  configure(area.x + width, area.y, area.width - width, area.height);
 }
 
 void View::maximize()
@@ -249,6 +250,10 @@ void View::maximize()
     set_tiled(WLR_EDGE_NONE);
   }
 
+  if (fullscreen()) {
+    set_fullscreen(false);
+  }
+
   set_maximized(true);
 
   Output *output = static_cast<Output*>(wlr_output->data);
@@ -257,6 +262,45 @@ void View::maximize()
   state = WM_WINDOW_STATE_MAXIMIZED;
 }
 
+// Goes to the output the client asked for, or else the one the view is
+// centered on. Outputs that left the layout have nowhere to put it.
+void View::enter_fullscreen(wlr_output *requested)
+{
+  if (fullscreen()) {
+    return;
+  }
+
+  wlr_output* wlr_output = requested;
+  if (wlr_output == nullptr || wlr_output_layout_get(layout_, wlr_output) == nullptr) {
+    wlr_box box;
+    geometry(&box);
+
+    int center_x = x + box.x + (box.width / 2.0f);
+    int center_y = y + box.y + (box.height / 2.0f);
+    wlr_output = wlr_output_layout_output_at(layout_, center_x, center_y);
+  }
+
+  if (wlr_output == nullptr) {
+    spdlog::warn("Failed to get output for fullscreen");
+    return;
+  }
+
+  save_geometry();
+
+  if (tiled()) {
+    set_tiled(WLR_EDGE_NONE);
+  } else if (maximized()) {
+    set_maximized(false);
+  }
+
+  set_fullscreen(true);
+
+  Output *output = static_cast<Output*>(wlr_output->data);
+  output->fullscreen_view(this);
+
+  state = WM_WINDOW_STATE_FULLSCREEN;
+}
+
 void View::windowize()
 {
   if (windowed()) {
@@ -274,12 +318,23 @@ void View::windowize()
     set_tiled(WLR_EDGE_NONE);
   } else if (maximized()) {
     set_maximized(false);
+  } else if (fullscreen()) {
+    set_fullscreen(false);
   }
 
-  set_size(saved_state_.width, saved_state_.height);
-
   Output *output = static_cast<Output*>(wlr_output->data);
-  output->move_view(this, saved_state_.x, saved_state_.y);
+
+  wlr_box box;
+  geometry(&box);
+
+  wlr_box area = output->usable_area();
+
+  int new_y = saved_state_.y;
+  if (new_y + box.y < area.y) {
+    new_y = area.y - box.y;
+  }
+
+  configure(saved_state_.x, new_y, saved_state_.width, saved_state_.height);
 
   state = WM_WINDOW_STATE_WINDOW;
 }
@@ -297,10 +352,66 @@ void View::tile(int edges)
     set_maximized(false);
   }
 
+  if (fullscreen()) {
+    set_fullscreen(false);
+  }
+
   set_tiled(edges);
   state = WM_WINDOW_STATE_TILED;
 }
 
+void View::configure(int new_x, int new_y, int width, int height)
+{
+  on_configure.emit(this, new_x, new_y, width, height);
+}
+
+static void save_surface_buffer(wlr_surface *surface, int sx, int sy, void *data)
+{
+  if (surface->buffer == nullptr) {
+    return;
+  }
+
+  auto saved_buffers = static_cast<std::vector<SavedBuffer>*>(data);
+  SavedBuffer saved_buffer = {
+    .buffer = wlr_buffer_ref(surface->buffer),
+    .x = sx,
+    .y = sy,
+    .width = surface->current.width,
+    .height = surface->current.height,
+    .transform = surface->current.transform
+  };
+  saved_buffers->push_back(saved_buffer);
+}
+
+// Subsurfaces and popups are saved along with the main surface, so the
+// whole view keeps its old look until the transaction is applied
+void View::save_buffers()
+{
+  if (!saved_buffers_.empty()) {
+    return;
+  }
+
+  wlr_surface *wlr_surface = surface();
+  if (wlr_surface == nullptr || wlr_surface->buffer == nullptr) {
+    return;
+  }
+
+  for_each_surface(save_surface_buffer, &saved_buffers_);
+}
+
+void View::release_buffers()
+{
+  for (auto &saved_buffer : saved_buffers_) {
+    wlr_buffer_unref(saved_buffer.buffer);
+  }
+  saved_buffers_.clear();
+}
+
+const std::vector<SavedBuffer>& View::saved_buffers() const
+{
+  return saved_buffers_;
+}
+
 void View::grab()
 {
   if (windowed()) {
@@ -315,6 +426,10 @@ void View::grab()
     set_maximized(false);
   }
 
+  if (fullscreen()) {
+    set_fullscreen(false);
+  }
+
   wlr_box box;
   geometry(&box);
 
@@ -0,0 +1,67 @@
+#include "virtual_output_config.h"
+
+#include <spdlog/spdlog.h>
+#include <yaml-cpp/yaml.h>
+
+#include <cmath>
+#include <sstream>
+
+#include "ios.h"
+
+namespace lumin {
+
+VirtualOutputConfig::VirtualOutputConfig(const std::shared_ptr<IOS>& os)
+  : os_(os)
+{
+
+}
+
+std::vector<OutputConfig> VirtualOutputConfig::load()
+{
+  std::vector<OutputConfig> outputs;
+
+  const char *home = getenv("HOME");
+  std::stringstream configFilePathStream;
+  configFilePathStream << home << "/.config/virtual_outputs";
+  std::string configFilePath = configFilePathStream.str();
+
+  bool configFileExists = os_->file_exists(configFilePath);
+
+  if (!configFileExists) {
+    return outputs;
+  }
+
+  auto configFileData = os_->open_file(configFilePath);
+
+  YAML::Node document;
+  try {
+    document = YAML::Load(configFileData);
+  } catch (const YAML::Exception& e) {
+    spdlog::error("Failed to parse {}: {}", configFilePath, e.what());
+    return outputs;
+  }
+
+  for (auto node : document) {
+    try {
+      OutputConfig config = {
+        .scale = node["scale"].as<float>(1.0f),
+        .primary = false,
+        .enabled = true,
+        .x = node["x"].as<int>(0),
+        .y = node["y"].as<int>(0),
+        .mode = OUTPUT_MODE_EXPLICIT,
+        .width = node["width"].as<int>(),
+        .height = node["height"].as<int>(),
+        .refresh = static_cast<int>(std::lround(node["refresh"].as<double>(60) * 1000)),
+        .mirror = node["mirror"].as<std::string>("")
+      };
+      outputs.push_back(config);
+    } catch (const YAML::Exception& e) {
+      spdlog::warn("Skipping virtual output in {}: {}", configFilePath, e.what());
+    }
+  }
+
+  return outputs;
+}
+
+}  // namespace lumin
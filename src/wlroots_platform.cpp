@@ -1,25 +1,61 @@
 #include "wlroots_platform.h"
 
 #include <wlroots.h>
+#include <GLES2/gl2.h>
+#include <algorithm>
 #include <iostream>
 #include <spdlog/spdlog.h>
 
 #include "cursor.h"
+#include "blit.h"
 #include "keyboard.h"
+#include "keymap_cache.h"
+#include "layer_surface.h"
 #include "seat.h"
 #include "output.h"
+#include "output_manager.h"
+#include "screencopy.h"
+#include "software_renderer.h"
 #include "xdg_view.h"
+#include "xwayland_view.h"
 #include "gtk_shell.h"
 
 namespace lumin {
 
+// Mesa's GL implementations that run entirely on the CPU
+static bool software_gl(wlr_backend *backend)
+{
+  auto egl = wlr_backend_get_egl(backend);
+  if (egl == nullptr || !wlr_egl_make_current(egl, EGL_NO_SURFACE, NULL)) {
+    return false;
+  }
+
+  auto name = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+  if (name == nullptr) {
+    return false;
+  }
+
+  std::string renderer = name;
+  return renderer.find("llvmpipe") != std::string::npos ||
+    renderer.find("softpipe") != std::string::npos ||
+    renderer.find("Software Rasterizer") != std::string::npos;
+}
+
 WlRootsPlatform::WlRootsPlatform()
+  : xwayland_(nullptr)
+  , xwayland_idle_timer_(nullptr)
+  , xwayland_idle_timeout_(0)
+  , xwayland_views_(0)
 {
 
 }
 
 WlRootsPlatform::WlRootsPlatform(const std::shared_ptr<ICursor>& cursor)
-  : cursor_(cursor)
+  : xwayland_(nullptr)
+  , xwayland_idle_timer_(nullptr)
+  , xwayland_idle_timeout_(0)
+  , xwayland_views_(0)
+  , cursor_(cursor)
 {
 
 }
@@ -59,13 +95,30 @@ bool WlRootsPlatform::init()
     return false;
   }
 
-  auto compositor = wlr_compositor_create(display_, renderer_);
+  // Virtual outputs are added to the headless backend on demand, next to
+  // whichever backend drives the real outputs
+  headless_backend_ = wlr_headless_backend_create_with_renderer(display_, renderer_);
+
+  if (!headless_backend_) {
+    spdlog::error("Failed to create wlr headless backend");
+    return false;
+  }
+
+  wlr_multi_backend_add(backend_, headless_backend_);
+
+  compositor_ = wlr_compositor_create(display_, renderer_);
 
-  if (!compositor) {
+  if (!compositor_) {
     spdlog::error("Failed to create wlr compositor");
     return false;
   }
 
+  if (software_gl(backend_)) {
+    software_renderer_ = std::make_shared<SoftwareRenderer>();
+    software_renderer_->init(compositor_);
+    spdlog::info("No hardware renderer, compositing on the CPU with {} kernels", blit_kernels());
+  }
+
   auto data_device_manager = wlr_data_device_manager_create(display_);
 
   if (!data_device_manager) {
@@ -87,6 +140,13 @@ bool WlRootsPlatform::init()
     return false;
   }
 
+  layer_shell_ = wlr_layer_shell_v1_create(display_);
+
+  if (!layer_shell_) {
+    spdlog::error("Failed to create wlr layer shell");
+    return false;
+  }
+
   xcursor_manager_ = wlr_xcursor_manager_create("default", 24);
 
   if (!xcursor_manager_) {
@@ -108,13 +168,15 @@ bool WlRootsPlatform::init()
     return false;
   }
 
-  output_manager_ = wlr_output_manager_v1_create(display_);
+  auto output_manager = wlr_output_manager_v1_create(display_);
 
-  if (!output_manager_) {
+  if (!output_manager) {
     spdlog::error("Failed to create wlr output manager");
     return false;
   }
 
+  output_manager_ = std::make_shared<OutputManager>(output_manager, layout_);
+
   auto xdg_output_manager = wlr_xdg_output_manager_v1_create(display_, layout_);
 
   if (!xdg_output_manager) {
@@ -122,25 +184,21 @@ bool WlRootsPlatform::init()
     return false;
   }
 
-  auto screencopy_manager = wlr_screencopy_manager_v1_create(display_);
-
-  if (!screencopy_manager) {
-    spdlog::error("Failed to create wlr screenscopy manager");
-    return false;
-  }
+  screencopy_manager_ = std::make_shared<ScreencopyManager>(display_, layout_);
 
   gtk_shell_create(display_);
 
-  wlr_seat *seat = wlr_seat_create(display_, "seat0");
+  wlr_seat_ = wlr_seat_create(display_, "seat0");
 
-  if (!seat) {
+  if (!wlr_seat_) {
     spdlog::error("Failed to create wlr seat");
     return false;
   }
 
 
-  seat_ = std::make_shared<Seat>(seat);
-  cursor_ = std::make_shared<Cursor>(layout_, seat_.get());
+  seat_ = std::make_shared<Seat>(wlr_seat_);
+  keymap_cache_ = std::make_shared<KeymapCache>();
+  cursor_ = std::make_shared<Cursor>(layout_, seat_.get(), xcursor_manager_);
 
   seat_->set_pointer(cursor_);
 
@@ -167,9 +225,16 @@ bool WlRootsPlatform::start()
   new_surface.notify = new_surface_notify;
   wl_signal_add(&xdg_shell_->events.new_surface, &new_surface);
 
+  new_layer_surface.notify = new_layer_surface_notify;
+  wl_signal_add(&layer_shell_->events.new_surface, &new_layer_surface);
+
   new_input.notify = new_input_notify;
   wl_signal_add(&backend_->events.new_input, &new_input);
 
+  if (!start_xwayland()) {
+    return false;
+  }
+
   if (!wlr_backend_start(backend_)) {
     spdlog::error("Failed to start wlr backend");
     wlr_backend_destroy(backend_);
@@ -189,12 +254,14 @@ void WlRootsPlatform::new_output_notify(wl_listener *listener, void *data)
 
   auto damage = wlr_output_damage_create(wlr_output);
   auto output = std::make_shared<Output>(wlr_output,
-    platform->renderer_, damage, platform->layout_);
+    platform->renderer_, damage, platform->layout_, platform->software_renderer_.get());
 
   wlr_output->data = output.get();
 
   output->init();
 
+  platform->output_manager_->add_output(output.get());
+  platform->screencopy_manager_->add_output(output.get());
   platform->on_new_output.emit(output);
 }
 
@@ -218,9 +285,149 @@ void WlRootsPlatform::new_surface_notify(wl_listener *listener, void *data)
   platform->on_new_view.emit(view);
 }
 
+void WlRootsPlatform::new_layer_surface_notify(wl_listener *listener, void *data)
+{
+  WlRootsPlatform *platform = wl_container_of(listener, platform, new_layer_surface);
+  auto layer_surface = static_cast<wlr_layer_surface_v1*>(data);
+
+  // Clients may leave the output to the compositor
+  if (layer_surface->output == nullptr) {
+    auto cursor = platform->cursor_;
+    auto output = platform->output_at(cursor->x(), cursor->y());
+
+    if (output == nullptr) {
+      spdlog::warn("No output for layer surface {}", layer_surface->namespace_);
+      wlr_layer_surface_v1_close(layer_surface);
+      return;
+    }
+
+    layer_surface->output = output->wlr_output;
+  }
+
+  auto surface = std::make_shared<LayerSurface>(layer_surface);
+  platform->on_new_layer_surface.emit(surface);
+}
+
+bool WlRootsPlatform::start_xwayland()
+{
+  // Lazy mode only advertises the X socket, the Xwayland server itself is
+  // spawned when the first X11 client connects to it
+  xwayland_ = wlr_xwayland_create(display_, compositor_, true);
+
+  if (!xwayland_) {
+    spdlog::error("Failed to create wlr xwayland");
+    return false;
+  }
+
+  xwayland_ready.notify = xwayland_ready_notify;
+  wl_signal_add(&xwayland_->events.ready, &xwayland_ready);
+
+  new_xwayland_surface.notify = new_xwayland_surface_notify;
+  wl_signal_add(&xwayland_->events.new_surface, &new_xwayland_surface);
+
+  setenv("DISPLAY", xwayland_->display_name, true);
+  spdlog::info("DISPLAY={}", xwayland_->display_name);
+
+  return true;
+}
+
+void WlRootsPlatform::stop_xwayland()
+{
+  if (xwayland_ == nullptr) {
+    return;
+  }
+
+  if (xwayland_idle_timer_ != nullptr) {
+    remove_timer(xwayland_idle_timer_);
+    xwayland_idle_timer_ = nullptr;
+  }
+
+  wl_list_remove(&xwayland_ready.link);
+  wl_list_remove(&new_xwayland_surface.link);
+
+  wlr_xwayland_destroy(xwayland_);
+  xwayland_ = nullptr;
+}
+
+void WlRootsPlatform::set_xwayland_idle_timeout(int seconds)
+{
+  xwayland_idle_timeout_ = seconds;
+}
+
+void WlRootsPlatform::schedule_xwayland_idle()
+{
+  if (xwayland_idle_timeout_ == 0 || xwayland_views_ > 0) {
+    return;
+  }
+
+  int timeout_ms = xwayland_idle_timeout_ * 1000;
+
+  if (xwayland_idle_timer_ != nullptr) {
+    wl_event_source_timer_update(xwayland_idle_timer_, timeout_ms);
+    return;
+  }
+
+  xwayland_idle_timer_ = add_timer(timeout_ms, xwayland_idle_notify, this);
+}
+
+int WlRootsPlatform::xwayland_idle_notify(void *data)
+{
+  auto platform = static_cast<WlRootsPlatform*>(data);
+
+  platform->remove_timer(platform->xwayland_idle_timer_);
+  platform->xwayland_idle_timer_ = nullptr;
+
+  if (platform->xwayland_views_ > 0) {
+    return 0;
+  }
+
+  // wlroots has no way to stop a running Xwayland and keep the socket, so
+  // swap in a fresh lazy instance which starts again on the next connection
+  spdlog::info("Stopping idle Xwayland");
+  platform->stop_xwayland();
+  platform->start_xwayland();
+
+  return 0;
+}
+
+void WlRootsPlatform::xwayland_ready_notify(wl_listener *listener, void *data)
+{
+  WlRootsPlatform *platform = wl_container_of(listener, platform, xwayland_ready);
+
+  wlr_xwayland_set_seat(platform->xwayland_, platform->wlr_seat_);
+
+  // Clients which never open a window still keep Xwayland alive otherwise
+  platform->schedule_xwayland_idle();
+}
+
+void WlRootsPlatform::new_xwayland_surface_notify(wl_listener *listener, void *data)
+{
+  WlRootsPlatform *platform = wl_container_of(listener, platform, new_xwayland_surface);
+  auto xwayland_surface = static_cast<wlr_xwayland_surface*>(data);
+
+  if (platform->xwayland_idle_timer_ != nullptr) {
+    platform->remove_timer(platform->xwayland_idle_timer_);
+    platform->xwayland_idle_timer_ = nullptr;
+  }
+
+  std::shared_ptr<View> view = std::make_shared<XWaylandView>(xwayland_surface,
+    platform->cursor_.get(), platform->layout_, platform->seat_.get());
+
+  platform->xwayland_views_++;
+  view->on_destroy.connect_member(platform, &WlRootsPlatform::xwayland_view_destroyed);
+
+  platform->on_new_view.emit(view);
+}
+
+void WlRootsPlatform::xwayland_view_destroyed(View *view)
+{
+  xwayland_views_--;
+  schedule_xwayland_idle();
+}
+
 void WlRootsPlatform::new_keyboard(wlr_input_device *device)
 {
-  auto keyboard = std::make_shared<Keyboard>(device, seat_.get());
+  auto keyboard = std::make_shared<Keyboard>(device, seat_.get(), keymap_cache_.get());
   keyboard->setup();
   on_new_keyboard.emit(keyboard);
 }
@@ -275,6 +482,7 @@ void WlRootsPlatform::run()
 
 void WlRootsPlatform::destroy()
 {
+  stop_xwayland();
   wl_display_destroy_clients(display_);
   wlr_xcursor_manager_destroy(xcursor_manager_);
   wlr_backend_destroy(backend_);
@@ -293,12 +501,31 @@ void WlRootsPlatform::add_idle(idle_func func, void* data)
   wl_event_loop_add_idle(event_loop, func, data);
 }
 
+wl_event_source* WlRootsPlatform::add_timer(int timeout_ms, timer_func func, void* data)
+{
+  auto *event_loop = wl_display_get_event_loop(display_);
+  auto *timer = wl_event_loop_add_timer(event_loop, func, data);
+  wl_event_source_timer_update(timer, timeout_ms);
+  return timer;
+}
+
+void WlRootsPlatform::remove_timer(wl_event_source *timer)
+{
+  wl_event_source_remove(timer);
+}
+
+wl_event_source* WlRootsPlatform::add_fd(int fd, fd_func func, void* data)
+{
+  auto *event_loop = wl_display_get_event_loop(display_);
+  return wl_event_loop_add_fd(event_loop, fd, WL_EVENT_READABLE, func, data);
+}
+
 std::shared_ptr<Seat> WlRootsPlatform::seat() const
 {
   return seat_;
 }
 
-Output* WlRootsPlatform::output_at(int x, int y) const
+Output* WlRootsPlatform::output_at(double x, double y) const
 {
   wlr_output* wlr_output = wlr_output_layout_output_at(layout_, x, y);
 
@@ -310,4 +537,34 @@ Output* WlRootsPlatform::output_at(int x, int y) const
   return output;
 }
 
+std::string WlRootsPlatform::create_virtual_output(int width, int height)
+{
+  auto wlr_output = wlr_headless_add_output(headless_backend_, width, height);
+
+  if (wlr_output == nullptr) {
+    spdlog::error("Failed to create virtual output {}x{}", width, height);
+    return "";
+  }
+
+  virtual_outputs_.push_back(wlr_output);
+
+  Output *output = static_cast<Output*>(wlr_output->data);
+  return output->id();
+}
+
+bool WlRootsPlatform::destroy_virtual_output(const std::string& id)
+{
+  auto condition = [id](auto &el) { return static_cast<Output*>(el->data)->id() == id; };
+  auto result = std::find_if(virtual_outputs_.begin(), virtual_outputs_.end(), condition);
+
+  if (result == virtual_outputs_.end()) {
+    return false;
+  }
+
+  auto wlr_output = *result;
+  virtual_outputs_.erase(result);
+  wlr_output_destroy(wlr_output);
+  return true;
+}
+
 }  // namespace lumin
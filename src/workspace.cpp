@@ -0,0 +1,64 @@
+#include "workspace.h"
+
+#include <algorithm>
+
+#include "view.h"
+
+namespace lumin {
+
+Workspace::Workspace(const std::string& output, int index)
+  : output(output)
+  , index(index)
+  , active(false)
+{
+
+}
+
+void Workspace::add_view(const std::shared_ptr<View>& view)
+{
+  if (has_view(view.get())) {
+    return;
+  }
+
+  views_.insert(views_.begin(), view);
+}
+
+void Workspace::remove_view(const View *view)
+{
+  std::erase_if(views_, [view](const auto &el) { return el.get() == view; });
+}
+
+bool Workspace::has_view(const View *view) const
+{
+  auto condition = [view](const auto &el) { return el.get() == view; };
+  return std::find_if(views_.begin(), views_.end(), condition) != views_.end();
+}
+
+void Workspace::raise_view(const View *view)
+{
+  auto condition = [view](const auto &el) { return el.get() == view; };
+  auto result = std::find_if(views_.begin(), views_.end(), condition);
+  if (result == views_.end()) {
+    return;
+  }
+
+  std::rotate(views_.begin(), result, result + 1);
+}
+
+void Workspace::lower_view(const View *view)
+{
+  auto condition = [view](const auto &el) { return el.get() == view; };
+  auto result = std::find_if(views_.begin(), views_.end(), condition);
+  if (result == views_.end()) {
+    return;
+  }
+
+  std::rotate(result, result + 1, views_.end());
+}
+
+const std::vector<std::shared_ptr<View>>& Workspace::views() const
+{
+  return views_;
+}
+
+}  // namespace lumin
@@ -105,6 +105,11 @@ void XDGView::set_maximized(bool maximized)
   wlr_xdg_toplevel_set_maximized(xdg_surface_, maximized);
 }
 
+void XDGView::set_fullscreen(bool fullscreen)
+{
+  wlr_xdg_toplevel_set_fullscreen(xdg_surface_, fullscreen);
+}
+
 void XDGView::for_each_surface(wlr_surface_iterator_func_t iterator, void *data) const
 {
   if (xdg_surface_->surface == NULL) {
@@ -139,9 +144,14 @@ bool XDGView::has_surface(const wlr_surface *surface) const
   return xdg_surface_->surface == surface;
 }
 
-void XDGView::set_size(int width, int height)
+uint32_t XDGView::set_size(int width, int height)
 {
-  wlr_xdg_toplevel_set_size(xdg_surface_, width, height);
+  return wlr_xdg_toplevel_set_size(xdg_surface_, width, height);
+}
+
+uint32_t XDGView::configure_serial() const
+{
+  return xdg_surface_->configure_serial;
 }
 
 void XDGView::geometry(wlr_box *box) const {
@@ -233,7 +243,12 @@ void XDGView::xdg_toplevel_request_fullscreen_notify(wl_listener *listener, void
 {
   auto event = static_cast<wlr_xdg_toplevel_set_fullscreen_event*>(data);
   XDGView *view = wl_container_of(listener, view, request_fullscreen);
-  view->state = event->fullscreen ? WM_WINDOW_STATE_FULLSCREEN : WM_WINDOW_STATE_WINDOW;
+
+  if (event->fullscreen) {
+    view->enter_fullscreen(event->output);
+  } else {
+    view->windowize();
+  }
 }
 
 void XDGView::xdg_surface_destroy_notify(wl_listener *listener, void *data)
@@ -281,6 +296,7 @@ void XDGView::xdg_popup_commit_notify(wl_listener *listener, void *data)
 void XDGView::xdg_surface_commit_notify(wl_listener *listener, void *data)
 {
   XDGView *view = wl_container_of(listener, view, commit);
+  view->on_commit.emit(view);
   if (view->mapped) {
     view->on_damage.emit(view);
   }
@@ -0,0 +1,53 @@
+#include "xwayland_config.h"
+
+#include <spdlog/spdlog.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "ios.h"
+
+// Seconds without any X11 window before Xwayland is shut down again
+const int DEFAULT_IDLE_TIMEOUT = 60;
+
+namespace lumin {
+
+XWaylandConfig::XWaylandConfig(const std::shared_ptr<IOS>& os)
+  : os_(os)
+{
+
+}
+
+XWaylandSettings XWaylandConfig::load()
+{
+  XWaylandSettings settings = {
+    .idle_timeout = DEFAULT_IDLE_TIMEOUT
+  };
+
+  const char *home = getenv("HOME");
+  std::stringstream configFilePathStream;
+  configFilePathStream << home << "/.config/xwayland";
+  std::string configFilePath = configFilePathStream.str();
+
+  bool configFileExists = os_->file_exists(configFilePath);
+
+  if (!configFileExists) {
+    return settings;
+  }
+
+  auto configFileData = os_->open_file(configFilePath);
+
+  try {
+    auto document = YAML::Load(configFileData);
+
+    // 0 keeps Xwayland running once it has been started
+    settings.idle_timeout = std::max(document["idle_timeout"].as<int>(DEFAULT_IDLE_TIMEOUT), 0);
+  } catch (const YAML::Exception& e) {
+    spdlog::error("Failed to parse {}: {}", configFilePath, e.what());
+  }
+
+  return settings;
+}
+
+}  // namespace lumin
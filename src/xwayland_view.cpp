@@ -0,0 +1,354 @@
+#include "xwayland_view.h"
+
+#include <wlroots.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+#include "cursor_mode.h"
+#include "cursor.h"
+#include "output.h"
+#include "seat.h"
+
+namespace lumin {
+
+XWaylandView::XWaylandView(wlr_xwayland_surface *surface, ICursor *cursor,
+  wlr_output_layout *layout, Seat *seat)
+  : View(cursor, layout, seat)
+  , xwayland_surface_(surface)
+{
+  map.notify = XWaylandView::xwayland_surface_map_notify;
+  wl_signal_add(&xwayland_surface_->events.map, &map);
+
+  unmap.notify = XWaylandView::xwayland_surface_unmap_notify;
+  wl_signal_add(&xwayland_surface_->events.unmap, &unmap);
+
+  destroy.notify = XWaylandView::xwayland_surface_destroy_notify;
+  wl_signal_add(&xwayland_surface_->events.destroy, &destroy);
+
+  request_configure.notify = XWaylandView::xwayland_surface_request_configure_notify;
+  wl_signal_add(&xwayland_surface_->events.request_configure, &request_configure);
+
+  request_move.notify = XWaylandView::xwayland_surface_request_move_notify;
+  wl_signal_add(&xwayland_surface_->events.request_move, &request_move);
+
+  request_resize.notify = XWaylandView::xwayland_surface_request_resize_notify;
+  wl_signal_add(&xwayland_surface_->events.request_resize, &request_resize);
+
+  request_maximize.notify = XWaylandView::xwayland_surface_request_maximize_notify;
+  wl_signal_add(&xwayland_surface_->events.request_maximize, &request_maximize);
+
+  request_fullscreen.notify = XWaylandView::xwayland_surface_request_fullscreen_notify;
+  wl_signal_add(&xwayland_surface_->events.request_fullscreen, &request_fullscreen);
+
+  set_geometry.notify = XWaylandView::xwayland_surface_set_geometry_notify;
+  wl_signal_add(&xwayland_surface_->events.set_geometry, &set_geometry);
+
+  surface->data = this;
+}
+
+std::string XWaylandView::id() const
+{
+  if (xwayland_surface_->class_ == nullptr) {
+    return "";
+  }
+
+  return xwayland_surface_->class_;
+}
+
+std::string XWaylandView::title() const
+{
+  if (xwayland_surface_->title == nullptr) {
+    return "";
+  }
+
+  return xwayland_surface_->title;
+}
+
+uint XWaylandView::min_width() const
+{
+  if (xwayland_surface_->size_hints == nullptr) {
+    return 0;
+  }
+
+  return std::max(xwayland_surface_->size_hints->min_width, 0);
+}
+
+uint XWaylandView::min_height() const
+{
+  if (xwayland_surface_->size_hints == nullptr) {
+    return 0;
+  }
+
+  return std::max(xwayland_surface_->size_hints->min_height, 0);
+}
+
+static void xwayland_surface_send_enter(wlr_surface *surface, int sx, int sy, void *data)
+{
+  auto output = static_cast<wlr_output*>(data);
+  wlr_surface_send_enter(surface, output);
+}
+
+void XWaylandView::enter(const Output* output)
+{
+  for_each_surface(xwayland_surface_send_enter, output->wlr_output);
+}
+
+void XWaylandView::set_tiled(int edges)
+{
+  // X11 has no notion of tiling, maximized is the closest match for the decorations
+  wlr_xwayland_surface_set_maximized(xwayland_surface_, edges != WLR_EDGE_NONE);
+}
+
+void XWaylandView::set_maximized(bool maximized)
+{
+  wlr_xwayland_surface_set_maximized(xwayland_surface_, maximized);
+}
+
+void XWaylandView::set_fullscreen(bool fullscreen)
+{
+  wlr_xwayland_surface_set_fullscreen(xwayland_surface_, fullscreen);
+}
+
+uint32_t XWaylandView::set_size(int width, int height)
+{
+  // X11 configures are applied synchronously, there is no serial to wait on
+  wlr_xwayland_surface_configure(xwayland_surface_, x, y, width, height);
+  return 0;
+}
+
+uint32_t XWaylandView::configure_serial() const
+{
+  return 0;
+}
+
+void XWaylandView::for_each_surface(wlr_surface_iterator_func_t iterator, void *data) const
+{
+  if (xwayland_surface_->surface == NULL) {
+    return;
+  }
+  wlr_surface_for_each_surface(xwayland_surface_->surface, iterator, data);
+}
+
+wlr_surface* XWaylandView::surface() const
+{
+  return xwayland_surface_->surface;
+}
+
+bool XWaylandView::is_unmanaged() const
+{
+  // Menus, tooltips and drag icons place themselves and bypass the window manager
+  return xwayland_surface_->override_redirect;
+}
+
+bool XWaylandView::steals_focus() const
+{
+  return !is_unmanaged() && View::steals_focus();
+}
+
+void XWaylandView::geometry(wlr_box *box) const
+{
+  box->x = 0;
+  box->y = 0;
+  box->width = xwayland_surface_->width;
+  box->height = xwayland_surface_->height;
+}
+
+void XWaylandView::extents(wlr_box *box) const
+{
+  geometry(box);
+}
+
+bool XWaylandView::has_surface(const wlr_surface *surface) const
+{
+  return xwayland_surface_->surface == surface;
+}
+
+void XWaylandView::activate()
+{
+  if (is_unmanaged()) {
+    return;
+  }
+  wlr_xwayland_surface_activate(xwayland_surface_, true);
+}
+
+void XWaylandView::deactivate()
+{
+  if (is_unmanaged()) {
+    return;
+  }
+  wlr_xwayland_surface_activate(xwayland_surface_, false);
+}
+
+void XWaylandView::move(int new_x, int new_y)
+{
+  x = new_x;
+  y = new_y;
+
+  // X11 clients position their own popups so they need to know where they are
+  wlr_xwayland_surface_configure(xwayland_surface_, x, y,
+    xwayland_surface_->width, xwayland_surface_->height);
+
+  on_move.emit(this);
+}
+
+void XWaylandView::resize(double width, double height)
+{
+  wlr_xwayland_surface_configure(xwayland_surface_, x, y, width, height);
+}
+
+wlr_surface* XWaylandView::surface_at(double sx, double sy, double *sub_x, double *sub_y)
+{
+  if (xwayland_surface_->surface == NULL) {
+    return NULL;
+  }
+  return wlr_surface_surface_at(xwayland_surface_->surface, sx, sy, sub_x, sub_y);
+}
+
+View* XWaylandView::parent() const
+{
+  if (xwayland_surface_->parent == NULL) {
+    return nullptr;
+  }
+  auto parent_view = static_cast<View*>(xwayland_surface_->parent->data);
+  return parent_view;
+}
+
+bool XWaylandView::is_root() const
+{
+  // Unmanaged surfaces are left where the client put them
+  if (is_unmanaged()) {
+    return false;
+  }
+  return xwayland_surface_->parent == NULL;
+}
+
+const View* XWaylandView::root() const
+{
+  View *parent_view = parent();
+  if (parent_view == nullptr) {
+    return this;
+  }
+  return parent_view->root();
+}
+
+void XWaylandView::xwayland_surface_map_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, map);
+  auto xwayland_surface = view->xwayland_surface_;
+
+  view->x = xwayland_surface->x;
+  view->y = xwayland_surface->y;
+
+  view->commit.notify = XWaylandView::xwayland_surface_commit_notify;
+  wl_signal_add(&xwayland_surface->surface->events.commit, &view->commit);
+
+  view->mapped = true;
+  view->on_map.emit(view);
+}
+
+void XWaylandView::xwayland_surface_unmap_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, unmap);
+  view->mapped = false;
+  wl_list_remove(&view->commit.link);
+  view->on_unmap.emit(view);
+}
+
+void XWaylandView::xwayland_surface_commit_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, commit);
+  view->on_commit.emit(view);
+  if (view->mapped) {
+    view->on_damage.emit(view);
+  }
+}
+
+void XWaylandView::xwayland_surface_destroy_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, destroy);
+
+  wl_list_remove(&view->map.link);
+  wl_list_remove(&view->unmap.link);
+  wl_list_remove(&view->destroy.link);
+  wl_list_remove(&view->request_configure.link);
+  wl_list_remove(&view->request_move.link);
+  wl_list_remove(&view->request_resize.link);
+  wl_list_remove(&view->request_maximize.link);
+  wl_list_remove(&view->request_fullscreen.link);
+  wl_list_remove(&view->set_geometry.link);
+
+  view->on_destroy.emit(view);
+}
+
+void XWaylandView::xwayland_surface_request_configure_notify(wl_listener *listener, void *data)
+{
+  auto event = static_cast<wlr_xwayland_surface_configure_event*>(data);
+  XWaylandView *view = wl_container_of(listener, view, request_configure);
+
+  // Managed windows may pick their size but the compositor picks where they go
+  if (view->mapped && !view->is_unmanaged()) {
+    wlr_xwayland_surface_configure(event->surface, view->x, view->y, event->width, event->height);
+    return;
+  }
+
+  wlr_xwayland_surface_configure(event->surface, event->x, event->y, event->width, event->height);
+}
+
+void XWaylandView::xwayland_surface_request_move_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, request_move);
+  if (view->is_unmanaged()) {
+    return;
+  }
+  view->grab();
+  view->cursor_->begin_interactive(view, WM_CURSOR_MOVE, WLR_EDGE_NONE);
+}
+
+void XWaylandView::xwayland_surface_request_resize_notify(wl_listener *listener, void *data)
+{
+  auto event = static_cast<wlr_xwayland_resize_event*>(data);
+  XWaylandView *view = wl_container_of(listener, view, request_resize);
+  if (view->is_unmanaged()) {
+    return;
+  }
+  view->cursor_->begin_interactive(view, WM_CURSOR_RESIZE, event->edges);
+}
+
+void XWaylandView::xwayland_surface_request_maximize_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, request_maximize);
+  view->toggle_maximized();
+}
+
+void XWaylandView::xwayland_surface_request_fullscreen_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, request_fullscreen);
+
+  if (view->xwayland_surface_->fullscreen) {
+    view->enter_fullscreen(nullptr);
+  } else {
+    view->windowize();
+  }
+}
+
+void XWaylandView::xwayland_surface_set_geometry_notify(wl_listener *listener, void *data)
+{
+  XWaylandView *view = wl_container_of(listener, view, set_geometry);
+  auto xwayland_surface = view->xwayland_surface_;
+
+  // Only unmanaged surfaces are allowed to move themselves
+  if (!view->is_unmanaged()) {
+    return;
+  }
+
+  if (view->x == xwayland_surface->x && view->y == xwayland_surface->y) {
+    return;
+  }
+
+  view->x = xwayland_surface->x;
+  view->y = xwayland_surface->y;
+  view->on_move.emit(view);
+}
+
+}  // namespace lumin
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "animator.h"
+
+#include "mocks.h"
+
+using ::testing::NiceMock;
+
+using namespace lumin;
+
+class AnimatorTest : public ::testing::Test
+{
+ public:
+  NiceMock<MockView> view;
+  Animator subject;
+
+  ViewTransform from = { .x = 0, .y = 0, .width = 100, .height = 100, .alpha = 1.0f };
+  ViewTransform to = { .x = 100, .y = 50, .width = 200, .height = 200, .alpha = 0.0f };
+};
+
+TEST_F(AnimatorTest, StartsFromTheFirstTransform)
+{
+  subject.animate(&view, from, to, 100, 1000);
+
+  EXPECT_TRUE(subject.active());
+  EXPECT_TRUE(view.animating);
+  EXPECT_EQ(view.animation.x, 0);
+  EXPECT_EQ(view.animation.width, 100);
+}
+
+TEST_F(AnimatorTest, StepsReportWhereTheViewWasAndIsNow)
+{
+  subject.animate(&view, from, to, 100, 1000);
+
+  auto steps = subject.step(1008, 16);
+  ASSERT_EQ(steps.size(), 1u);
+  EXPECT_EQ(steps[0].before.x, 0);
+  EXPECT_GT(steps[0].after.x, 0);
+  EXPECT_LT(steps[0].after.x, 100);
+  EXPECT_FALSE(steps[0].done);
+
+  auto next = subject.step(1024, 16);
+  ASSERT_EQ(next.size(), 1u);
+  EXPECT_EQ(next[0].before.x, steps[0].after.x);
+  EXPECT_GT(next[0].after.x, steps[0].after.x);
+  EXPECT_LT(next[0].after.alpha, steps[0].after.alpha);
+}
+
+TEST_F(AnimatorTest, FinishesAtTheLastTransform)
+{
+  subject.animate(&view, from, to, 100, 1000);
+  subject.step(1050, 16);
+
+  auto steps = subject.step(1100, 100);
+  ASSERT_EQ(steps.size(), 1u);
+  EXPECT_TRUE(steps[0].done);
+  EXPECT_EQ(steps[0].after.x, 100);
+  EXPECT_EQ(steps[0].after.alpha, 0.0f);
+
+  EXPECT_FALSE(view.animating);
+  EXPECT_FALSE(subject.active());
+}
+
+TEST_F(AnimatorTest, JumpsToTheEndWhenFramesRunLate)
+{
+  subject.animate(&view, from, to, 300, 1000);
+  subject.step(1016, 16);
+
+  auto steps = subject.step(1100, 16);
+  ASSERT_EQ(steps.size(), 1u);
+  EXPECT_TRUE(steps[0].done);
+  EXPECT_EQ(steps[0].after.width, 200);
+  EXPECT_FALSE(subject.active());
+}
+
+TEST_F(AnimatorTest, DoesNotCountIdleTimeAsLate)
+{
+  subject.animate(&view, from, to, 100, 1000);
+  subject.step(1200, 16);
+
+  subject.animate(&view, from, to, 100, 5000);
+  auto steps = subject.step(5016, 16);
+  ASSERT_EQ(steps.size(), 1u);
+  EXPECT_FALSE(steps[0].done);
+}
+
+TEST_F(AnimatorTest, ANewAnimationReplacesTheOld)
+{
+  subject.animate(&view, from, to, 100, 1000);
+  subject.animate(&view, to, from, 100, 1000);
+
+  auto steps = subject.step(1100, 16);
+  ASSERT_EQ(steps.size(), 1u);
+  EXPECT_EQ(steps[0].after.x, 0);
+}
+
+TEST_F(AnimatorTest, CancelledViewsAreNotStepped)
+{
+  subject.animate(&view, from, to, 100, 1000);
+  subject.cancel(&view);
+
+  EXPECT_FALSE(subject.active());
+  EXPECT_TRUE(subject.step(1016, 16).empty());
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "blit.h"
+
+using namespace lumin;
+
+class BlitTest : public ::testing::Test
+{
+ public:
+  // Random premultiplied pixels with a mix of opaque, clear and translucent runs
+  std::vector<uint32_t> pixels(int count, unsigned seed)
+  {
+    std::mt19937 random(seed);
+    std::vector<uint32_t> result(count);
+    for (auto &pixel : result) {
+      uint32_t alpha = random() % 3 == 0 ? 0xff : random() % 0x100;
+      if (random() % 5 == 0) {
+        alpha = 0;
+      }
+      uint32_t pixel_value = alpha << 24;
+      for (int shift = 0; shift < 24; shift += 8) {
+        pixel_value |= (alpha == 0 ? 0 : random() % (alpha + 1)) << shift;
+      }
+      pixel = pixel_value;
+    }
+    return result;
+  }
+};
+
+TEST_F(BlitTest, CopiesRectangleBetweenStrides)
+{
+  std::vector<uint32_t> src = { 1, 2, 3, 4, 5, 6 };
+  std::vector<uint32_t> dst(8, 0);
+
+  blit_copy(dst.data(), 4 * sizeof(uint32_t), src.data(), 3 * sizeof(uint32_t), 2, 2);
+
+  EXPECT_EQ(dst, std::vector<uint32_t>({ 1, 2, 0, 0, 4, 5, 0, 0 }));
+}
+
+TEST_F(BlitTest, FillsRectangle)
+{
+  std::vector<uint32_t> dst(6, 0);
+
+  blit_fill(dst.data(), 3 * sizeof(uint32_t), 0xff000000, 2, 2);
+
+  EXPECT_EQ(dst, std::vector<uint32_t>({ 0xff000000, 0xff000000, 0, 0xff000000, 0xff000000, 0 }));
+}
+
+TEST_F(BlitTest, BlendsPremultipliedPixels)
+{
+  std::vector<uint32_t> src = { 0xff102030, 0x00000000, 0x80400000, 0x80808080 };
+  std::vector<uint32_t> dst = { 0xffffffff, 0xff00ff00, 0xff0000ff, 0xffffffff };
+
+  blit_over(dst.data(), 0, src.data(), 0, 4, 1);
+
+  EXPECT_EQ(dst[0], 0xff102030u);
+  EXPECT_EQ(dst[1], 0xff00ff00u);
+  EXPECT_EQ(dst[2], 0xff40007fu);
+  EXPECT_EQ(dst[3], 0xffffffffu);
+}
+
+TEST_F(BlitTest, VectorKernelsMatchScalar)
+{
+  // Odd widths exercise the tails after the last full vector
+  for (int width : { 1, 3, 4, 7, 8, 13, 64, 101 }) {
+    auto src = pixels(width, width);
+    auto dst = pixels(width, width + 1000);
+
+    auto expected = dst;
+    detail::blit_over_row_scalar(expected.data(), src.data(), width);
+
+    auto sse2 = dst;
+    detail::blit_over_row_sse2(sse2.data(), src.data(), width);
+    EXPECT_EQ(sse2, expected) << "width " << width;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (!__builtin_cpu_supports("avx2")) {
+      continue;
+    }
+#endif
+
+    auto avx2 = dst;
+    detail::blit_over_row_avx2(avx2.data(), src.data(), width);
+    EXPECT_EQ(avx2, expected) << "width " << width;
+  }
+}
@@ -17,7 +17,9 @@
 
 #include "mocks.h"
 
+using ::testing::DoAll;
 using ::testing::Return;
+using ::testing::SaveArg;
 using ::testing::DoDefault;
 using ::testing::ReturnNull;
 using ::testing::Exactly;
@@ -37,7 +39,7 @@ class DisplayConfigTest : public ::testing::Test {
   std::shared_ptr<DisplayConfig> subject_;
 
   void SetUp() override {
-    os_ = std::make_shared<MockOS>();
+    os_ = std::make_shared<NiceMock<MockOS>>();
 
     output1_.reset();
     output2_.reset();
@@ -57,8 +59,6 @@ class DisplayConfigTest : public ::testing::Test {
     EXPECT_CALL(*output3_, id).WillRepeatedly(Return("OUTPUT3"));
     EXPECT_CALL(*output3_, connected).WillRepeatedly(Return(false));
     EXPECT_CALL(*output3_, width).WillRepeatedly(Return(1024));
-
-    subject_ = std::make_shared<DisplayConfig>(os_);
   }
 };
 
@@ -70,6 +70,8 @@ TEST_F(DisplayConfigTest, GivesADefaultLayoutWhenTheConfigFileDoesntExist) {
   std::stringstream data;
   EXPECT_CALL(*os_, file_exists).WillOnce(Return(false));
 
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
   auto result = subject_->find_layout(outputs);
   EXPECT_EQ(result.size(), 1);
   EXPECT_EQ(result.begin()->first, "OUTPUT1");
@@ -88,6 +90,8 @@ TEST_F(DisplayConfigTest, GivesADefaultLayoutWhenNoMatches) {
   EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
   EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
 
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
   auto result = subject_->find_layout(outputs);
   EXPECT_EQ(result.size(), 2);
   EXPECT_EQ(result.begin()->first, "OUTPUT1");
@@ -124,6 +128,8 @@ TEST_F(DisplayConfigTest, MatchesASingleConfig) {
   EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
   EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
 
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
   auto result = subject_->find_layout(outputs);
   EXPECT_EQ(result.size(), 1);
   EXPECT_EQ(result.begin()->first, "OUTPUT1");
@@ -166,6 +172,8 @@ TEST_F(DisplayConfigTest, MatchesADoubleConfig) {
   EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
   EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
 
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
   auto result = subject_->find_layout(outputs);
   EXPECT_EQ(result.size(), 2);
   EXPECT_EQ(result.begin()->first, "OUTPUT1");
@@ -217,8 +225,167 @@ TEST_F(DisplayConfigTest, MatchesADoubleConfigEvenWithADisconnectedScreen) {
   EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
   EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
 
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
   auto result = subject_->find_layout(outputs);
   EXPECT_EQ(result.size(), 2);
   EXPECT_EQ(result.begin()->first, "OUTPUT1");
   EXPECT_EQ(result.rbegin()->first, "OUTPUT2");
 }
+
+TEST_F(DisplayConfigTest, ReloadsTheProfilesWhenTheConfigFileChanges) {
+  std::vector<std::shared_ptr<IOutput>> outputs;
+
+  outputs.push_back(output1_);
+
+  std::function<void()> on_change;
+  EXPECT_CALL(*os_, watch_file).WillOnce(DoAll(SaveArg<1>(&on_change), Return(7)));
+  EXPECT_CALL(*os_, file_exists).WillRepeatedly(Return(true));
+
+  std::stringstream data;
+  data << R"(
+    - - name: OUTPUT1
+        scale: 1
+        primary: true
+        x: 0
+        y: 0
+        enabled: true
+  )";
+
+  std::stringstream changed_data;
+  changed_data << R"(
+    - - name: OUTPUT1
+        scale: 2
+        primary: true
+        x: 0
+        y: 0
+        enabled: true
+  )";
+
+  EXPECT_CALL(*os_, open_file)
+    .WillOnce(Return(data.str()))
+    .WillOnce(Return(changed_data.str()));
+
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
+  auto result = subject_->find_layout(outputs);
+  EXPECT_EQ(result["OUTPUT1"].scale, 1);
+
+  on_change();
+
+  result = subject_->find_layout(outputs);
+  EXPECT_EQ(result["OUTPUT1"].scale, 2);
+}
+
+TEST_F(DisplayConfigTest, ReadsModeSettings) {
+  std::vector<std::shared_ptr<IOutput>> outputs;
+
+  outputs.push_back(output1_);
+  outputs.push_back(output2_);
+
+  std::stringstream data;
+  data << R"(
+    - - name: OUTPUT1
+        scale: 1
+        primary: true
+        x: 0
+        y: 0
+        enabled: true
+        width: 2560
+        height: 1440
+        refresh: 143.998
+      - name: OUTPUT2
+        scale: 1
+        primary: false
+        x: 2560
+        y: 0
+        enabled: true
+        mode: highest_refresh
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
+  auto result = subject_->find_layout(outputs);
+
+  EXPECT_EQ(result["OUTPUT1"].mode, OUTPUT_MODE_EXPLICIT);
+  EXPECT_EQ(result["OUTPUT1"].width, 2560);
+  EXPECT_EQ(result["OUTPUT1"].height, 1440);
+  EXPECT_EQ(result["OUTPUT1"].refresh, 143998);
+
+  EXPECT_EQ(result["OUTPUT2"].mode, OUTPUT_MODE_HIGHEST_REFRESH);
+}
+
+TEST_F(DisplayConfigTest, ReadsFractionalScales) {
+  std::vector<std::shared_ptr<IOutput>> outputs;
+
+  outputs.push_back(output1_);
+
+  std::stringstream data;
+  data << R"(
+    - - name: OUTPUT1
+        scale: 1.5
+        primary: true
+        x: 0
+        y: 0
+        enabled: true
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
+  auto result = subject_->find_layout(outputs);
+
+  EXPECT_FLOAT_EQ(result["OUTPUT1"].scale, 1.5f);
+}
+
+TEST_F(DisplayConfigTest, ReadsTheMirrorSource) {
+  std::vector<std::shared_ptr<IOutput>> outputs;
+
+  outputs.push_back(output1_);
+  outputs.push_back(output2_);
+
+  std::stringstream data;
+  data << R"(
+    - - name: OUTPUT1
+        scale: 1
+        primary: true
+        x: 0
+        y: 0
+        enabled: true
+      - name: OUTPUT2
+        scale: 1
+        primary: false
+        x: 0
+        y: 0
+        enabled: true
+        mirror: OUTPUT1
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  subject_ = std::make_shared<DisplayConfig>(os_);
+
+  auto result = subject_->find_layout(outputs);
+
+  EXPECT_EQ(result["OUTPUT1"].mirror, "");
+  EXPECT_EQ(result["OUTPUT2"].mirror, "OUTPUT1");
+}
+
+TEST_F(DisplayConfigTest, StopsWatchingTheConfigFileWhenDestroyed) {
+  std::vector<std::shared_ptr<IOutput>> outputs;
+  outputs.push_back(output1_);
+
+  EXPECT_CALL(*os_, file_exists).WillRepeatedly(Return(false));
+  EXPECT_CALL(*os_, watch_file).WillOnce(Return(3));
+  subject_ = std::make_shared<DisplayConfig>(os_);
+  subject_->find_layout(outputs);
+
+  EXPECT_CALL(*os_, unwatch_file(3)).Times(Exactly(1));
+  subject_.reset();
+}
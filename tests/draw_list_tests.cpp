@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include "draw_list.h"
+
+using namespace lumin;
+
+class DrawListTest : public ::testing::Test
+{
+ public:
+  wlr_texture *texture1 = reinterpret_cast<wlr_texture*>(0x1);
+  wlr_texture *texture2 = reinterpret_cast<wlr_texture*>(0x2);
+
+  DrawItem item(wlr_texture *texture, int x, int y, int width, int height)
+  {
+    return item(texture, x, y, width, height, false);
+  }
+
+  DrawItem item(wlr_texture *texture, int x, int y, int width, int height, bool opaque)
+  {
+    DrawItem result = {
+      .surface = nullptr,
+      .texture = texture,
+      .x = x,
+      .y = y,
+      .width = width,
+      .height = height,
+      .transform = 0,
+      .opaque = opaque,
+      .alpha = 1.0f
+    };
+    return result;
+  }
+};
+
+TEST_F(DrawListTest, KeepsItemsInPaintOrder)
+{
+  DrawList subject(1920, 1080);
+
+  subject.add(item(texture1, 0, 0, 1920, 1080));
+  subject.add(item(texture2, 100, 100, 800, 600));
+
+  ASSERT_EQ(subject.items().size(), 2);
+  EXPECT_EQ(subject.items()[0].texture, texture1);
+  EXPECT_EQ(subject.items()[1].texture, texture2);
+  EXPECT_EQ(subject.items()[1].x, 100);
+  EXPECT_EQ(subject.items()[1].width, 800);
+}
+
+TEST_F(DrawListTest, SkipsItemsOutsideTheOutput)
+{
+  DrawList subject(1920, 1080);
+
+  subject.add(item(texture1, 1920, 0, 800, 600));
+  subject.add(item(texture1, -800, 0, 800, 600));
+  subject.add(item(texture1, 0, 1080, 800, 600));
+
+  EXPECT_TRUE(subject.empty());
+}
+
+TEST_F(DrawListTest, KeepsItemsPartiallyOnTheOutput)
+{
+  DrawList subject(1920, 1080);
+
+  subject.add(item(texture1, 1800, 1000, 800, 600));
+
+  EXPECT_EQ(subject.items().size(), 1);
+}
+
+TEST_F(DrawListTest, SkipsEmptyItems)
+{
+  DrawList subject(1920, 1080);
+
+  subject.add(item(nullptr, 0, 0, 800, 600));
+  subject.add(item(texture1, 0, 0, 0, 600));
+
+  EXPECT_TRUE(subject.empty());
+}
+
+TEST_F(DrawListTest, ClipsItemsToTheDamage)
+{
+  DrawList subject(1920, 1080);
+  subject.add(item(texture1, 100, 100, 800, 600));
+
+  auto calls = subject.batch({ { 0, 0, 200, 200 }, { 1000, 0, 1100, 100 } });
+
+  ASSERT_EQ(calls.size(), 1);
+  EXPECT_EQ(calls[0].item->texture, texture1);
+  EXPECT_EQ(calls[0].clip.x1, 100);
+  EXPECT_EQ(calls[0].clip.y1, 100);
+  EXPECT_EQ(calls[0].clip.x2, 200);
+  EXPECT_EQ(calls[0].clip.y2, 200);
+}
+
+TEST_F(DrawListTest, SkipsItemsHiddenByAnOpaqueItem)
+{
+  DrawList subject(1920, 1080);
+  subject.add(item(texture1, 0, 0, 1920, 1080, true));
+  subject.add(item(texture2, 0, 0, 800, 600, true));
+
+  auto calls = subject.batch({ { 100, 100, 200, 200 }, { 1000, 100, 1100, 200 } });
+
+  ASSERT_EQ(calls.size(), 2);
+  EXPECT_EQ(calls[0].item->texture, texture1);
+  EXPECT_EQ(calls[0].clip.x1, 1000);
+  EXPECT_EQ(calls[1].item->texture, texture2);
+  EXPECT_EQ(calls[1].clip.x1, 100);
+}
+
+TEST_F(DrawListTest, DrawsBelowTranslucentItems)
+{
+  DrawList subject(1920, 1080);
+  subject.add(item(texture1, 0, 0, 1920, 1080, true));
+  subject.add(item(texture2, 0, 0, 800, 600, false));
+
+  auto calls = subject.batch({ { 100, 100, 200, 200 } });
+
+  ASSERT_EQ(calls.size(), 2);
+  EXPECT_EQ(calls[0].item->texture, texture1);
+  EXPECT_EQ(calls[1].item->texture, texture2);
+}
+
+TEST_F(DrawListTest, GroupsCallsByItem)
+{
+  DrawList subject(1920, 1080);
+  subject.add(item(texture1, 0, 0, 1920, 1080));
+  subject.add(item(texture2, 0, 0, 1920, 1080));
+
+  auto calls = subject.batch({ { 0, 0, 10, 10 }, { 20, 20, 30, 30 }, { 40, 40, 50, 50 } });
+
+  ASSERT_EQ(calls.size(), 6);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(calls[i].item->texture, texture1);
+    EXPECT_EQ(calls[i + 3].item->texture, texture2);
+  }
+}
+
+TEST_F(DrawListTest, AppendsAnotherListOnTop)
+{
+  DrawList subject(1920, 1080);
+  subject.add(item(texture1, 0, 0, 1920, 1080));
+
+  DrawList overlay(1920, 1080);
+  overlay.add(item(texture2, 0, 0, 1920, 32));
+
+  subject.append(overlay);
+
+  ASSERT_EQ(subject.items().size(), 2);
+  EXPECT_EQ(subject.items()[1].texture, texture2);
+}
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "image_encoder.h"
+
+using namespace lumin;
+
+static uint32_t read_u32(const std::vector<uint8_t>& data, size_t offset)
+{
+  return data[offset] << 24 | data[offset + 1] << 16 | data[offset + 2] << 8 | data[offset + 3];
+}
+
+// The reference decoder's loop, enough to check what the encoder wrote
+static std::vector<uint8_t> decode_qoi(const std::vector<uint8_t>& data, size_t pixel_count)
+{
+  std::vector<uint8_t> rgb;
+  uint8_t index[64][4] = {};
+  uint8_t pixel[4] = { 0, 0, 0, 255 };
+  int run = 0;
+  size_t position = 14;
+
+  while (rgb.size() < pixel_count * 3) {
+    if (run > 0) {
+      run--;
+    } else {
+      uint8_t op = data[position++];
+      if (op == 0xfe) {
+        pixel[0] = data[position++];
+        pixel[1] = data[position++];
+        pixel[2] = data[position++];
+      } else if ((op & 0xc0) == 0x00) {
+        std::copy_n(index[op], 4, pixel);
+      } else if ((op & 0xc0) == 0x40) {
+        pixel[0] += ((op >> 4) & 0x03) - 2;
+        pixel[1] += ((op >> 2) & 0x03) - 2;
+        pixel[2] += (op & 0x03) - 2;
+      } else if ((op & 0xc0) == 0x80) {
+        uint8_t next = data[position++];
+        int dg = (op & 0x3f) - 32;
+        pixel[0] += dg - 8 + ((next >> 4) & 0x0f);
+        pixel[1] += dg;
+        pixel[2] += dg - 8 + (next & 0x0f);
+      } else {
+        run = op & 0x3f;
+      }
+      int hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+      std::copy_n(pixel, 4, index[hash]);
+    }
+    rgb.insert(rgb.end(), pixel, pixel + 3);
+  }
+  return rgb;
+}
+
+class ImageEncoderTest : public ::testing::Test {
+ protected:
+  // Rows of gradients with a flat band, so every QOI op gets used. The
+  // frame can sit inside a larger readback, with a grey border around it.
+  CapturedFrame frame(int width, int height, bool y_invert, int border = 0) {
+    int stride = (width + border * 2) * 4;
+    int rows = height + border * 2;
+    std::shared_ptr<uint8_t[]> pixels(new uint8_t[stride * rows]);
+    std::fill_n(pixels.get(), stride * rows, 0x80);
+
+    CapturedFrame frame = {
+      .pixels = pixels,
+      .x = border,
+      .y = border,
+      .width = width,
+      .height = height,
+      .stride = stride,
+      .rows = rows,
+      .y_invert = y_invert
+    };
+
+    for (int y = 0; y < height; ++y) {
+      uint8_t *row = const_cast<uint8_t*>(frame.row(y));
+      for (int x = 0; x < width; ++x) {
+        bool flat = x > width / 2;
+        row[x * 4] = flat ? 40 : x * 7;
+        row[x * 4 + 1] = flat ? 40 : y * 3 + x;
+        row[x * 4 + 2] = flat ? 40 : (x * y) % 251;
+        row[x * 4 + 3] = 255;
+      }
+    }
+    return frame;
+  }
+
+  std::vector<uint8_t> rgb(const CapturedFrame& frame) {
+    std::vector<uint8_t> rgb;
+    for (int y = 0; y < frame.height; ++y) {
+      const uint8_t *row = frame.row(y);
+      for (int x = 0; x < frame.width; ++x, row += 4) {
+        rgb.insert(rgb.end(), { row[2], row[1], row[0] });
+      }
+    }
+    return rgb;
+  }
+};
+
+TEST_F(ImageEncoderTest, FormatFollowsTheExtension)
+{
+  EXPECT_EQ(image_format_from_path("/tmp/shot.qoi"), IMAGE_FORMAT_QOI);
+  EXPECT_EQ(image_format_from_path("/tmp/shot.png"), IMAGE_FORMAT_PNG);
+  EXPECT_EQ(image_format_from_path("/tmp/shot"), IMAGE_FORMAT_PNG);
+}
+
+TEST_F(ImageEncoderTest, PngStartsWithTheSignatureAndHeader)
+{
+  std::vector<uint8_t> data;
+  ASSERT_TRUE(encode_png(frame(30, 20, false), &data));
+
+  std::vector<uint8_t> signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  EXPECT_TRUE(std::equal(signature.begin(), signature.end(), data.begin()));
+  EXPECT_EQ(std::string(data.begin() + 12, data.begin() + 16), "IHDR");
+  EXPECT_EQ(read_u32(data, 16), 30u);
+  EXPECT_EQ(read_u32(data, 20), 20u);
+  EXPECT_EQ(data[24], 8);
+  EXPECT_EQ(data[25], 2);
+}
+
+TEST_F(ImageEncoderTest, PngChunksCarryValidChecksums)
+{
+  std::vector<uint8_t> data;
+  ASSERT_TRUE(encode_png(frame(30, 20, false), &data));
+
+  std::vector<std::string> types;
+  size_t offset = 8;
+  while (offset < data.size()) {
+    uint32_t size = read_u32(data, offset);
+    types.push_back(std::string(data.begin() + offset + 4, data.begin() + offset + 8));
+    EXPECT_EQ(read_u32(data, offset + 8 + size), crc32(0, data.data() + offset + 4, size + 4));
+    offset += 12 + size;
+  }
+
+  EXPECT_EQ(offset, data.size());
+  EXPECT_EQ(types, std::vector<std::string>({ "IHDR", "IDAT", "IEND" }));
+}
+
+TEST_F(ImageEncoderTest, PngRowsInflateToSubFilteredPixels)
+{
+  auto source = frame(30, 20, false);
+  std::vector<uint8_t> data;
+  ASSERT_TRUE(encode_png(source, &data));
+
+  uint32_t size = read_u32(data, 33);
+  std::vector<uint8_t> scanlines(20 * (1 + 30 * 3));
+  uLongf scanlines_size = scanlines.size();
+  ASSERT_EQ(uncompress(scanlines.data(), &scanlines_size, data.data() + 41, size), Z_OK);
+  ASSERT_EQ(scanlines_size, scanlines.size());
+
+  auto pixels = rgb(source);
+  for (int y = 0; y < 20; ++y) {
+    const uint8_t *line = scanlines.data() + y * (1 + 30 * 3);
+    EXPECT_EQ(line[0], 1);
+
+    std::vector<uint8_t> row(line + 1, line + 1 + 30 * 3);
+    for (size_t i = 3; i < row.size(); ++i) {
+      row[i] += row[i - 3];
+    }
+    EXPECT_TRUE(std::equal(row.begin(), row.end(), pixels.begin() + y * 30 * 3));
+  }
+}
+
+TEST_F(ImageEncoderTest, QoiHeaderDescribesTheImage)
+{
+  std::vector<uint8_t> data;
+  encode_qoi(frame(30, 20, false), &data);
+
+  EXPECT_EQ(std::string(data.begin(), data.begin() + 4), "qoif");
+  EXPECT_EQ(read_u32(data, 4), 30u);
+  EXPECT_EQ(read_u32(data, 8), 20u);
+  EXPECT_EQ(data[12], 3);
+
+  std::vector<uint8_t> end = { 0, 0, 0, 0, 0, 0, 0, 1 };
+  EXPECT_TRUE(std::equal(end.begin(), end.end(), data.end() - 8));
+}
+
+TEST_F(ImageEncoderTest, QoiDecodesToTheSamePixels)
+{
+  auto source = frame(64, 48, false);
+  std::vector<uint8_t> data;
+  encode_qoi(source, &data);
+
+  EXPECT_EQ(decode_qoi(data, 64 * 48), rgb(source));
+}
+
+TEST_F(ImageEncoderTest, QoiEncodesFlatAreasAsRuns)
+{
+  auto source = frame(200, 100, false);
+  std::fill_n(const_cast<uint8_t*>(source.pixels.get()), 200 * 4 * 100, 0x80);
+
+  std::vector<uint8_t> data;
+  encode_qoi(source, &data);
+
+  EXPECT_LE(data.size(), 14 + 4 + 200 * 100 / 62 + 1 + 8u);
+}
+
+TEST_F(ImageEncoderTest, BottomUpRowsEncodeTheSameAsTopDown)
+{
+  std::vector<uint8_t> top_down, bottom_up;
+
+  encode_qoi(frame(30, 20, false), &top_down);
+  encode_qoi(frame(30, 20, true), &bottom_up);
+  EXPECT_EQ(top_down, bottom_up);
+
+  ASSERT_TRUE(encode_png(frame(30, 20, false), &top_down));
+  ASSERT_TRUE(encode_png(frame(30, 20, true), &bottom_up));
+  EXPECT_EQ(top_down, bottom_up);
+}
+
+TEST_F(ImageEncoderTest, PartOfALargerReadbackEncodesOnlyThatPart)
+{
+  std::vector<uint8_t> whole, part;
+
+  encode_qoi(frame(30, 20, false), &whole);
+  encode_qoi(frame(30, 20, false, 5), &part);
+  EXPECT_EQ(whole, part);
+
+  encode_qoi(frame(30, 20, true, 5), &part);
+  EXPECT_EQ(whole, part);
+}
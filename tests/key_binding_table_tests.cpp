@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <linux/input-event-codes.h>
+#include <wlroots.h>
+
+#include <vector>
+
+#include "key_binding.h"
+#include "key_binding_table.h"
+
+using namespace lumin;
+
+class KeyBindingTableTest : public ::testing::Test {
+ protected:
+  KeyBindingTable subject_;
+};
+
+TEST_F(KeyBindingTableTest, GivesEachBindingANewId) {
+  int first = subject_.add(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+  int second = subject_.add(KEY_B, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(second, 1);
+  EXPECT_EQ(subject_.size(), 2);
+}
+
+TEST_F(KeyBindingTableTest, ReturnsTheExistingIdForADuplicateBinding) {
+  int first = subject_.add(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+  int second = subject_.add(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(subject_.size(), 1);
+}
+
+TEST_F(KeyBindingTableTest, DispatchesAMatchingKeyCode) {
+  int expected = subject_.add(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+
+  int id = -1;
+  bool handled = subject_.dispatch(KEY_A, XKB_KEY_NoSymbol, WLR_MODIFIER_LOGO,
+    WLR_KEY_PRESSED, &id);
+
+  EXPECT_TRUE(handled);
+  EXPECT_EQ(id, expected);
+}
+
+TEST_F(KeyBindingTableTest, IgnoresKeysWithDifferentModifiersOrState) {
+  subject_.add(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+
+  int id = -1;
+  EXPECT_FALSE(subject_.dispatch(KEY_A, XKB_KEY_NoSymbol, WLR_MODIFIER_CTRL, WLR_KEY_PRESSED, &id));
+  EXPECT_FALSE(subject_.dispatch(KEY_A, XKB_KEY_NoSymbol, WLR_MODIFIER_LOGO, WLR_KEY_RELEASED,
+    &id));
+  EXPECT_EQ(id, -1);
+}
+
+TEST_F(KeyBindingTableTest, DispatchesAMatchingKeysym) {
+  const int keysym = 0x61;
+  int expected = subject_.add_keysym(keysym, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+
+  int id = -1;
+  bool handled = subject_.dispatch(KEY_Q, keysym, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED, &id);
+
+  EXPECT_TRUE(handled);
+  EXPECT_EQ(id, expected);
+}
+
+TEST_F(KeyBindingTableTest, MatchesKeysymsWhateverTheirCase) {
+  const int lower_a = 0x61;
+  const int upper_a = 0x41;
+  int expected = subject_.add_keysym(lower_a, WLR_MODIFIER_SHIFT, WLR_KEY_PRESSED);
+
+  int id = -1;
+  EXPECT_TRUE(subject_.dispatch(KEY_A, upper_a, WLR_MODIFIER_SHIFT, WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, expected);
+}
+
+TEST_F(KeyBindingTableTest, MatchesShiftedNonLetterKeysByTheirUnshiftedKeysym) {
+  int expected = subject_.add_keysym(XKB_KEY_1, WLR_MODIFIER_LOGO | WLR_MODIFIER_SHIFT,
+    WLR_KEY_PRESSED);
+
+  int id = -1;
+  EXPECT_TRUE(subject_.dispatch(KEY_1, XKB_KEY_1, WLR_MODIFIER_LOGO | WLR_MODIFIER_SHIFT,
+    WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, expected);
+}
+
+TEST_F(KeyBindingTableTest, AddsBindingsInBulk) {
+  std::vector<KeyBinding> bindings = {
+    KeyBinding(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED),
+    KeyBinding(KEY_B, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED),
+    KeyBinding(KEY_A, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED)
+  };
+
+  auto ids = subject_.add_all(bindings);
+
+  EXPECT_EQ(ids, std::vector<int>({ 0, 1, 0 }));
+  EXPECT_EQ(subject_.size(), 2);
+}
+
+TEST_F(KeyBindingTableTest, DispatchesAChordOnceTheLastKeyIsPressed) {
+  int expected = subject_.add_chord({
+    KeyBinding(KEY_W, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED),
+    KeyBinding(KEY_H, 0, WLR_KEY_PRESSED)
+  });
+
+  int id = -1;
+  EXPECT_TRUE(subject_.dispatch(KEY_W, XKB_KEY_NoSymbol, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, -1);
+
+  EXPECT_TRUE(subject_.dispatch(KEY_W, XKB_KEY_NoSymbol, WLR_MODIFIER_LOGO, WLR_KEY_RELEASED, &id));
+  EXPECT_EQ(id, -1);
+
+  EXPECT_TRUE(subject_.dispatch(KEY_H, XKB_KEY_NoSymbol, 0, WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, expected);
+}
+
+TEST_F(KeyBindingTableTest, ModifiersPressedAgainDontResetAChord) {
+  int expected = subject_.add_chord({
+    KeyBinding(KEY_X, WLR_MODIFIER_CTRL, WLR_KEY_PRESSED),
+    KeyBinding(KEY_S, WLR_MODIFIER_CTRL, WLR_KEY_PRESSED)
+  });
+
+  int id = -1;
+  EXPECT_TRUE(subject_.dispatch(KEY_X, XKB_KEY_NoSymbol, WLR_MODIFIER_CTRL, WLR_KEY_PRESSED, &id));
+  subject_.dispatch(KEY_X, XKB_KEY_NoSymbol, WLR_MODIFIER_CTRL, WLR_KEY_RELEASED, &id);
+  subject_.dispatch(KEY_LEFTCTRL, XKB_KEY_NoSymbol, WLR_MODIFIER_CTRL, WLR_KEY_RELEASED, &id);
+
+  EXPECT_FALSE(subject_.dispatch(KEY_LEFTCTRL, XKB_KEY_NoSymbol, 0, WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, -1);
+
+  EXPECT_TRUE(subject_.dispatch(KEY_S, XKB_KEY_NoSymbol, WLR_MODIFIER_CTRL, WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, expected);
+}
+
+TEST_F(KeyBindingTableTest, ResetsAChordOnAnUnexpectedKey) {
+  subject_.add_chord({
+    KeyBinding(KEY_W, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED),
+    KeyBinding(KEY_H, 0, WLR_KEY_PRESSED)
+  });
+
+  int id = -1;
+  subject_.dispatch(KEY_W, XKB_KEY_NoSymbol, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED, &id);
+
+  EXPECT_FALSE(subject_.dispatch(KEY_J, XKB_KEY_NoSymbol, 0, WLR_KEY_PRESSED, &id));
+  EXPECT_FALSE(subject_.dispatch(KEY_H, XKB_KEY_NoSymbol, 0, WLR_KEY_PRESSED, &id));
+  EXPECT_EQ(id, -1);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <wlroots.h>
+
+#include "layer_arrange.h"
+
+using namespace lumin;
+
+class LayerArrangeTest : public ::testing::Test {
+ protected:
+  wlr_box output_ = { .x = 0, .y = 0, .width = 1920, .height = 1080 };
+
+  LayerState panel(uint32_t anchor, int exclusive_zone) {
+    LayerState state = {
+      .anchor = anchor,
+      .exclusive_zone = exclusive_zone,
+      .margin_top = 0,
+      .margin_right = 0,
+      .margin_bottom = 0,
+      .margin_left = 0,
+      .width = 0,
+      .height = 27
+    };
+    return state;
+  }
+};
+
+TEST_F(LayerArrangeTest, StretchesAPanelBetweenItsAnchors) {
+  auto state = panel(ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP |
+    ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT | ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT, 27);
+
+  wlr_box box;
+  arrange_layer_box(state, &output_, &box);
+
+  EXPECT_EQ(box.x, 0);
+  EXPECT_EQ(box.y, 0);
+  EXPECT_EQ(box.width, 1920);
+  EXPECT_EQ(box.height, 27);
+}
+
+TEST_F(LayerArrangeTest, PlacesASurfaceAgainstItsEdgeAndMargin) {
+  LayerState state = {
+    .anchor = ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM | ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT,
+    .exclusive_zone = 0,
+    .margin_top = 0,
+    .margin_right = 10,
+    .margin_bottom = 20,
+    .margin_left = 0,
+    .width = 300,
+    .height = 100
+  };
+
+  wlr_box box;
+  arrange_layer_box(state, &output_, &box);
+
+  EXPECT_EQ(box.x, 1920 - 300 - 10);
+  EXPECT_EQ(box.y, 1080 - 100 - 20);
+}
+
+TEST_F(LayerArrangeTest, CentersAnUnanchoredSurface) {
+  LayerState state = {
+    .anchor = 0,
+    .exclusive_zone = 0,
+    .margin_top = 0,
+    .margin_right = 0,
+    .margin_bottom = 0,
+    .margin_left = 0,
+    .width = 800,
+    .height = 600
+  };
+
+  wlr_box box;
+  arrange_layer_box(state, &output_, &box);
+
+  EXPECT_EQ(box.x, 560);
+  EXPECT_EQ(box.y, 240);
+}
+
+TEST_F(LayerArrangeTest, ReservesTheTopEdgeForAPanel) {
+  auto state = panel(ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP |
+    ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT | ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT, 27);
+
+  wlr_box usable_area = output_;
+  apply_exclusive_zone(state, &usable_area);
+
+  EXPECT_EQ(usable_area.y, 27);
+  EXPECT_EQ(usable_area.height, 1080 - 27);
+  EXPECT_EQ(usable_area.width, 1920);
+}
+
+TEST_F(LayerArrangeTest, ReservesTheRightEdgeForADock) {
+  auto state = panel(ZWLR_LAYER_SURFACE_V1_ANCHOR_RIGHT, 64);
+
+  wlr_box usable_area = output_;
+  apply_exclusive_zone(state, &usable_area);
+
+  EXPECT_EQ(usable_area.x, 0);
+  EXPECT_EQ(usable_area.width, 1920 - 64);
+}
+
+TEST_F(LayerArrangeTest, IgnoresZonesOfSurfacesAnchoredToOppositeEdges) {
+  auto state = panel(ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP | ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM, 27);
+
+  wlr_box usable_area = output_;
+  apply_exclusive_zone(state, &usable_area);
+
+  EXPECT_EQ(usable_area.y, 0);
+  EXPECT_EQ(usable_area.height, 1080);
+}
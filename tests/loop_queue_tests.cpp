@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "loop_queue.h"
+
+using namespace lumin;
+
+class LoopQueueTest : public ::testing::Test
+{
+ public:
+  void SetUp() {
+    ASSERT_TRUE(subject.init());
+  }
+
+ public:
+  LoopQueue subject;
+};
+
+TEST_F(LoopQueueTest, RunsPostedTasksInOrder)
+{
+  std::vector<int> order;
+  subject.post([&order]() { order.push_back(1); });
+  subject.post([&order]() { order.push_back(2); });
+
+  subject.run_pending();
+
+  EXPECT_EQ(order, std::vector<int>({ 1, 2 }));
+}
+
+TEST_F(LoopQueueTest, ReturnsTheResultOfACallFromAnotherThread)
+{
+  auto result = std::async(std::launch::async, [this]() {
+    return subject.call([]() { return 42; });
+  });
+
+  while (result.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    subject.run_pending();
+  }
+
+  EXPECT_EQ(result.get(), 42);
+}
+
+TEST_F(LoopQueueTest, FailsCallsOnceClosed)
+{
+  subject.close();
+
+  EXPECT_THROW(subject.call([]() { return 1; }), std::future_error);
+}
+
+TEST_F(LoopQueueTest, FailsCallsStillQueuedWhenClosed)
+{
+  auto result = std::async(std::launch::async, [this]() {
+    subject.call([]() { });
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  subject.close();
+
+  EXPECT_THROW(result.get(), std::future_error);
+}
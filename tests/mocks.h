@@ -28,9 +28,9 @@ typedef std::map<std::string, OutputConfig> OutputConfigReturn;
 
 class MockCursor : public ICursor {
  public:
-  MOCK_METHOD(void, load_scale, (int));
-  MOCK_METHOD(int, x, (), (const));
-  MOCK_METHOD(int, y, (), (const));
+  MOCK_METHOD(void, load_scale, (float));
+  MOCK_METHOD(double, x, (), (const));
+  MOCK_METHOD(double, y, (), (const));
   MOCK_METHOD(void, set_surface, (wlr_surface*, int, int));
   MOCK_METHOD(void, add_device, (wlr_input_device*));
   MOCK_METHOD(void, set_image, (const std::string&));
@@ -55,7 +55,13 @@ class MockPlatform : public IPlatform {
   MOCK_METHOD(std::shared_ptr<ICursor>, cursor, (), (const));
 
   MOCK_METHOD(void, add_idle, (idle_func, void*));
-  MOCK_METHOD(Output*, output_at, (int, int), (const));
+  MOCK_METHOD(wl_event_source*, add_timer, (int, timer_func, void*));
+  MOCK_METHOD(void, remove_timer, (wl_event_source*));
+  MOCK_METHOD(wl_event_source*, add_fd, (int, fd_func, void*));
+  MOCK_METHOD(Output*, output_at, (double, double), (const));
+  MOCK_METHOD(std::string, create_virtual_output, (int, int));
+  MOCK_METHOD(bool, destroy_virtual_output, (const std::string&));
+  MOCK_METHOD(void, set_xwayland_idle_timeout, (int));
 };
 
 class MockView : public View {
@@ -83,7 +89,9 @@ class MockView : public View {
 
   MOCK_METHOD(void, set_tiled, (int edges), ());
   MOCK_METHOD(void, set_maximized, (bool maximized), ());
-  MOCK_METHOD(void, set_size, (int width, int height), ());
+  MOCK_METHOD(void, set_fullscreen, (bool fullscreen), ());
+  MOCK_METHOD(uint32_t, set_size, (int width, int height), ());
+  MOCK_METHOD(uint32_t, configure_serial, (), (const));
 
   MOCK_METHOD(bool, has_surface, (const wlr_surface *surface), (const));
   MOCK_METHOD(void, for_each_surface, (wlr_surface_iterator_func_t iterator, void *data), (const));
@@ -99,9 +107,12 @@ class MockView : public View {
 class MockOutput : public IOutput {
  public:
   MOCK_METHOD(std::string, id, (), (const));
-  MOCK_METHOD(void, configure, (int, bool, bool enabled, int x, int y));
+  MOCK_METHOD(bool, configure, (float, bool, bool enabled, int x, int y));
+  MOCK_METHOD(void, request_mode, (OutputModePolicy, int, int, int));
+  MOCK_METHOD(void, mirror, (IOutput *));
   MOCK_METHOD(void, take_damage, (const View *));
   MOCK_METHOD(void, take_whole_damage, ());
+  MOCK_METHOD(void, take_box_damage, (const wlr_box *));
   MOCK_METHOD(bool, is_named, (const std::string&), (const));
   MOCK_METHOD(bool, connected, (), (const));
   MOCK_METHOD(void, set_connected, (bool));
@@ -109,6 +120,10 @@ class MockOutput : public IOutput {
   MOCK_METHOD(void, mark_deleted, (), ());
   MOCK_METHOD(bool, primary, (), (const));
   MOCK_METHOD(int, width, (), (const));
+  MOCK_METHOD(void, schedule_frame, ());
+  MOCK_METHOD(void, set_overview, (bool));
+  MOCK_METHOD(void, set_menubar, (View*));
+  MOCK_METHOD(bool, capture, (const wlr_box *, const CaptureCallback&));
 };
 
 class MockOS : public IOS {
@@ -117,6 +132,8 @@ class MockOS : public IOS {
   MOCK_METHOD(std::string, open_file, (const std::string&), ());
   MOCK_METHOD(bool, file_exists, (const std::string&), ());
   MOCK_METHOD(void, execute, (const std::string&), ());
+  MOCK_METHOD(int, watch_file, (const std::string&, const std::function<void()>&), ());
+  MOCK_METHOD(void, unwatch_file, (int), ());
 };
 
 #endif  // MOCKS_H_
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "idisplay_config.h"
+#include "output_mode.h"
+
+using namespace lumin;
+
+class OutputModeTest : public ::testing::Test {
+ protected:
+  // A panel that prefers 60Hz at its native size but can go faster
+  std::vector<OutputMode> modes_ = {
+    { .width = 2560, .height = 1440, .refresh = 59951, .preferred = true },
+    { .width = 2560, .height = 1440, .refresh = 143998, .preferred = false },
+    { .width = 2560, .height = 1440, .refresh = 119998, .preferred = false },
+    { .width = 1920, .height = 1080, .refresh = 240000, .preferred = false },
+    { .width = 1920, .height = 1080, .refresh = 60000, .preferred = false }
+  };
+};
+
+TEST_F(OutputModeTest, GivesNoModeForAnEmptyList) {
+  std::vector<OutputMode> modes;
+
+  EXPECT_EQ(select_output_mode(modes, OUTPUT_MODE_PREFERRED, 0, 0, 0), -1);
+}
+
+TEST_F(OutputModeTest, PicksThePreferredMode) {
+  EXPECT_EQ(select_output_mode(modes_, OUTPUT_MODE_PREFERRED, 0, 0, 0), 0);
+}
+
+TEST_F(OutputModeTest, PicksTheHighestRefreshAtTheNativeResolution) {
+  EXPECT_EQ(select_output_mode(modes_, OUTPUT_MODE_HIGHEST_REFRESH, 0, 0, 0), 1);
+}
+
+TEST_F(OutputModeTest, PicksTheClosestRefreshForAnExplicitMode) {
+  EXPECT_EQ(select_output_mode(modes_, OUTPUT_MODE_EXPLICIT, 2560, 1440, 120000), 2);
+  EXPECT_EQ(select_output_mode(modes_, OUTPUT_MODE_EXPLICIT, 2560, 1440, 144000), 1);
+}
+
+TEST_F(OutputModeTest, PicksTheHighestRefreshForAnExplicitSizeWithoutARate) {
+  EXPECT_EQ(select_output_mode(modes_, OUTPUT_MODE_EXPLICIT, 1920, 1080, 0), 3);
+}
+
+TEST_F(OutputModeTest, FallsBackToThePreferredModeForAnUnknownSize) {
+  EXPECT_EQ(select_output_mode(modes_, OUTPUT_MODE_EXPLICIT, 3840, 2160, 60000), 0);
+}
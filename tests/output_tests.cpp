@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <wlroots.h>
+
+#include "output.h"
+
+using namespace lumin;
+
+// Outputs are backed by bare wlroots structs that never join the layout,
+// which leaves them where a disconnected output ends up
+class OutputTest : public ::testing::Test
+{
+ public:
+  void SetUp() {
+    wl_signal_init(&wlr_output.events.destroy);
+    wl_signal_init(&wlr_output.events.mode);
+    wl_signal_init(&damage.events.frame);
+
+    layout = wlr_output_layout_create();
+    subject = std::make_unique<Output>(&wlr_output, nullptr, &damage, layout, nullptr);
+  }
+
+  void TearDown() {
+    subject.reset();
+    wlr_output_layout_destroy(layout);
+  }
+
+ public:
+  struct wlr_output wlr_output = {};
+  wlr_output_damage damage = {};
+  wlr_output_layout *layout;
+  std::unique_ptr<Output> subject;
+};
+
+TEST_F(OutputTest, HasNoBoxOutsideTheLayout)
+{
+  subject->set_connected(true);
+  subject->set_connected(false);
+
+  EXPECT_EQ(subject->box(), nullptr);
+  EXPECT_EQ(subject->x(), 0);
+  EXPECT_EQ(subject->y(), 0);
+}
+
+TEST_F(OutputTest, SkipsRenderingOnceDisconnected)
+{
+  subject->set_enabled(true);
+  subject->set_connected(true);
+  subject->set_connected(false);
+
+  subject->render({}, {});
+}
+
+TEST_F(OutputTest, FailsQueuedCapturesWhenDisabled)
+{
+  subject->set_enabled(true);
+
+  bool failed = false;
+  ASSERT_TRUE(subject->capture_damage(nullptr, [&failed](CapturedFrame&& frame) {
+    failed = frame.pixels == nullptr;
+  }));
+
+  subject->set_enabled(false);
+
+  EXPECT_TRUE(failed);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <wlroots.h>
+
+#include "overview_layout.h"
+
+using namespace lumin;
+
+class OverviewLayoutTest : public ::testing::Test {
+ protected:
+  wlr_box area_ = { .x = 0, .y = 0, .width = 1920, .height = 1080 };
+
+  std::vector<wlr_box> windows(int count, int width, int height) {
+    wlr_box size = { .x = 0, .y = 0, .width = width, .height = height };
+    return std::vector<wlr_box>(count, size);
+  }
+};
+
+TEST_F(OverviewLayoutTest, ArrangesWindowsInAGridShapedLikeThem) {
+  std::vector<wlr_box> boxes;
+  overview_layout(&area_, 20, windows(4, 1600, 900), &boxes);
+
+  ASSERT_EQ(boxes.size(), 4u);
+  EXPECT_EQ(boxes[0].y, boxes[1].y);
+  EXPECT_EQ(boxes[2].y, boxes[3].y);
+  EXPECT_LT(boxes[0].y, boxes[2].y);
+  EXPECT_EQ(boxes[0].x, boxes[2].x);
+}
+
+TEST_F(OverviewLayoutTest, ScalesDownKeepingTheAspectRatio) {
+  std::vector<wlr_box> boxes;
+  overview_layout(&area_, 20, windows(4, 1600, 900), &boxes);
+
+  for (auto &box : boxes) {
+    EXPECT_LE(box.width, (1920 - 60) / 2);
+    EXPECT_LE(box.height, (1080 - 60) / 2);
+    EXPECT_NEAR(static_cast<double>(box.width) / box.height, 16.0 / 9.0, 0.01);
+  }
+}
+
+TEST_F(OverviewLayoutTest, NeverScalesUp) {
+  std::vector<wlr_box> boxes;
+  overview_layout(&area_, 20, windows(1, 400, 300), &boxes);
+
+  ASSERT_EQ(boxes.size(), 1u);
+  EXPECT_EQ(boxes[0].width, 400);
+  EXPECT_EQ(boxes[0].height, 300);
+  EXPECT_EQ(boxes[0].x, (1920 - 400) / 2);
+  EXPECT_EQ(boxes[0].y, (1080 - 300) / 2);
+}
+
+TEST_F(OverviewLayoutTest, CentersAShortLastRow) {
+  std::vector<wlr_box> boxes;
+  overview_layout(&area_, 20, windows(3, 1600, 900), &boxes);
+
+  ASSERT_EQ(boxes.size(), 3u);
+  EXPECT_NEAR(boxes[2].x + boxes[2].width / 2, 1920 / 2, 1);
+}
+
+TEST_F(OverviewLayoutTest, KeepsEveryWindowInsideTheArea) {
+  std::vector<wlr_box> boxes;
+  overview_layout(&area_, 10, windows(60, 800, 600), &boxes);
+
+  ASSERT_EQ(boxes.size(), 60u);
+  for (auto &box : boxes) {
+    EXPECT_GE(box.x, 0);
+    EXPECT_GE(box.y, 0);
+    EXPECT_LE(box.x + box.width, 1920);
+    EXPECT_LE(box.y + box.height, 1080);
+  }
+}
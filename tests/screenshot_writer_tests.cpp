@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "screenshot_writer.h"
+
+using namespace lumin;
+
+class ScreenshotWriterTest : public ::testing::Test {
+ protected:
+  std::string path_ = ::testing::TempDir() + "lumin-screenshot-test.qoi";
+
+  void TearDown() override {
+    unlink(path_.c_str());
+  }
+
+  CapturedFrame frame(int width, int height) {
+    std::shared_ptr<uint8_t[]> pixels(new uint8_t[width * 4 * height]);
+    std::fill_n(pixels.get(), width * 4 * height, 0xff);
+
+    CapturedFrame frame = {
+      .pixels = pixels,
+      .x = 0,
+      .y = 0,
+      .width = width,
+      .height = height,
+      .stride = width * 4,
+      .rows = height,
+      .y_invert = false
+    };
+    return frame;
+  }
+
+  std::vector<uint8_t> read(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+  }
+};
+
+TEST_F(ScreenshotWriterTest, WritesQueuedScreenshotsBeforeItIsDestroyed)
+{
+  {
+    ScreenshotWriter subject;
+    subject.write(frame(16, 16), path_);
+  }
+
+  auto data = read(path_);
+  ASSERT_GT(data.size(), 4u);
+  EXPECT_EQ(std::string(data.begin(), data.begin() + 4), "qoif");
+}
+
+TEST_F(ScreenshotWriterTest, LeavesNoPartialFileBehind)
+{
+  {
+    ScreenshotWriter subject;
+    subject.write(frame(16, 16), path_);
+  }
+
+  EXPECT_NE(access(path_.c_str(), F_OK), -1);
+  EXPECT_EQ(access((path_ + ".part").c_str(), F_OK), -1);
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <linux/input-event-codes.h>
+#include <unistd.h>
+#include <wlroots.h>
+
 #include <memory>
 #include <map>
 
@@ -12,12 +16,14 @@
 #include "cursor.h"
 #include "view.h"
 #include "output.h"
+#include "workspace.h"
 
 #include "mocks.h"
 
 using ::testing::_;
 using ::testing::DoDefault;
 using ::testing::Exactly;
+using ::testing::IsNull;
 using ::testing::NiceMock;
 using ::testing::Return;
 using ::testing::ReturnNull;
@@ -110,6 +116,19 @@ TEST_F(ServerTest, MinimizeViewMinimizedAView)
   EXPECT_TRUE(view.minimized);
 }
 
+TEST_F(ServerTest, KeyRunsABoundActionInProcess)
+{
+  const int keysym = 0xff0d;
+  Action action = { .type = ACTION_EXEC, .argument = "gnome-terminal" };
+  subject->add_action(keysym, WLR_MODIFIER_LOGO, action);
+
+  EXPECT_CALL(*os, execute("gnome-terminal")).Times(Exactly(1));
+
+  bool handled = subject->key(KEY_ENTER, keysym, WLR_MODIFIER_LOGO, WLR_KEY_PRESSED);
+
+  EXPECT_TRUE(handled);
+}
+
 TEST_F(ServerTest, OutputConnectedConfiguresOutputsWithALayout)
 {
   OutputConfig outputConfig = {
@@ -117,7 +136,12 @@ TEST_F(ServerTest, OutputConnectedConfiguresOutputsWithALayout)
       .primary = true,
       .enabled = true,
       .x = 0,
-      .y = 0};
+      .y = 0,
+      .mode = OUTPUT_MODE_PREFERRED,
+      .width = 0,
+      .height = 0,
+      .refresh = 0,
+      .mirror = ""};
   const char *name = "TEST";
 
   std::map<std::string, OutputConfig> config;
@@ -130,12 +154,143 @@ TEST_F(ServerTest, OutputConnectedConfiguresOutputsWithALayout)
   EXPECT_CALL(*output, id).WillOnce(Return(name));
   EXPECT_CALL(*output, configure(outputConfig.scale, outputConfig.primary,
     outputConfig.enabled, outputConfig.x, outputConfig.y)).Times(Exactly(1));
+  EXPECT_CALL(*output, mirror(nullptr)).Times(Exactly(1));
 
   subject->outputs_.push_back(output);
 
   subject->outputs_changed(output.get());
 }
 
+TEST_F(ServerTest, OutputsChangedRequestsTheConfiguredMode)
+{
+  OutputConfig outputConfig = {
+      .scale = 1,
+      .primary = true,
+      .enabled = true,
+      .x = 0,
+      .y = 0,
+      .mode = OUTPUT_MODE_EXPLICIT,
+      .width = 2560,
+      .height = 1440,
+      .refresh = 144000,
+      .mirror = ""};
+  const char *name = "TEST";
+
+  std::map<std::string, OutputConfig> config;
+  config[name] = outputConfig;
+
+  EXPECT_CALL(*display_config, find_layout(_)).WillOnce(Return(config));
+
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*output, id).WillByDefault(Return(name));
+
+  EXPECT_CALL(*output, request_mode(OUTPUT_MODE_EXPLICIT, 2560, 1440, 144000))
+    .Times(Exactly(1));
+
+  subject->outputs_.push_back(output);
+
+  subject->outputs_changed(output.get());
+}
+
+TEST_F(ServerTest, OutputsChangedMirrorsTheConfiguredSource)
+{
+  OutputConfig sourceConfig = {
+      .scale = 1,
+      .primary = true,
+      .enabled = true,
+      .x = 0,
+      .y = 0,
+      .mode = OUTPUT_MODE_PREFERRED,
+      .width = 0,
+      .height = 0,
+      .refresh = 0,
+      .mirror = ""};
+
+  OutputConfig mirrorConfig = sourceConfig;
+  mirrorConfig.primary = false;
+  mirrorConfig.mirror = "SOURCE";
+
+  std::map<std::string, OutputConfig> config;
+  config["SOURCE"] = sourceConfig;
+  config["MIRROR"] = mirrorConfig;
+
+  EXPECT_CALL(*display_config, find_layout(_)).WillOnce(Return(config));
+
+  auto source = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*source, id).WillByDefault(Return("SOURCE"));
+  subject->outputs_.push_back(source);
+
+  auto mirror = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*mirror, id).WillByDefault(Return("MIRROR"));
+  subject->outputs_.push_back(mirror);
+
+  EXPECT_CALL(*source, mirror(nullptr)).Times(Exactly(1));
+  EXPECT_CALL(*mirror, mirror(source.get())).Times(Exactly(1));
+
+  subject->outputs_changed(nullptr);
+}
+
+TEST_F(ServerTest, CreateVirtualOutputAsksThePlatformForAHeadlessOutput)
+{
+  OutputConfig outputConfig = {
+      .scale = 1,
+      .primary = false,
+      .enabled = true,
+      .x = 0,
+      .y = 0,
+      .mode = OUTPUT_MODE_EXPLICIT,
+      .width = 1280,
+      .height = 720,
+      .refresh = 60000,
+      .mirror = ""};
+
+  EXPECT_CALL(*platform, create_virtual_output(1280, 720)).WillOnce(Return("HEADLESS-1"));
+
+  auto id = subject->create_virtual_output(outputConfig);
+
+  EXPECT_EQ(id, "HEADLESS-1");
+}
+
+TEST_F(ServerTest, DestroyVirtualOutputIgnoresPhysicalOutputs)
+{
+  EXPECT_CALL(*platform, destroy_virtual_output(_)).Times(Exactly(0));
+
+  EXPECT_FALSE(subject->destroy_virtual_output("TEST"));
+}
+
+TEST_F(ServerTest, OutputsChangedPlacesVirtualOutputsOutsideTheMonitorProfiles)
+{
+  OutputConfig virtualConfig = {
+      .scale = 2,
+      .primary = false,
+      .enabled = true,
+      .x = 1920,
+      .y = 0,
+      .mode = OUTPUT_MODE_EXPLICIT,
+      .width = 1280,
+      .height = 720,
+      .refresh = 30000,
+      .mirror = ""};
+  subject->virtual_outputs_["HEADLESS-1"] = virtualConfig;
+
+  auto physical = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*physical, id).WillByDefault(Return("TEST"));
+  subject->outputs_.push_back(physical);
+
+  auto virtual_output = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*virtual_output, id).WillByDefault(Return("HEADLESS-1"));
+  subject->outputs_.push_back(virtual_output);
+
+  std::vector<std::shared_ptr<IOutput>> physical_outputs = { physical };
+  EXPECT_CALL(*display_config, find_layout(physical_outputs))
+    .WillOnce(Return(std::map<std::string, OutputConfig>()));
+
+  EXPECT_CALL(*virtual_output, request_mode(OUTPUT_MODE_EXPLICIT, 1280, 720, 30000));
+  EXPECT_CALL(*virtual_output, configure(2, false, true, 1920, 0));
+
+  subject->outputs_changed(nullptr);
+}
+
 TEST_F(ServerTest, LidSwitchedDisablesTheOutputWhenShut)
 {
   auto output = std::make_shared<MockOutput>();
@@ -170,7 +325,7 @@ TEST_F(ServerTest, OutputsChangedConfiguresTheOutputWithANewLayout)
   EXPECT_CALL(*output, id).WillOnce(Return(name));
   subject->outputs_.push_back(output);
 
-  int scale = 2;
+  float scale = 2;
   bool primary = false;
   bool enabled = true;
   int x = 0;
@@ -181,14 +336,278 @@ TEST_F(ServerTest, OutputsChangedConfiguresTheOutputWithANewLayout)
       .primary = primary,
       .enabled = enabled,
       .x = x,
-      .y = y};
+      .y = y,
+      .mode = OUTPUT_MODE_PREFERRED,
+      .width = 0,
+      .height = 0,
+      .refresh = 0,
+      .mirror = ""};
 
   std::map<std::string, OutputConfig> config;
   config[name] = outputConfig;
 
   EXPECT_CALL(*display_config, find_layout(subject->outputs_)).WillOnce(Return(config));
 
+  EXPECT_CALL(*output, mirror(nullptr));
   EXPECT_CALL(*output, configure(scale, primary, enabled, x, y));
 
   subject->outputs_changed(NULL);
 }
+
+TEST_F(ServerTest, SwitchWorkspaceHidesTheViewsOfTheCurrentOne)
+{
+  Output output;
+  ON_CALL(*platform, output_at).WillByDefault(Return(&output));
+
+  auto view = std::make_shared<NiceMock<MockView>>();
+  auto hit = reinterpret_cast<wlr_surface*>(view.get());
+  ON_CALL(*view, surface_at).WillByDefault(Return(hit));
+  view->mapped = true;
+
+  auto workspace = subject->active_workspace(output.id());
+  view->workspace = workspace;
+  workspace->add_view(view);
+  subject->views_.push_back(view);
+
+  wlr_surface *surface = nullptr;
+  double sx, sy;
+  EXPECT_EQ(subject->desktop_view_at(10, 10, &surface, &sx, &sy), view.get());
+
+  EXPECT_TRUE(subject->switch_workspace(1));
+
+  EXPECT_EQ(subject->active_workspace(output.id())->index, 1);
+  EXPECT_EQ(subject->desktop_view_at(10, 10, &surface, &sx, &sy), nullptr);
+}
+
+TEST_F(ServerTest, ViewsOutsideWorkspacesAreVisible)
+{
+  Output output;
+  ON_CALL(*platform, output_at).WillByDefault(Return(&output));
+
+  auto launcher = std::make_shared<NiceMock<MockView>>();
+  auto hit = reinterpret_cast<wlr_surface*>(launcher.get());
+  ON_CALL(*launcher, surface_at).WillByDefault(Return(hit));
+  ON_CALL(*launcher, id).WillByDefault(Return("org.os.Launcher"));
+  launcher->mapped = true;
+  subject->views_.push_back(launcher);
+
+  wlr_surface *surface = nullptr;
+  double sx, sy;
+  EXPECT_EQ(subject->desktop_view_at(10, 10, &surface, &sx, &sy), launcher.get());
+}
+
+TEST_F(ServerTest, UnmappingTheMenubarGivesBackItsRoom)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  subject->outputs_.push_back(output);
+
+  auto menubar = std::make_shared<NiceMock<MockView>>();
+  ON_CALL(*menubar, id).WillByDefault(Return("org.os.Menu"));
+
+  EXPECT_CALL(*output, set_menubar(nullptr));
+  subject->view_unmapped(menubar.get());
+}
+
+TEST_F(ServerTest, MoveToWorkspaceTakesTheTopView)
+{
+  Output output;
+  ON_CALL(*platform, output_at).WillByDefault(Return(&output));
+
+  auto view = std::make_shared<NiceMock<MockView>>();
+  view->mapped = true;
+
+  auto workspace = subject->active_workspace(output.id());
+  view->workspace = workspace;
+  workspace->add_view(view);
+  subject->views_.push_back(view);
+
+  EXPECT_TRUE(subject->move_to_workspace(2));
+
+  EXPECT_EQ(view->workspace->index, 2);
+  EXPECT_FALSE(view->workspace->active);
+  EXPECT_TRUE(workspace->views().empty());
+}
+
+TEST_F(ServerTest, ThumbnailSharesAMemfdForTheApp)
+{
+  auto view = std::make_shared<NiceMock<MockView>>();
+  ON_CALL(*view, is_root).WillByDefault(Return(true));
+  ON_CALL(*view, id).WillByDefault(Return("terminal"));
+  view->mapped = true;
+  subject->views_.push_back(view);
+
+  ThumbnailBuffer buffer;
+  EXPECT_FALSE(subject->thumbnail("editor", &buffer));
+
+  ASSERT_TRUE(subject->thumbnail("terminal", &buffer));
+  EXPECT_NE(buffer.fd, -1);
+  EXPECT_EQ(buffer.serial, 0u);
+  close(buffer.fd);
+
+  EXPECT_EQ(subject->thumbnails_.size(), 1u);
+}
+
+TEST_F(ServerTest, DamageOnlyRedrawsThumbnailedViews)
+{
+  auto view = std::make_shared<NiceMock<MockView>>();
+  ON_CALL(*view, is_root).WillByDefault(Return(true));
+  ON_CALL(*view, id).WillByDefault(Return("terminal"));
+  view->mapped = true;
+  subject->views_.push_back(view);
+
+  auto other_view = std::make_shared<NiceMock<MockView>>();
+  other_view->mapped = true;
+  subject->views_.push_back(other_view);
+
+  ThumbnailBuffer buffer;
+  ASSERT_TRUE(subject->thumbnail("terminal", &buffer));
+  close(buffer.fd);
+
+  EXPECT_CALL(*platform, add_timer(_, _, _)).Times(1);
+  subject->view_damaged(other_view.get());
+  subject->view_damaged(view.get());
+}
+
+TEST_F(ServerTest, ToggleOverviewSwitchesEveryOutput)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  subject->outputs_.push_back(output);
+
+  EXPECT_CALL(*output, set_overview(true)).Times(Exactly(1));
+  subject->toggle_overview();
+
+  EXPECT_CALL(*output, set_overview(false)).Times(Exactly(1));
+  subject->toggle_overview();
+}
+
+TEST_F(ServerTest, EscapeLeavesTheOverview)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  subject->outputs_.push_back(output);
+
+  subject->toggle_overview();
+
+  EXPECT_CALL(*output, set_overview(false)).Times(Exactly(1));
+  EXPECT_TRUE(subject->key(KEY_ESC, XKB_KEY_Escape, 0, WLR_KEY_RELEASED));
+  EXPECT_TRUE(subject->key(KEY_ESC, XKB_KEY_Escape, 0, WLR_KEY_PRESSED));
+}
+
+TEST_F(ServerTest, MinimizingAnimatesWithinTheViewsBounds)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  subject->outputs_.push_back(output);
+
+  auto view = std::make_shared<NiceMock<MockView>>();
+  ON_CALL(*view, geometry).WillByDefault([](wlr_box *box) {
+    *box = { .x = 0, .y = 0, .width = 400, .height = 300 };
+  });
+  view->x = 100;
+  view->y = 50;
+  view->mapped = true;
+  view->minimized = true;
+
+  wlr_box damage = { .x = 0, .y = 0, .width = 0, .height = 0 };
+  EXPECT_CALL(*output, take_box_damage(_)).WillOnce([&damage](const wlr_box *box) {
+    damage = *box;
+  });
+
+  subject->view_minimized(view.get());
+
+  EXPECT_TRUE(view->animating);
+  EXPECT_EQ(damage.x, 100);
+  EXPECT_EQ(damage.y, 50);
+  EXPECT_EQ(damage.width, 400);
+  EXPECT_EQ(damage.height, 300);
+}
+
+TEST_F(ServerTest, ScreenshotQueuesACaptureOfTheWholeOutput)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*output, id).WillByDefault(Return("HDMI-A-1"));
+  subject->outputs_.push_back(output);
+
+  EXPECT_CALL(*output, capture(IsNull(), _)).WillOnce(Return(true));
+
+  EXPECT_FALSE(subject->screenshot_output("DP-1", "shot.png"));
+  EXPECT_TRUE(subject->screenshot_output("HDMI-A-1", "shot.png"));
+}
+
+TEST_F(ServerTest, ScreenshotRejectsNamesOutsideThePicturesDirectory)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*output, id).WillByDefault(Return("HDMI-A-1"));
+  subject->outputs_.push_back(output);
+
+  EXPECT_CALL(*output, capture).Times(0);
+
+  EXPECT_FALSE(subject->screenshot_output("HDMI-A-1", "/tmp/shot.png"));
+  EXPECT_FALSE(subject->screenshot_output("HDMI-A-1", "../shot.png"));
+  EXPECT_FALSE(subject->screenshot_output("HDMI-A-1", ".."));
+}
+
+TEST_F(ServerTest, ScreenshotOfAWindowCoversItsGeometryOnScreen)
+{
+  auto view = std::make_shared<NiceMock<MockView>>();
+  ON_CALL(*view, id).WillByDefault(Return("org.example.App"));
+  ON_CALL(*view, is_root).WillByDefault(Return(true));
+  ON_CALL(*view, geometry).WillByDefault([](wlr_box *box) {
+    *box = { .x = 10, .y = 20, .width = 400, .height = 300 };
+  });
+  view->mapped = true;
+  view->x = 100;
+  view->y = 50;
+  subject->views_.push_back(view);
+
+  EXPECT_CALL(*platform, output_at(310, 220)).WillOnce(Return(nullptr));
+  EXPECT_FALSE(subject->screenshot_app("org.example.App", ""));
+
+  view->minimized = true;
+  EXPECT_CALL(*platform, output_at).Times(0);
+  EXPECT_FALSE(subject->screenshot_app("org.example.App", ""));
+}
+
+TEST_F(ServerTest, ScreenshotWritesTheCapturedFrame)
+{
+  auto output = std::make_shared<NiceMock<MockOutput>>();
+  ON_CALL(*output, id).WillByDefault(Return("HDMI-A-1"));
+  subject->outputs_.push_back(output);
+
+  CaptureCallback done;
+  EXPECT_CALL(*output, capture(_, _)).WillOnce(
+    [&done](const wlr_box *box, const CaptureCallback& callback) {
+      done = callback;
+      return true;
+    });
+
+  // Screenshots are only ever saved under the home directory
+  const char *home = getenv("HOME");
+  std::string previous_home = home != nullptr ? home : "";
+  setenv("HOME", ::testing::TempDir().c_str(), 1);
+  std::string path = ::testing::TempDir() + "/lumin-server-screenshot.qoi";
+  bool queued = subject->screenshot_output("HDMI-A-1", "lumin-server-screenshot.qoi");
+  if (home != nullptr) {
+    setenv("HOME", previous_home.c_str(), 1);
+  } else {
+    unsetenv("HOME");
+  }
+  ASSERT_TRUE(queued);
+
+  CapturedFrame frame = {
+    .pixels = std::shared_ptr<uint8_t[]>(new uint8_t[8 * 4 * 8]()),
+    .x = 0,
+    .y = 0,
+    .width = 8,
+    .height = 8,
+    .stride = 8 * 4,
+    .rows = 8,
+    .y_invert = false
+  };
+  done(std::move(frame));
+
+  // The writer finishes what was queued before going away
+  done = nullptr;
+  subject.reset();
+
+  EXPECT_EQ(access(path.c_str(), F_OK), 0);
+  unlink(path.c_str());
+}
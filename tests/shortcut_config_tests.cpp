@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wlroots.h>
+
+#include <memory>
+#include <sstream>
+
+#include "action.h"
+#include "ios.h"
+#include "shortcut_config.h"
+
+#include "mocks.h"
+
+using ::testing::Return;
+
+using namespace lumin;
+
+class ShortcutConfigTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<MockOS> os_;
+
+  std::shared_ptr<ShortcutConfig> subject_;
+
+  void SetUp() override {
+    os_ = std::make_shared<MockOS>();
+    subject_ = std::make_shared<ShortcutConfig>(os_);
+  }
+};
+
+TEST_F(ShortcutConfigTest, GivesNoBindingsWhenTheConfigFileDoesntExist) {
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(false));
+
+  auto result = subject_->load();
+
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(ShortcutConfigTest, LoadsActionBindings) {
+  std::stringstream data;
+  data << R"(
+    - key: Left
+      modifiers: [logo]
+      action: dock_left
+    - key: Return
+      modifiers: [logo, shift]
+      action: exec
+      argument: gnome-terminal
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.size(), 2);
+
+  EXPECT_EQ(result[0].key, "Left");
+  EXPECT_EQ(result[0].modifiers, WLR_MODIFIER_LOGO);
+  EXPECT_EQ(result[0].action.type, ACTION_DOCK_LEFT);
+  EXPECT_EQ(result[0].action.argument, "");
+
+  EXPECT_EQ(result[1].key, "Return");
+  EXPECT_EQ(result[1].modifiers, WLR_MODIFIER_LOGO | WLR_MODIFIER_SHIFT);
+  EXPECT_EQ(result[1].action.type, ACTION_EXEC);
+  EXPECT_EQ(result[1].action.argument, "gnome-terminal");
+}
+
+TEST_F(ShortcutConfigTest, SkipsUnknownActions) {
+  std::stringstream data;
+  data << R"(
+    - key: q
+      modifiers: [logo]
+      action: self_destruct
+    - key: m
+      modifiers: [logo]
+      action: toggle_maximize
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0].action.type, ACTION_TOGGLE_MAXIMIZE);
+}
+
+TEST_F(ShortcutConfigTest, SkipsEntriesWithoutAKey) {
+  std::stringstream data;
+  data << R"(
+    - modifiers: [logo]
+      action: dock_left
+    - key: m
+      modifiers: [logo]
+      action: toggle_maximize
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0].action.type, ACTION_TOGGLE_MAXIMIZE);
+}
+
+TEST_F(ShortcutConfigTest, GivesNoBindingsWhenTheFileIsMalformed) {
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return("- key: [unclosed"));
+
+  auto result = subject_->load();
+
+  EXPECT_TRUE(result.empty());
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <wayland-server-core.h>
+
+#include <memory>
+#include <vector>
+
+#include "draw_list.h"
+#include "software_renderer.h"
+
+using namespace lumin;
+
+class SoftwareRendererTest : public ::testing::Test
+{
+ public:
+  wlr_surface *surface1 = reinterpret_cast<wlr_surface*>(0x1);
+  wlr_surface *surface2 = reinterpret_cast<wlr_surface*>(0x2);
+  wlr_texture *texture = reinterpret_cast<wlr_texture*>(0x3);
+
+  SoftwareRenderer subject;
+
+  DrawItem item(wlr_surface *surface, int x, int y, int width, int height, int transform)
+  {
+    DrawItem result = {
+      .surface = surface,
+      .texture = texture,
+      .x = x,
+      .y = y,
+      .width = width,
+      .height = height,
+      .transform = transform,
+      .opaque = false,
+      .alpha = 1.0f
+    };
+    return result;
+  }
+
+  void shadow(wlr_surface *surface, int width, int height, uint32_t color, bool opaque)
+  {
+    auto shadow_buffer = std::make_unique<ShadowBuffer>();
+    shadow_buffer->surface = surface;
+    shadow_buffer->renderer = &subject;
+    shadow_buffer->pixels.assign(width * height, color);
+    shadow_buffer->width = width;
+    shadow_buffer->height = height;
+    shadow_buffer->opaque = opaque;
+    shadow_buffer->valid = true;
+    wl_list_init(&shadow_buffer->commit.link);
+    wl_list_init(&shadow_buffer->destroy.link);
+    subject.shadows[surface] = std::move(shadow_buffer);
+  }
+};
+
+TEST_F(SoftwareRendererTest, CompositesSurfacesInPaintOrder)
+{
+  shadow(surface1, 4, 2, 0xff0000ff, true);
+  shadow(surface2, 2, 2, 0x80400000, false);
+
+  DrawList draw_list(4, 2);
+  draw_list.add(item(surface1, 0, 0, 4, 2, 0));
+  draw_list.add(item(surface2, 2, 0, 2, 2, 0));
+
+  std::vector<uint32_t> pixels(8, 0);
+  subject.composite(draw_list, pixels.data(), 16, 0, 0, 4, 2);
+
+  EXPECT_EQ(pixels[0], 0xff0000ffu);
+  EXPECT_EQ(pixels[1], 0xff0000ffu);
+  EXPECT_EQ(pixels[2], 0xff40007fu);
+  EXPECT_EQ(pixels[7], 0xff40007fu);
+}
+
+TEST_F(SoftwareRendererTest, OnlyTouchesTheDamagedRect)
+{
+  shadow(surface1, 4, 2, 0xff0000ff, true);
+
+  DrawList draw_list(4, 2);
+  draw_list.add(item(surface1, 0, 0, 4, 2, 0));
+
+  std::vector<uint32_t> pixels(8, 0);
+  subject.composite(draw_list, pixels.data(), 16, 1, 1, 2, 1);
+
+  EXPECT_EQ(pixels, std::vector<uint32_t>({ 0, 0, 0, 0, 0, 0xff0000ff, 0xff0000ff, 0 }));
+}
+
+TEST_F(SoftwareRendererTest, ClearsWhereNothingIsDrawn)
+{
+  DrawList draw_list(2, 1);
+
+  std::vector<uint32_t> pixels(2, 0x12345678);
+  subject.composite(draw_list, pixels.data(), 8, 0, 0, 2, 1);
+
+  EXPECT_EQ(pixels, std::vector<uint32_t>({ 0xff000000, 0xff000000 }));
+}
+
+TEST_F(SoftwareRendererTest, LeavesScaledAndUnshadowedSurfacesToGL)
+{
+  shadow(surface1, 4, 2, 0xff0000ff, true);
+
+  DrawList scaled(8, 4);
+  scaled.add(item(surface1, 0, 0, 8, 4, 0));
+  EXPECT_FALSE(subject.can_composite(scaled));
+
+  DrawList rotated(4, 2);
+  rotated.add(item(surface1, 0, 0, 4, 2, 1));
+  EXPECT_FALSE(subject.can_composite(rotated));
+
+  DrawList unshadowed(4, 2);
+  unshadowed.add(item(surface2, 0, 0, 4, 2, 0));
+  EXPECT_FALSE(subject.can_composite(unshadowed));
+
+  DrawList saved(4, 2);
+  saved.add(item(nullptr, 0, 0, 4, 2, 0));
+  EXPECT_FALSE(subject.can_composite(saved));
+
+  DrawList plain(4, 2);
+  plain.add(item(surface1, 0, 0, 4, 2, 0));
+  EXPECT_TRUE(subject.can_composite(plain));
+}
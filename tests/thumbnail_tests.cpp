@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+
+#include "thumbnail.h"
+
+using namespace lumin;
+
+TEST(ThumbnailTest, FitsWithinTheThumbnailSizeKeepingTheAspectRatio)
+{
+  int width, height;
+
+  Thumbnail::fit(1920, 1080, &width, &height);
+  EXPECT_EQ(width, 256);
+  EXPECT_EQ(height, 144);
+
+  Thumbnail::fit(600, 1200, &width, &height);
+  EXPECT_EQ(width, 128);
+  EXPECT_EQ(height, 256);
+}
+
+TEST(ThumbnailTest, NeverScalesUp)
+{
+  int width, height;
+
+  Thumbnail::fit(200, 100, &width, &height);
+  EXPECT_EQ(width, 200);
+  EXPECT_EQ(height, 100);
+
+  Thumbnail::fit(4000, 1, &width, &height);
+  EXPECT_EQ(width, 256);
+  EXPECT_EQ(height, 1);
+}
+
+TEST(ThumbnailTest, SharesAMemfdWithTwoSlotsForTheLargestThumbnail)
+{
+  Thumbnail subject(nullptr);
+  ASSERT_TRUE(subject.init());
+
+  auto buffer = subject.buffer();
+
+  struct stat info;
+  ASSERT_EQ(fstat(buffer.fd, &info), 0);
+  EXPECT_EQ(info.st_size, 2 * 256 * 256 * 4);
+
+  EXPECT_EQ(buffer.stride, 256 * 4);
+  EXPECT_EQ(buffer.slot_size, 256 * 256 * 4);
+  EXPECT_EQ(buffer.width, 0);
+  EXPECT_EQ(buffer.height, 0);
+  EXPECT_EQ(buffer.serial, 0u);
+}
+
+TEST(ThumbnailTest, IsDueUntilFirstDrawn)
+{
+  Thumbnail subject(nullptr);
+
+  EXPECT_TRUE(subject.dirty());
+  EXPECT_TRUE(subject.due(0));
+}
+
+TEST(ThumbnailTest, ExpiresWhenNotRequestedForAWhile)
+{
+  Thumbnail subject(nullptr);
+  subject.request(1000);
+
+  EXPECT_FALSE(subject.expired(1000));
+  EXPECT_FALSE(subject.expired(30999));
+  EXPECT_TRUE(subject.expired(31000));
+
+  subject.request(31000);
+  EXPECT_FALSE(subject.expired(31000));
+}
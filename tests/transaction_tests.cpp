@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+
+#include "iplatform.h"
+#include "transaction.h"
+#include "view.h"
+
+#include "mocks.h"
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Exactly;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+using namespace lumin;
+
+class TransactionTest : public ::testing::Test
+{
+ public:
+  std::shared_ptr<MockPlatform> platform;
+
+  NiceMock<MockView> view1;
+  NiceMock<MockView> view2;
+
+  std::shared_ptr<Transaction> subject;
+
+ protected:
+  void SetUp() override
+  {
+    platform = std::make_shared<NiceMock<MockPlatform>>();
+    subject = std::make_shared<Transaction>(platform.get());
+
+    ON_CALL(view1, set_size).WillByDefault(Return(1));
+    ON_CALL(view2, set_size).WillByDefault(Return(2));
+  }
+};
+
+TEST_F(TransactionTest, CommitSendsTheNewSizeToEveryView)
+{
+  EXPECT_CALL(view1, set_size(400, 300)).Times(Exactly(1));
+  EXPECT_CALL(view2, set_size(800, 600)).Times(Exactly(1));
+
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->add(&view2, 400, 27, 800, 600);
+  subject->commit();
+}
+
+TEST_F(TransactionTest, AppliesOnlyOnceEveryViewHasCommitted)
+{
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->add(&view2, 400, 27, 400, 300);
+  subject->commit();
+
+  EXPECT_CALL(view1, configure_serial).WillRepeatedly(Return(1));
+  EXPECT_CALL(view1, move(_, _)).Times(Exactly(0));
+  subject->view_committed(&view1);
+
+  EXPECT_FALSE(subject->done());
+
+  EXPECT_CALL(view1, move(0, 27)).Times(Exactly(1));
+  EXPECT_CALL(view2, move(400, 27)).Times(Exactly(1));
+  EXPECT_CALL(view2, configure_serial).WillRepeatedly(Return(2));
+  subject->view_committed(&view2);
+
+  EXPECT_TRUE(subject->done());
+}
+
+TEST_F(TransactionTest, IgnoresCommitsForAnOlderConfigure)
+{
+  ON_CALL(view1, set_size).WillByDefault(Return(5));
+
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->commit();
+
+  EXPECT_CALL(view1, configure_serial).WillRepeatedly(Return(4));
+  EXPECT_CALL(view1, move(_, _)).Times(Exactly(0));
+  subject->view_committed(&view1);
+
+  EXPECT_FALSE(subject->done());
+}
+
+TEST_F(TransactionTest, AppliesAtOnceWhenNoViewWasConfigured)
+{
+  ON_CALL(view1, set_size).WillByDefault(Return(0));
+  ON_CALL(view2, set_size).WillByDefault(Return(0));
+
+  EXPECT_CALL(*platform, add_timer(_, _, _)).Times(Exactly(0));
+  EXPECT_CALL(view1, move(0, 27)).Times(Exactly(1));
+  EXPECT_CALL(view2, move(400, 27)).Times(Exactly(1));
+
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->add(&view2, 400, 27, 400, 300);
+  subject->commit();
+
+  EXPECT_TRUE(subject->done());
+}
+
+TEST_F(TransactionTest, OnlyWaitsForTheViewsThatWereConfigured)
+{
+  ON_CALL(view1, set_size).WillByDefault(Return(0));
+
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->add(&view2, 400, 27, 400, 300);
+  subject->commit();
+
+  EXPECT_FALSE(subject->done());
+
+  EXPECT_CALL(view2, configure_serial).WillRepeatedly(Return(2));
+  subject->view_committed(&view2);
+
+  EXPECT_TRUE(subject->done());
+}
+
+TEST_F(TransactionTest, AppliesWhenTheTimeoutExpires)
+{
+  timer_func timeout = nullptr;
+  void *timeout_data = nullptr;
+  EXPECT_CALL(*platform, add_timer(_, _, _))
+    .WillOnce(DoAll(SaveArg<1>(&timeout), SaveArg<2>(&timeout_data), Return(nullptr)));
+
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->commit();
+
+  EXPECT_CALL(view1, move(0, 27)).Times(Exactly(1));
+  timeout(timeout_data);
+
+  EXPECT_TRUE(subject->done());
+}
+
+TEST_F(TransactionTest, RemovingTheLastPendingViewAppliesTheRest)
+{
+  subject->add(&view1, 0, 27, 400, 300);
+  subject->add(&view2, 400, 27, 400, 300);
+  subject->commit();
+
+  EXPECT_CALL(view1, configure_serial).WillRepeatedly(Return(1));
+  subject->view_committed(&view1);
+
+  EXPECT_CALL(view1, move(0, 27)).Times(Exactly(1));
+  EXPECT_CALL(view2, move(_, _)).Times(Exactly(0));
+  subject->remove(&view2);
+
+  EXPECT_TRUE(subject->done());
+}
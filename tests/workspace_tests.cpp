@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+
+#include "view.h"
+#include "workspace.h"
+
+#include "mocks.h"
+
+using ::testing::NiceMock;
+
+using namespace lumin;
+
+class WorkspaceTest : public ::testing::Test
+{
+ public:
+  std::shared_ptr<View> view1;
+  std::shared_ptr<View> view2;
+  std::shared_ptr<View> view3;
+
+  std::shared_ptr<Workspace> subject;
+
+ protected:
+  void SetUp() override
+  {
+    view1 = std::make_shared<NiceMock<MockView>>();
+    view2 = std::make_shared<NiceMock<MockView>>();
+    view3 = std::make_shared<NiceMock<MockView>>();
+
+    subject = std::make_shared<Workspace>("DP-1", 0);
+  }
+};
+
+TEST_F(WorkspaceTest, AddsNewViewsOnTop)
+{
+  subject->add_view(view1);
+  subject->add_view(view2);
+
+  ASSERT_EQ(subject->views().size(), 2);
+  EXPECT_EQ(subject->views()[0], view2);
+  EXPECT_EQ(subject->views()[1], view1);
+}
+
+TEST_F(WorkspaceTest, AddsAViewOnlyOnce)
+{
+  subject->add_view(view1);
+  subject->add_view(view1);
+
+  EXPECT_EQ(subject->views().size(), 1);
+}
+
+TEST_F(WorkspaceTest, RaiseViewMovesItToTheFront)
+{
+  subject->add_view(view1);
+  subject->add_view(view2);
+  subject->add_view(view3);
+
+  subject->raise_view(view1.get());
+
+  EXPECT_EQ(subject->views()[0], view1);
+  EXPECT_EQ(subject->views()[1], view3);
+  EXPECT_EQ(subject->views()[2], view2);
+}
+
+TEST_F(WorkspaceTest, LowerViewMovesItToTheBack)
+{
+  subject->add_view(view1);
+  subject->add_view(view2);
+  subject->add_view(view3);
+
+  subject->lower_view(view3.get());
+
+  EXPECT_EQ(subject->views()[0], view2);
+  EXPECT_EQ(subject->views()[1], view1);
+  EXPECT_EQ(subject->views()[2], view3);
+}
+
+TEST_F(WorkspaceTest, RemoveViewForgetsTheView)
+{
+  subject->add_view(view1);
+  subject->add_view(view2);
+
+  subject->remove_view(view1.get());
+
+  EXPECT_FALSE(subject->has_view(view1.get()));
+  EXPECT_TRUE(subject->has_view(view2.get()));
+}
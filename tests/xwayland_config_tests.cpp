@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <sstream>
+
+#include "ios.h"
+#include "xwayland_config.h"
+
+#include "mocks.h"
+
+using ::testing::Return;
+
+using namespace lumin;
+
+class XWaylandConfigTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<MockOS> os_;
+
+  std::shared_ptr<XWaylandConfig> subject_;
+
+  void SetUp() override {
+    os_ = std::make_shared<MockOS>();
+    subject_ = std::make_shared<XWaylandConfig>(os_);
+  }
+};
+
+TEST_F(XWaylandConfigTest, GivesTheDefaultIdleTimeoutWhenTheConfigFileDoesntExist) {
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(false));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.idle_timeout, 60);
+}
+
+TEST_F(XWaylandConfigTest, LoadsTheIdleTimeout) {
+  std::stringstream data;
+  data << R"(
+    idle_timeout: 300
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.idle_timeout, 300);
+}
+
+TEST_F(XWaylandConfigTest, ClampsNegativeIdleTimeoutsToNever) {
+  std::stringstream data;
+  data << R"(
+    idle_timeout: -5
+  )";
+
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return(data.str()));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.idle_timeout, 0);
+}
+
+TEST_F(XWaylandConfigTest, GivesTheDefaultIdleTimeoutWhenTheFileIsMalformed) {
+  EXPECT_CALL(*os_, file_exists).WillOnce(Return(true));
+  EXPECT_CALL(*os_, open_file).WillOnce(Return("idle_timeout: [unclosed"));
+
+  auto result = subject_->load();
+
+  EXPECT_EQ(result.idle_timeout, 60);
+}